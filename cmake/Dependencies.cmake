@@ -50,6 +50,16 @@ if(MANIFAST_ENABLE_LLVM)
     endforeach()
   endif()
 
+  # Optional: LLD lets mifast/mifastc link AOT executables in-process
+  find_package(LLD CONFIG QUIET HINTS "${LLVM_DIR}/../lld" "${LLVM_LIBRARY_DIR}/cmake/lld")
+  if(LLD_FOUND)
+    message(STATUS "Found LLD — AOT executables are linked in-process")
+    set(MANIFAST_HAS_LLD ON)
+  else()
+    message(STATUS "LLD not found — AOT executables are linked by the host C++ driver")
+    set(MANIFAST_HAS_LLD OFF)
+  endif()
+
   # Platform system libs / optional stub targets for incomplete LLVM package configs
   include(${CMAKE_CURRENT_LIST_DIR}/Platform.cmake)
   manifast_setup_llvm_platform()
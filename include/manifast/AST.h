@@ -2,7 +2,11 @@
 #define MANIFAST_AST_H
 
 #include "Token.h"
+#include "Arena.h"
+#include "Symbol.h"
+#include <cstdint>
 #include <memory>
+#include <new>
 #include <vector>
 #include <string>
 
@@ -26,32 +30,58 @@ enum class TypeKind {
 };
 
 struct Type {
-    TypeKind kind;
-    std::shared_ptr<Type> baseType; // For Array/Pointer
-    std::vector<Type> params; // For Function
-    std::shared_ptr<Type> returnType; // For Function
-
     struct Field {
         std::string name;
         std::shared_ptr<Type> type;
     };
-    std::vector<Field> fields; // For Struct
-    std::string aliasName; // For Alias
+
+    TypeKind kind;
 
     Type(TypeKind k = TypeKind::Any) : kind(k) {}
-    
+
     static Type makeArray(Type base) {
         Type t(TypeKind::Array);
-        t.baseType = std::make_shared<Type>(std::move(base));
+        t.detail = std::make_shared<Detail>();
+        t.detail->base = std::make_shared<Type>(std::move(base));
         return t;
     }
 
     static Type makePointer(Type base) {
         Type t(TypeKind::Pointer);
-        t.baseType = std::make_shared<Type>(std::move(base));
+        t.detail = std::make_shared<Detail>();
+        t.detail->base = std::make_shared<Type>(std::move(base));
+        return t;
+    }
+
+    static Type makeAlias(Symbol name) {
+        Type t(TypeKind::Alias);
+        t.detail = std::make_shared<Detail>();
+        t.detail->aliasName = name;
         return t;
     }
 
+    static Type makeStruct(std::vector<Field> fields) {
+        Type t(TypeKind::Struct);
+        t.detail = std::make_shared<Detail>();
+        t.detail->fields = std::move(fields);
+        return t;
+    }
+
+    static Type makeFunction(std::vector<Type> params, Type returnType) {
+        Type t(TypeKind::Function);
+        t.detail = std::make_shared<Detail>();
+        t.detail->params = std::move(params);
+        t.detail->returnType = std::make_shared<Type>(std::move(returnType));
+        return t;
+    }
+
+    const Type* baseType() const { return detail ? detail->base.get() : nullptr; } // Array/Pointer
+    const Type* returnType() const { return detail ? detail->returnType.get() : nullptr; } // Function
+    const std::vector<Type>& params() const { return detail ? detail->params : empty().params; } // Function
+    const std::vector<Field>& fields() const { return detail ? detail->fields : empty().fields; } // Struct
+    const std::string& aliasName() const { return aliasSymbol().str(); } // Alias
+    Symbol aliasSymbol() const { return detail ? detail->aliasName : Symbol(); }
+
     std::string toString() const {
         switch (kind) {
             case TypeKind::Any: return "any";
@@ -65,150 +95,216 @@ struct Type {
             case TypeKind::Bool: return "boolean";
             case TypeKind::String: return "string";
             case TypeKind::Void: return "void";
-            case TypeKind::Array: return baseType->toString() + "[]";
-            case TypeKind::Pointer: return "*" + baseType->toString();
-            case TypeKind::Alias: return aliasName;
+            case TypeKind::Array: return baseType()->toString() + "[]";
+            case TypeKind::Pointer: return "*" + baseType()->toString();
+            case TypeKind::Alias: return aliasName();
             case TypeKind::Struct: {
+                const auto& fs = fields();
                 std::string s = "{";
-                for (size_t i = 0; i < fields.size(); ++i) {
-                    s += fields[i].name + ": " + fields[i].type->toString();
-                    if (i < fields.size() - 1) s += ", ";
+                for (size_t i = 0; i < fs.size(); ++i) {
+                    s += fs[i].name + ": " + fs[i].type->toString();
+                    if (i < fs.size() - 1) s += ", ";
                 }
                 s += "}";
                 return s;
             }
             case TypeKind::Function: {
+                const auto& ps = params();
                 std::string s = "fungsi(";
-                for (size_t i = 0; i < params.size(); ++i) {
-                    s += params[i].toString();
-                    if (i < params.size() - 1) s += ", ";
+                for (size_t i = 0; i < ps.size(); ++i) {
+                    s += ps[i].toString();
+                    if (i < ps.size() - 1) s += ", ";
                 }
-                s += "): " + returnType->toString();
+                s += "): " + (returnType() ? returnType()->toString() : std::string("any"));
                 return s;
             }
         }
         return "unknown";
     }
+
+private:
+    // Composite payload. Scalar annotations (the overwhelmingly common case)
+    // leave it null, so a Type is one tag plus one pointer and copies are cheap.
+    struct Detail {
+        std::shared_ptr<Type> base;
+        std::vector<Type> params;
+        std::shared_ptr<Type> returnType;
+        std::vector<Field> fields;
+        Symbol aliasName;
+    };
+
+    static const Detail& empty() {
+        static const Detail d;
+        return d;
+    }
+
+    std::shared_ptr<Detail> detail;
 };
 
 class Stmt;
 
+// Concrete node tag; lets the compilers dispatch with a switch instead of RTTI.
+enum class NodeKind : uint8_t {
+    // Expressions
+    Number, String, Bool, Char, Nil, Variable, Unary, Binary, Call,
+    Assign, Get, Index, Array, Function, Object, Slice,
+    // Statements
+    ExprStmt, Return, Block, VarDecl, TypeAlias, If, While, For,
+    FunctionDecl, Class, Try
+};
+
 // Base class for all AST nodes
 class ASTNode {
 public:
+    const NodeKind kind;
     int line = 0;
     int offset = -1;
+    explicit ASTNode(NodeKind kind);
     virtual ~ASTNode() = default;
+
+    // Nodes created under an AstArena::Scope are bump-allocated; deleting
+    // them only runs the destructor (see Arena.h).
+    static void* operator new(std::size_t size);
+    static void operator delete(void* p);
+    static void operator delete(ASTNode* node, std::destroying_delete_t);
+
+private:
+    bool arenaOwned = false;
 };
 
+// Checked downcast by tag: returns nullptr when `node` is not a T.
+template <typename T>
+inline T* nodeAs(ASTNode* node) {
+    return (node && node->kind == T::Kind) ? static_cast<T*>(node) : nullptr;
+}
+
+template <typename T>
+inline const T* nodeAs(const ASTNode* node) {
+    return (node && node->kind == T::Kind) ? static_cast<const T*>(node) : nullptr;
+}
+
 // --- Expressions ---
 
 class Expr : public ASTNode {
 public:
+    explicit Expr(NodeKind kind) : ASTNode(kind) {}
     virtual ~Expr() = default;
 };
 
 class NumberExpr : public Expr {
 public:
+    static constexpr NodeKind Kind = NodeKind::Number;
     double value;
-    NumberExpr(double value) : value(value) {}
+    NumberExpr(double value) : Expr(Kind), value(value) {}
 };
 
 class StringExpr : public Expr {
 public:
+    static constexpr NodeKind Kind = NodeKind::String;
     std::string value;
-    StringExpr(std::string value) : value(std::move(value)) {}
+    StringExpr(std::string value) : Expr(Kind), value(std::move(value)) {}
 };
 
 class BoolExpr : public Expr {
 public:
+    static constexpr NodeKind Kind = NodeKind::Bool;
     bool value;
-    BoolExpr(bool value) : value(value) {}
+    BoolExpr(bool value) : Expr(Kind), value(value) {}
 };
 
 class CharExpr : public Expr {
 public:
+    static constexpr NodeKind Kind = NodeKind::Char;
     char value;
-    CharExpr(char value) : value(value) {}
+    CharExpr(char value) : Expr(Kind), value(value) {}
 };
 
 class NilExpr : public Expr {
 public:
-    NilExpr() {}
+    static constexpr NodeKind Kind = NodeKind::Nil;
+    NilExpr() : Expr(Kind) {}
 };
 
 class VariableExpr : public Expr {
 public:
-    std::string name;
-    VariableExpr(std::string name) : name(std::move(name)) {}
+    static constexpr NodeKind Kind = NodeKind::Variable;
+    Symbol name;
+    VariableExpr(Symbol name) : Expr(Kind), name(name) {}
 };
 
 class UnaryExpr : public Expr {
 public:
+    static constexpr NodeKind Kind = NodeKind::Unary;
     TokenType op;
     std::unique_ptr<Expr> right;
 
     UnaryExpr(TokenType op, std::unique_ptr<Expr> right)
-        : op(op), right(std::move(right)) {}
+        : Expr(Kind), op(op), right(std::move(right)) {}
 };
 
 class BinaryExpr : public Expr {
 public:
+    static constexpr NodeKind Kind = NodeKind::Binary;
     std::unique_ptr<Expr> left;
     TokenType op;
     std::unique_ptr<Expr> right;
 
     BinaryExpr(std::unique_ptr<Expr> left, TokenType op, std::unique_ptr<Expr> right)
-        : left(std::move(left)), op(op), right(std::move(right)) {}
+        : Expr(Kind), left(std::move(left)), op(op), right(std::move(right)) {}
 };
 
 class CallExpr : public Expr {
 public:
+    static constexpr NodeKind Kind = NodeKind::Call;
     std::unique_ptr<Expr> callee; // Generalized callee (Expr instead of string)
     std::vector<std::unique_ptr<Expr>> args;
     
     CallExpr(std::unique_ptr<Expr> callee, std::vector<std::unique_ptr<Expr>> args)
-        : callee(std::move(callee)), args(std::move(args)) {}
+        : Expr(Kind), callee(std::move(callee)), args(std::move(args)) {}
 };
 
 class AssignExpr : public Expr {
 public:
+    static constexpr NodeKind Kind = NodeKind::Assign;
     std::unique_ptr<Expr> target; 
     std::unique_ptr<Expr> value;
     TokenType op; // Equal, PlusEqual, etc.
     
     AssignExpr(std::unique_ptr<Expr> target, std::unique_ptr<Expr> value, TokenType op = TokenType::Equal)
-        : target(std::move(target)), value(std::move(value)), op(op) {}
+        : Expr(Kind), target(std::move(target)), value(std::move(value)), op(op) {}
 };
 
 class GetExpr : public Expr {
 public:
+    static constexpr NodeKind Kind = NodeKind::Get;
     std::unique_ptr<Expr> object;
-    std::string name;
+    Symbol name;
     
-    GetExpr(std::unique_ptr<Expr> object, std::string name)
-        : object(std::move(object)), name(std::move(name)) {}
+    GetExpr(std::unique_ptr<Expr> object, Symbol name)
+        : Expr(Kind), object(std::move(object)), name(name) {}
 };
 
 class IndexExpr : public Expr {
 public:
+    static constexpr NodeKind Kind = NodeKind::Index;
     std::unique_ptr<Expr> object;
     std::unique_ptr<Expr> index;
     
     IndexExpr(std::unique_ptr<Expr> object, std::unique_ptr<Expr> index)
-        : object(std::move(object)), index(std::move(index)) {}
+        : Expr(Kind), object(std::move(object)), index(std::move(index)) {}
 };
 
 class ArrayExpr : public Expr {
 public:
+    static constexpr NodeKind Kind = NodeKind::Array;
     std::vector<std::unique_ptr<Expr>> elements;
     
     ArrayExpr(std::vector<std::unique_ptr<Expr>> elements)
-        : elements(std::move(elements)) {}
+        : Expr(Kind), elements(std::move(elements)) {}
 };
 
 struct Parameter {
-    std::string name;
+    Symbol name;
     Type type;
     int line = 0;
     int offset = -1;
@@ -216,133 +312,148 @@ struct Parameter {
 
 class FunctionExpr : public Expr {
 public:
+    static constexpr NodeKind Kind = NodeKind::Function;
     std::vector<Parameter> params;
     Type returnType;
     std::unique_ptr<Stmt> body;
     
     FunctionExpr(std::vector<Parameter> params, Type returnType, std::unique_ptr<Stmt> body)
-        : params(std::move(params)), returnType(std::move(returnType)), body(std::move(body)) {}
+        : Expr(Kind), params(std::move(params)), returnType(std::move(returnType)), body(std::move(body)) {}
 };
 
 class ObjectExpr : public Expr {
 public:
-    std::vector<std::pair<std::string, std::unique_ptr<Expr>>> entries;
+    static constexpr NodeKind Kind = NodeKind::Object;
+    std::vector<std::pair<Symbol, std::unique_ptr<Expr>>> entries;
     
-    ObjectExpr(std::vector<std::pair<std::string, std::unique_ptr<Expr>>> entries)
-        : entries(std::move(entries)) {}
+    ObjectExpr(std::vector<std::pair<Symbol, std::unique_ptr<Expr>>> entries)
+        : Expr(Kind), entries(std::move(entries)) {}
 };
 
 class SliceExpr : public Expr {
 public:
+    static constexpr NodeKind Kind = NodeKind::Slice;
     std::unique_ptr<Expr> start;
     std::unique_ptr<Expr> end;
     
     SliceExpr(std::unique_ptr<Expr> start, std::unique_ptr<Expr> end)
-        : start(std::move(start)), end(std::move(end)) {}
+        : Expr(Kind), start(std::move(start)), end(std::move(end)) {}
 };
 
 // --- Statements ---
 
 class Stmt : public ASTNode {
 public:
+    explicit Stmt(NodeKind kind) : ASTNode(kind) {}
     virtual ~Stmt() = default;
 };
 
 class ExprStmt : public Stmt {
 public:
+    static constexpr NodeKind Kind = NodeKind::ExprStmt;
     std::unique_ptr<Expr> expression;
-    ExprStmt(std::unique_ptr<Expr> expression) : expression(std::move(expression)) {}
+    ExprStmt(std::unique_ptr<Expr> expression) : Stmt(Kind), expression(std::move(expression)) {}
 };
 
 class ReturnStmt : public Stmt {
 public:
+    static constexpr NodeKind Kind = NodeKind::Return;
     std::unique_ptr<Expr> value; // Can be null for void return
-    ReturnStmt(std::unique_ptr<Expr> value) : value(std::move(value)) {}
+    ReturnStmt(std::unique_ptr<Expr> value) : Stmt(Kind), value(std::move(value)) {}
 };
 
 class BlockStmt : public Stmt {
 public:
+    static constexpr NodeKind Kind = NodeKind::Block;
     std::vector<std::unique_ptr<Stmt>> statements;
-    BlockStmt(std::vector<std::unique_ptr<Stmt>> statements) : statements(std::move(statements)) {}
+    BlockStmt(std::vector<std::unique_ptr<Stmt>> statements) : Stmt(Kind), statements(std::move(statements)) {}
 };
 
 class VarDeclStmt : public Stmt {
 public:
-    std::string name;
+    static constexpr NodeKind Kind = NodeKind::VarDecl;
+    Symbol name;
     Type typeAnnotation; // Use Type instead of string
     std::unique_ptr<Expr> initializer; // Can be null
     bool isConst;
 
-    VarDeclStmt(std::string name, Type typeAnnotation, std::unique_ptr<Expr> initializer, bool isConst)
-        : name(std::move(name)), typeAnnotation(std::move(typeAnnotation)), initializer(std::move(initializer)), isConst(isConst) {}
+    VarDeclStmt(Symbol name, Type typeAnnotation, std::unique_ptr<Expr> initializer, bool isConst)
+        : Stmt(Kind), name(name), typeAnnotation(std::move(typeAnnotation)), initializer(std::move(initializer)), isConst(isConst) {}
 };
 
 class TypeAliasStmt : public Stmt {
 public:
-    std::string name;
+    static constexpr NodeKind Kind = NodeKind::TypeAlias;
+    Symbol name;
     Type type;
-    TypeAliasStmt(std::string name, Type type) : name(std::move(name)), type(std::move(type)) {}
+    TypeAliasStmt(Symbol name, Type type) : Stmt(Kind), name(name), type(std::move(type)) {}
 };
 
 class IfStmt : public Stmt {
 public:
+    static constexpr NodeKind Kind = NodeKind::If;
     std::unique_ptr<Expr> condition;
     std::unique_ptr<Stmt> thenBranch;
     std::unique_ptr<Stmt> elseBranch; // Can be null
 
     IfStmt(std::unique_ptr<Expr> condition, std::unique_ptr<Stmt> thenBranch, std::unique_ptr<Stmt> elseBranch)
-        : condition(std::move(condition)), thenBranch(std::move(thenBranch)), elseBranch(std::move(elseBranch)) {}
+        : Stmt(Kind), condition(std::move(condition)), thenBranch(std::move(thenBranch)), elseBranch(std::move(elseBranch)) {}
 };
 
 class WhileStmt : public Stmt {
 public:
+    static constexpr NodeKind Kind = NodeKind::While;
     std::unique_ptr<Expr> condition;
     std::unique_ptr<Stmt> body;
 
     WhileStmt(std::unique_ptr<Expr> condition, std::unique_ptr<Stmt> body)
-        : condition(std::move(condition)), body(std::move(body)) {}
+        : Stmt(Kind), condition(std::move(condition)), body(std::move(body)) {}
 };
 
 class ForStmt : public Stmt {
 public:
-    std::string varName;
+    static constexpr NodeKind Kind = NodeKind::For;
+    Symbol varName;
     std::unique_ptr<Expr> start;
     std::unique_ptr<Expr> end;
     std::unique_ptr<Expr> step; // Can be null (default 1)
     std::unique_ptr<Stmt> body;
 
-    ForStmt(std::string varName, std::unique_ptr<Expr> start, std::unique_ptr<Expr> end, std::unique_ptr<Expr> step, std::unique_ptr<Stmt> body)
-        : varName(std::move(varName)), start(std::move(start)), end(std::move(end)), step(std::move(step)), body(std::move(body)) {}
+    ForStmt(Symbol varName, std::unique_ptr<Expr> start, std::unique_ptr<Expr> end, std::unique_ptr<Expr> step, std::unique_ptr<Stmt> body)
+        : Stmt(Kind), varName(varName), start(std::move(start)), end(std::move(end)), step(std::move(step)), body(std::move(body)) {}
 };
 
 class FunctionStmt : public Stmt {
 public:
-    std::string name;
+    static constexpr NodeKind Kind = NodeKind::FunctionDecl;
+    Symbol name;
     std::vector<Parameter> params;
     Type returnType;
     std::unique_ptr<Stmt> body;
 
-    FunctionStmt(std::string name, std::vector<Parameter> params, Type returnType, std::unique_ptr<Stmt> body)
-        : name(std::move(name)), params(std::move(params)), returnType(std::move(returnType)), body(std::move(body)) {}
+    FunctionStmt(Symbol name, std::vector<Parameter> params, Type returnType, std::unique_ptr<Stmt> body)
+        : Stmt(Kind), name(name), params(std::move(params)), returnType(std::move(returnType)), body(std::move(body)) {}
 };
 
 class ClassStmt : public Stmt {
 public:
-    std::string name;
+    static constexpr NodeKind Kind = NodeKind::Class;
+    Symbol name;
     std::vector<std::unique_ptr<FunctionStmt>> methods;
     
-    ClassStmt(std::string name, std::vector<std::unique_ptr<FunctionStmt>> methods)
-        : name(std::move(name)), methods(std::move(methods)) {}
+    ClassStmt(Symbol name, std::vector<std::unique_ptr<FunctionStmt>> methods)
+        : Stmt(Kind), name(name), methods(std::move(methods)) {}
 };
 
 class TryStmt : public Stmt {
 public:
+    static constexpr NodeKind Kind = NodeKind::Try;
     std::unique_ptr<Stmt> tryBody;
-    std::string catchVar; // Name of the caught exception variable (optional)
+    Symbol catchVar; // Name of the caught exception variable (optional)
     std::unique_ptr<Stmt> catchBody; // Can be null
 
-    TryStmt(std::unique_ptr<Stmt> tryBody, std::string catchVar, std::unique_ptr<Stmt> catchBody)
-        : tryBody(std::move(tryBody)), catchVar(std::move(catchVar)), catchBody(std::move(catchBody)) {}
+    TryStmt(std::unique_ptr<Stmt> tryBody, Symbol catchVar, std::unique_ptr<Stmt> catchBody)
+        : Stmt(Kind), tryBody(std::move(tryBody)), catchVar(catchVar), catchBody(std::move(catchBody)) {}
 };
 
 } // namespace manifast
@@ -0,0 +1,73 @@
+#ifndef MANIFAST_ARENA_H
+#define MANIFAST_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+namespace manifast {
+
+// Bump allocator backing the AST. While an AstArena::Scope is active on a
+// thread, every ASTNode created there is carved out of the arena instead of
+// the heap; deleting such a node only runs its destructor, and the memory is
+// returned in one go when the arena itself is destroyed.
+//
+// Only the nodes themselves live in the arena. Containers inside them
+// (argument/element/statement vectors, parameter lists, object entries,
+// StringExpr::value, Type payloads) still allocate on the heap, and the
+// destructors run on delete free them one by one. Leaf-heavy trees (numbers,
+// variables, binary operators) are freed in bulk; lists are not.
+//
+// The arena must outlive every node allocated from it:
+//
+//     AstArena arena;
+//     std::vector<std::unique_ptr<Stmt>> program;
+//     {
+//         AstArena::Scope scope(arena);
+//         program = parser.parse();
+//     }
+class AstArena {
+public:
+    explicit AstArena(size_t blockSize = 64 * 1024);
+    ~AstArena();
+
+    AstArena(const AstArena&) = delete;
+    AstArena& operator=(const AstArena&) = delete;
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+    // True if `p` is the address handed out by the most recent allocate().
+    bool isLastAllocation(const void* p) const { return p == last; }
+
+    size_t bytesAllocated() const { return allocated; }
+
+    // Release everything allocated so far, keeping one block for reuse. Every
+    // node carved from the arena must already be destroyed.
+    void reset();
+
+    // Arena receiving ASTNode allocations on this thread, or nullptr (heap).
+    static AstArena* current();
+
+    class Scope {
+    public:
+        explicit Scope(AstArena& arena);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        AstArena* previous;
+    };
+
+private:
+    char* newBlock(size_t size);
+
+    std::vector<char*> blocks;
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    void* last = nullptr;
+    size_t blockSize;
+    size_t allocated = 0;
+};
+
+} // namespace manifast
+
+#endif // MANIFAST_ARENA_H
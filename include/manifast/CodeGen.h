@@ -2,11 +2,15 @@
 #define MANIFAST_CODEGEN_H
 
 #include "AST.h"
+#include "Profile.h"
 #include <llvm/ExecutionEngine/Orc/LLJIT.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
+#include <llvm/Target/TargetMachine.h>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <memory>
 
 namespace manifast {
@@ -15,8 +19,35 @@ class CodeGen {
 public:
     CodeGen(std::string_view source = "");
     void compile(const std::vector<std::unique_ptr<Stmt>>& statements);
+    // Optimization level (0-3) for run() and the emit*() paths, as in -O<n>.
+    void setOptLevel(int level) { optLevel = level < 0 ? 0 : (level > 3 ? 3 : level); }
+    int getOptLevel() const { return optLevel; }
+    // Incremental form of compile() for streamed sources: each statement is
+    // lowered into manifast_main as it arrives and may be freed afterwards.
+    void beginMain();
+    void compileTopLevel(const Stmt* stmt);
+    void finishMain();
     void printIR(); 
     bool run(); // JIT Execution entry
+    // Keep JIT-compiled objects on disk and reuse them on later runs of the
+    // same source. `dir` defaults to <user cache dir>/manifast/jit.
+    void enableObjectCache(const std::string& dir = "");
+    // Compile each function on its first call instead of the whole module
+    // before manifast_main starts.
+    void setLazyCompilation(bool lazy) { lazyCompilation = lazy; }
+    // Compile on a pool of `threads` workers (0 or 1: on the calling thread).
+    // Eager mode splits the module into one part per worker.
+    void setCompileThreads(unsigned threads) { compileThreads = threads; }
+    // Feed a recorded run of this source back in: branch weights on `jika`,
+    // `selama`, `dan`/`atau`, entry counts on functions, and hot/cold
+    // attributes and sections. Profiles of other sources are ignored.
+    // Must outlive compile().
+    void setProfile(const ExecutionProfile* p) { profile = p && p->matches(source) ? p : nullptr; }
+
+    // Runtime compiled to LLVM bitcode (manifast_runtime.bc, built next to
+    // mifast). Optimized emit*() paths link it in so runtime calls can be
+    // inlined into the program; without it they stay external calls.
+    void setRuntimeBitcode(const std::string& path) { runtimeBitcode = path; }
 
     // AOT Emission
     void emitIR(const std::string& path);
@@ -32,19 +63,53 @@ private:
     struct VarInfo {
         llvm::Value* value;
         Type type;
-        VarInfo(llvm::Value* v = nullptr, Type t = Type(TypeKind::Any)) : value(v), type(std::move(t)) {}
+        // Set for i32/i64/f64 locals and loop counters: `value` then points at
+        // an unboxed slot of this LLVM type instead of an Any.
+        llvm::Type* native;
+        // Set when `value` was bound by a `fungsi` declaration: calls through
+        // the variable try this function's direct entry first.
+        llvm::Function* function = nullptr;
+        VarInfo(llvm::Value* v = nullptr, Type t = Type(TypeKind::Any), llvm::Type* n = nullptr)
+            : value(v), type(std::move(t)), native(n) {}
+    };
+
+    // Typed entry of a `fungsi`: void(Any* result, params...), with i32/i64/f64
+    // parameters passed unboxed and the rest as Any*. The VM-ABI function of
+    // the same name only unpacks its args array and forwards here.
+    struct DirectEntry {
+        llvm::Function* function;
+        std::vector<Type> params;
     };
+    std::unordered_map<llvm::Function*, DirectEntry> directEntries; // keyed by the VM-ABI function
+    std::unordered_set<const llvm::Function*> directBodies;
     
     // Scope management
-    std::vector<std::map<std::string, VarInfo>> scopes;
+    std::vector<std::unordered_map<Symbol, VarInfo>> scopes;
     void pushScope();
     void popScope();
-    VarInfo lookupVariable(const std::string& name);
+    VarInfo lookupVariable(Symbol name);
     int mapTypeToRuntime(const Type& type);
+    uint32_t packedArrayKind(const Type& type); // ManifastArrayKind that f64[] / i32[] declarations store
     Type resolveType(const Type& type);
     void enforceStaticType(const Expr* expr, const Type& expected, const std::string& context = "");
     void reportError(const ASTNode* node, const std::string& category, const std::string& message);
-    std::string source;
+    std::string_view source; // owned by the caller
+    int optLevel = 0;
+    std::string objectCacheDir; // empty: JIT output is not cached
+    bool lazyCompilation = false;
+    unsigned compileThreads = 0;
+    unsigned anonFunctions = 0; // names anon_fn_0, anon_fn_1, ... in source order
+    const ExecutionProfile* profile = nullptr;
+    std::string runtimeBitcode;
+    bool linkRuntimeBitcode();
+    llvm::MDNode* branchWeights(int offset);        // nullptr: no profile for it
+    void applyCallProfile(llvm::Function* func, const std::string& name);
+    std::string objectCacheKey(const std::string& cpu, const std::string& features) const;
+
+    // Target machine for the host CPU; also stamps the module's layout/triple.
+    std::unique_ptr<llvm::TargetMachine> createHostTargetMachine();
+    void optimizeModule(llvm::Module& M, llvm::TargetMachine* targetMachine);
+    void emitFile(const std::string& path, llvm::CodeGenFileType fileType);
 
     llvm::Value* generateExpr(const Expr* expr);
     void generateStmt(const Stmt* stmt);
@@ -78,7 +143,7 @@ private:
     void visitTryStmt(const TryStmt* stmt);
     void visitTypeAliasStmt(const TypeAliasStmt* stmt);
 
-    std::vector<std::map<std::string, Type>> typeAliases;
+    std::vector<std::unordered_map<Symbol, Type>> typeAliases;
     
 private:
     // Dynamic Typing Support
@@ -96,12 +161,38 @@ private:
     // Helpers
     void initializeTypes();
     llvm::CallBase* createCallOrInvoke(llvm::Function* callee, llvm::ArrayRef<llvm::Value*> args, const llvm::Twine& name = "");
+    llvm::Value* createLiteral(int type, double number, llvm::Constant* ptr = nullptr);
     llvm::Value* createNumber(double value); // Literals
     llvm::Value* createString(const std::string& value);
     llvm::Value* boxDouble(llvm::Value* v);  // Runtime values
     llvm::Value* createArray(const std::vector<llvm::Value*>& elements);
     llvm::Value* createObject(const std::vector<std::pair<std::string, llvm::Value*>>& pairs);
     llvm::Value* unboxNumber(llvm::Value* anyVal);
+
+    // Unboxed numeric path: evaluates to a double without heap-boxing
+    // intermediates. Only the final result is boxed when it leaves as an Any*.
+    llvm::Value* generateNumber(const Expr* expr);
+    llvm::Value* generateNumberChecked(const Expr* expr, int runtimeType);
+    bool isStaticallyNumeric(const Expr* expr);
+    llvm::Value* emitNumericOp(TokenType op, llvm::Value* L, llvm::Value* R);
+    llvm::Type* nativeTypeFor(const Type& type);
+    llvm::Value* boxNumberTemp(llvm::Value* d); // Stack Any holding a number
+    llvm::Value* boxTemp(int type, llvm::Value* d);
+    llvm::Value* boxPointerTemp(int type, llvm::Value* ptr);
+    llvm::AllocaInst* createEntryAlloca(llvm::Type* type, const llvm::Twine& name);
+    llvm::Value* escapeToHeap(llvm::Value* any); // for values outliving the frame
+    // Like generateExpr, for operands that are only read while the caller runs.
+    llvm::Value* generateBorrowed(const Expr* expr);
+    llvm::Value* assignNative(const VarInfo& info, const AssignExpr* expr);
+    void bindParameter(llvm::Function* func, const Parameter& param, size_t index);
+    void bindDirectParameter(llvm::Function* func, const Parameter& param, size_t index);
+    llvm::Value* returnSlot(llvm::Function* func); // where `kembali` stores the result
+    // Call lowering. Arguments are evaluated once into `boxed` (Any*), with
+    // `numbers` holding the unboxed double of statically numeric ones.
+    void generateCallArgs(const CallExpr* expr, std::vector<llvm::Value*>& boxed, std::vector<llvm::Value*>& numbers);
+    llvm::Value* emitDynamicCall(llvm::Value* callee, const std::vector<llvm::Value*>& boxed);
+    llvm::Value* emitDirectCall(const DirectEntry& entry, const std::vector<llvm::Value*>& boxed,
+                                const std::vector<llvm::Value*>& numbers);
     llvm::Value* unboxString(llvm::Value* anyVal);
     void printAny(llvm::Value* anyVal); // Runtime helper stub
 };
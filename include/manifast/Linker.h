@@ -0,0 +1,28 @@
+#ifndef MANIFAST_LINKER_H
+#define MANIFAST_LINKER_H
+
+#include <string>
+#include <vector>
+
+namespace manifast {
+
+// Static link of an AOT-compiled object against the Manifast runtime.
+struct LinkRequest {
+    std::string object;
+    std::string output;
+    std::string driver = "g++";       // host C++ compiler driver
+    std::vector<std::string> libDirs; // where libmanifast_core lives
+    std::vector<std::string> libs{"manifast_core", "fmt"};
+};
+
+// Links `request.output`. Builds with LLD link in-process: the driver's link
+// line for this toolchain (crt objects, search paths, system libraries) is
+// probed once with `driver -###` and cached under <user cache dir>/manifast/link,
+// so later builds spawn nothing. Otherwise, or if probing fails, the driver
+// is run as usual. `command` receives the link line for display.
+// Returns 0 on success, like the driver's exit code.
+int linkExecutable(const LinkRequest& request, std::string* command = nullptr);
+
+} // namespace manifast
+
+#endif
@@ -20,6 +20,14 @@ public:
 
     // Entry point
     std::vector<std::unique_ptr<Stmt>> parse();
+    // Same, but nodes are bump-allocated from `arena`, which must outlive them.
+    std::vector<std::unique_ptr<Stmt>> parse(AstArena& arena);
+
+    // Streaming form of parse(): returns the next top-level statement, or
+    // nullptr once the input is exhausted, so callers can compile and free
+    // each statement before the rest of the file is parsed.
+    std::unique_ptr<Stmt> parseNext();
+    bool atEnd() const { return currentToken.type == TokenType::EndOfFile; }
 
 private:
     // Statement Parsers
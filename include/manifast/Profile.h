@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace manifast {
+
+// Counts recorded by an instrumented VM run (VM::setProfile) and consumed by
+// CodeGen::setProfile as branch weights and function entry counts.
+// Branches are keyed by the source offset of the `jika`, `selama`, `dan` or
+// `atau` they belong to, so they only apply to the exact source they were
+// recorded from; `source` is that source's fingerprint.
+class ExecutionProfile {
+public:
+    struct BranchCounts {
+        uint64_t taken = 0;    // condition was truthy
+        uint64_t notTaken = 0;
+    };
+
+    static uint64_t fingerprint(std::string_view source);
+
+    uint64_t source = 0;
+    std::unordered_map<std::string, uint64_t> calls; // by function (chunk) name
+    std::unordered_map<int, BranchCounts> branches;  // by source offset
+
+    void recordCall(const std::string& function) { ++calls[function]; }
+    void recordBranch(int offset, bool taken) {
+        BranchCounts& c = branches[offset];
+        ++(taken ? c.taken : c.notTaken);
+    }
+    // Adds the counts of `other` (a run of the same source) to this profile.
+    void merge(const ExecutionProfile& other);
+    bool matches(std::string_view src) const { return source == fingerprint(src); }
+
+    // Line-based text format, entries sorted so equal profiles serialize equally:
+    //   manifast-profile 1
+    //   source <fingerprint>
+    //   call <count> <name>
+    //   branch <offset> <taken> <notTaken>
+    std::string serialize() const;
+    bool parse(std::string_view text); // false on malformed input
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+};
+
+} // namespace manifast
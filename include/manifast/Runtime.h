@@ -34,7 +34,8 @@ enum AnyType {
     ANY_INT64 = 13,
     ANY_FLOAT32 = 14,
     ANY_FLOAT64 = 15,
-    ANY_CHAR = 16
+    ANY_CHAR = 16,
+    ANY_MAP = 17
 };
 
 struct Any {
@@ -45,10 +46,34 @@ struct Any {
 
 typedef void (*ManifastNativeFn)(void* vm, Any* args, int nargs);
 
+// Element storage of a ManifastArray. Packed arrays (typed `f64[]` / `i32[]`
+// declarations, math.f64array/math.i32array, math.linspace) keep raw numbers
+// contiguously and only ever hold numbers.
+struct ManifastArrayHash; // Runtime.cpp
+
+enum ManifastArrayKind {
+    ARRAY_ANY = 0, // elements
+    ARRAY_F64 = 1, // f64
+    ARRAY_I32 = 2  // i32
+};
+
 struct ManifastArray {
     uint32_t size;
     uint32_t capacity;
-    Any* elements;
+    union {
+        Any* elements;
+        double* f64;
+        int32_t* i32;
+    };
+    uint32_t kind; // ManifastArrayKind
+    // Set on a slice view (manifast_array_slice) and on the array it was taken
+    // from: the storage is referenced by both, so whichever writes first takes
+    // a private copy (manifast_array_unshare).
+    uint32_t shared;
+    // Sparse part (Lua-style): indices set far past the dense end live here
+    // instead of nil-filling the gap. Null until first needed; len() and the
+    // bulk operations only see the dense part.
+    ManifastArrayHash* hash;
 };
 
 struct ManifastObjectEntry {
@@ -72,12 +97,37 @@ struct ManifastInstance {
     ManifastObject* fields;
 };
 
+// Hash map value (the `map` module, m[k]): number or string keys, open
+// addressing with linear probing. String keys are copied into the map and
+// freed again when their entry is deleted, not interned.
+enum ManifastMapSlot {
+    MAP_EMPTY = 0,
+    MAP_LIVE = 1,
+    MAP_DELETED = 2
+};
+
+struct ManifastMapEntry {
+    Any key;
+    Any value;
+    uint32_t hash;
+    uint32_t state; // ManifastMapSlot
+};
+
+struct ManifastMap {
+    uint32_t count;    // live entries
+    uint32_t used;     // live + deleted slots
+    uint32_t capacity; // power of two; 0 until the first insert
+    uint32_t iterating; // map.each calls running; deleted string keys are not freed meanwhile
+    ManifastMapEntry* entries;
+};
+
 // Runtime functions called by LLVM IR
 MF_API Any* manifast_create_number(double val);
 MF_API Any* manifast_create_string(const char* str);
 MF_API Any* manifast_create_boolean(bool val);
 MF_API Any* manifast_create_nil();
 MF_API Any* manifast_create_array(uint32_t initial_size);
+MF_API Any* manifast_create_typed_array(uint32_t size, uint32_t kind); // zero-filled
 MF_API Any* manifast_create_object();
 MF_API Any* manifast_create_class(const char* name);
 MF_API Any* manifast_create_instance(Any* class_any);
@@ -86,10 +136,46 @@ MF_API Any* manifast_object_get(Any* obj_any, const char* key);
 MF_API void manifast_object_set_raw(ManifastObject* obj, const char* key, Any* val_any);
 MF_API Any* manifast_object_get_raw(ManifastObject* obj, const char* key);
 MF_API void manifast_array_set(Any* arr_any, double index, Any* val_any);
+// For packed arrays the result is a per-thread scratch value, valid until the
+// next manifast_array_get call on this thread: copy it out.
 MF_API Any* manifast_array_get(Any* arr_any, double index);
 MF_API double manifast_array_len(Any* arr_any);
 MF_API void manifast_array_push(Any* arr_any, Any* val_any);
 MF_API Any* manifast_array_pop(Any* arr_any);
+MF_API Any manifast_array_element(const ManifastArray* arr, uint32_t index0); // 0-based, unchecked
+// Bulk operations behind the array methods (positions are 1-based)
+MF_API void manifast_array_reserve(Any* arr_any, double capacity);
+MF_API void manifast_array_fill(Any* arr_any, Any* val_any, double first, double last); // grows to `last`
+MF_API Any* manifast_array_concat(Any* arr_any, Any* others, int n); // arrays spread, other values appended
+MF_API double manifast_array_index_of(Any* arr_any, Any* val_any, double from); // 0 if absent
+MF_API void manifast_array_reverse(Any* arr_any);
+// Ascending, in place: numbers (NaNs last) or strings; false if the array
+// mixes types or holds neither
+MF_API bool manifast_array_sort(Any* arr_any);
+// arr[first:last] (1-based, inclusive, clamped) as a view sharing arr's storage
+MF_API Any* manifast_array_slice(Any* arr_any, int32_t first, int32_t last);
+// Call before writing into an array's storage directly (not via array_set/push)
+MF_API void manifast_array_unshare(ManifastArray* arr);
+// A packed copy of the array as `kind` (copy-on-write when it already is
+// one), so writes through the result never reach the original. Null if an
+// element is not a number, or not an integer in range for ARRAY_I32.
+MF_API Any* manifast_array_packed(Any* arr_any, uint32_t kind);
+// Typed declarations: replaces *val with manifast_array_packed's result, or
+// throws a TypeError.
+MF_API void manifast_type_check_array(Any* val, uint32_t kind);
+MF_API Any* manifast_create_map();
+MF_API Any* manifast_map_get(Any* map_any, Any* key); // nil if absent
+MF_API void manifast_map_set(Any* map_any, Any* key, Any* val); // nil deletes
+MF_API bool manifast_map_delete(Any* map_any, Any* key);
+MF_API double manifast_map_len(Any* map_any);
+// Live entry in the first slot at or after *cursor, advancing it; false once
+// past the end. String keys come back as copies. Deleting during iteration
+// is fine; inserting may rehash.
+MF_API bool manifast_map_next(Any* map_any, uint32_t* cursor, Any* key, Any* val);
+// obj[key] for keys that are not known to be numbers: maps, objects with
+// string keys, arrays. manifast_array_get/set also accept a map.
+MF_API Any* manifast_index_get(Any* obj, Any* key);
+MF_API void manifast_index_set(Any* obj, Any* key, Any* val);
 MF_API void manifast_print_any(Any* any);
 MF_API void manifast_println_any(Any* any);
 MF_API void manifast_printfmt(Any* fmt, Any* any); // Simple version for now
@@ -120,6 +206,13 @@ MF_API void manifast_set_clear_output_callback(ManifastClearOutputCallback cb);
 typedef void (*ManifastDelayCallback)(int ms);
 MF_API void manifast_set_delay_callback(ManifastDelayCallback cb);
 
+// Runs bytecode functions (ANY_BYTECODE) for manifast_call_dynamic. A running
+// VM installs itself here for the current thread; natives called through
+// manifast_call_dynamic get that `vm` too.
+typedef Any (*ManifastCallHandler)(void* vm, Any* callee, Any* args, int nargs);
+MF_API void manifast_set_call_handler(ManifastCallHandler handler, void* vm);
+MF_API void manifast_get_call_handler(ManifastCallHandler* handler, void** vm);
+
 } // extern "C"
 
 #ifdef __cplusplus
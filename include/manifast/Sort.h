@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace manifast {
+namespace sort {
+
+// Introsort: median-of-three quicksort, heapsort once the recursion gets
+// deeper than 2*log2(n), insertion sort for short runs. Every loop is bounds
+// checked, so a comparator that is not a strict weak order (a script callback
+// answering at random) gives some permutation of the input, never a crash.
+// Not stable.
+
+namespace detail {
+
+constexpr ptrdiff_t kInsertionMax = 16;
+
+template <class T, class Less>
+void insertionSort(T* first, T* last, Less& less) {
+    for (T* i = first + 1; i < last; ++i) {
+        T v = std::move(*i);
+        T* j = i;
+        for (; j > first && less(v, j[-1]); --j) *j = std::move(j[-1]);
+        *j = std::move(v);
+    }
+}
+
+template <class T, class Less>
+void siftDown(T* heap, ptrdiff_t n, ptrdiff_t root, Less& less) {
+    T v = std::move(heap[root]);
+    for (ptrdiff_t child; (child = 2 * root + 1) < n; root = child) {
+        if (child + 1 < n && less(heap[child], heap[child + 1])) ++child;
+        if (!less(v, heap[child])) break;
+        heap[root] = std::move(heap[child]);
+    }
+    heap[root] = std::move(v);
+}
+
+template <class T, class Less>
+void heapSort(T* first, T* last, Less& less) {
+    ptrdiff_t n = last - first;
+    for (ptrdiff_t i = n / 2; i-- > 0;) siftDown(first, n, i, less);
+    for (ptrdiff_t end = n - 1; end > 0; --end) {
+        std::swap(first[0], first[end]);
+        siftDown(first, end, 0, less);
+    }
+}
+
+template <class T, class Less>
+void introsortLoop(T* first, T* last, int depth, Less& less) {
+    while (last - first > kInsertionMax) {
+        if (depth-- == 0) {
+            heapSort(first, last, less);
+            return;
+        }
+        // Median of the second, middle and last elements becomes the pivot
+        T* a = first + 1;
+        T* b = first + (last - first) / 2;
+        T* c = last - 1;
+        if (less(*b, *a)) std::swap(a, b);
+        if (less(*c, *b)) b = less(*c, *a) ? a : c;
+        std::swap(*first, *b);
+
+        T* i = first + 1;
+        T* j = last - 1;
+        for (;;) {
+            while (i <= j && less(*i, *first)) ++i;
+            while (i <= j && less(*first, *j)) --j;
+            if (i >= j) break;
+            std::swap(*i++, *j--);
+        }
+        std::swap(*first, *j); // pivot into place: [first, j) <= *j <= (j, last)
+
+        // Recurse into the smaller side, loop on the larger
+        if (j - first < last - (j + 1)) {
+            introsortLoop(first, j, depth, less);
+            first = j + 1;
+        } else {
+            introsortLoop(j + 1, last, depth, less);
+            last = j;
+        }
+    }
+    insertionSort(first, last, less);
+}
+
+} // namespace detail
+
+template <class T, class Less>
+void introsort(T* first, T* last, Less less) {
+    if (last - first < 2) return;
+    int depth = 0;
+    for (ptrdiff_t n = last - first; n > 1; n >>= 1) depth += 2;
+    detail::introsortLoop(first, last, depth, less);
+}
+
+// Ascending with NaNs last. Arrays of at least kParallelMin elements are
+// split across threads and merged; `threads` overrides the choice (tests).
+void sortNumbers(double* data, size_t n, unsigned threads = 0);
+void sortInt32(int32_t* data, size_t n, unsigned threads = 0);
+
+constexpr size_t kParallelMin = size_t(1) << 18;
+
+} // namespace sort
+} // namespace manifast
@@ -0,0 +1,61 @@
+#ifndef MANIFAST_SYMBOL_H
+#define MANIFAST_SYMBOL_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <functional>
+
+namespace manifast {
+
+namespace detail {
+struct SymbolEntry {
+    uint32_t id;
+    std::string text;
+};
+} // namespace detail
+
+// Interned identifier. Every distinct spelling is stored once for the life of
+// the process, so a Symbol is a single pointer: copying is free and equality
+// is a pointer compare. id() is a dense integer (0 = empty) usable as a key.
+class Symbol {
+public:
+    Symbol() : entry(emptyEntry()) {}
+    Symbol(std::string_view text) : entry(intern(text)) {}
+    Symbol(const std::string& text) : entry(intern(text)) {}
+    Symbol(const char* text) : entry(intern(text)) {}
+
+    uint32_t id() const { return entry->id; }
+    const std::string& str() const { return entry->text; }
+    const char* c_str() const { return entry->text.c_str(); }
+    std::string_view view() const { return entry->text; }
+    bool empty() const { return entry->id == 0; }
+
+    operator const std::string&() const { return entry->text; }
+
+    friend bool operator==(Symbol a, Symbol b) { return a.entry == b.entry; }
+    friend bool operator!=(Symbol a, Symbol b) { return a.entry != b.entry; }
+    friend bool operator==(Symbol a, std::string_view b) { return a.view() == b; }
+    friend bool operator!=(Symbol a, std::string_view b) { return a.view() != b; }
+    friend bool operator==(Symbol a, const std::string& b) { return a.str() == b; }
+    friend bool operator!=(Symbol a, const std::string& b) { return a.str() != b; }
+    friend bool operator==(Symbol a, const char* b) { return a.view() == b; }
+    friend bool operator!=(Symbol a, const char* b) { return a.view() != b; }
+    friend std::string operator+(Symbol a, std::string_view b) { return a.str() + std::string(b); }
+    friend std::string operator+(std::string_view a, Symbol b) { return std::string(a) + b.str(); }
+
+private:
+    static const detail::SymbolEntry* intern(std::string_view text);
+    static const detail::SymbolEntry* emptyEntry();
+
+    const detail::SymbolEntry* entry;
+};
+
+} // namespace manifast
+
+template <>
+struct std::hash<manifast::Symbol> {
+    size_t operator()(manifast::Symbol s) const noexcept { return s.id(); }
+};
+
+#endif // MANIFAST_SYMBOL_H
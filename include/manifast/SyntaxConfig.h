@@ -4,6 +4,7 @@
 #include <unordered_map>
 #include <string_view>
 #include <string>
+#include <cstdint>
 
 namespace manifast {
 
@@ -14,61 +15,130 @@ struct string_hash {
     }
 };
 
+// Default Indonesian keyword set, recognized through a perfect hash that is
+// searched for at compile time. The hash table is only bypassed once a
+// SyntaxConfig is customized.
+namespace keywords {
+
+struct Entry {
+    std::string_view text;
+    TokenType type;
+};
+
+inline constexpr Entry kDefault[] = {
+    {"jika", TokenType::K_If},
+    {"maka", TokenType::K_Then},
+    {"tutup", TokenType::K_End},
+
+    // 'kalau' maps to ElseIf, 'sebaliknya'/'kecuali' to Else
+    {"kalau", TokenType::K_ElseIf},
+    {"sebaliknya", TokenType::K_Else},
+    {"kecuali", TokenType::K_Else},
+
+    {"fungsi", TokenType::K_Function},
+    {"kembali", TokenType::K_Return},
+    {"lokal", TokenType::K_Var},
+    {"local", TokenType::K_Var}, // Alias for English users
+    {"tetap", TokenType::K_Const},
+    {"selama", TokenType::K_While},
+    {"untuk", TokenType::K_For},
+    {"benar", TokenType::K_True},
+    {"salah", TokenType::K_False},
+    {"dan", TokenType::K_And},
+    {"atau", TokenType::K_Or},
+    {"nil", TokenType::K_Null},
+
+    // Loop / Flow
+    {"ke", TokenType::K_To},
+    {"langkah", TokenType::K_Step},
+    {"lakukan", TokenType::K_Do},
+    {"coba", TokenType::K_Try},
+    {"tangkap", TokenType::K_Catch},
+    {"kelas", TokenType::K_Class},
+    {"self", TokenType::K_Self},
+
+    // Types
+    {"string", TokenType::K_String},
+    {"boolean", TokenType::K_Boolean},
+    {"i8", TokenType::K_Int8},
+    {"i16", TokenType::K_Int16},
+    {"i32", TokenType::K_Int32},
+    {"int32", TokenType::K_Int32},
+    {"i64", TokenType::K_Int64},
+    {"f32", TokenType::K_Float32},
+    {"f64", TokenType::K_Float64},
+    {"char", TokenType::K_Char},
+    {"tipe", TokenType::K_Type},
+
+    {"bukan", TokenType::Bang}, // Logic NOT
+};
+
+inline constexpr size_t kTableSize = 128; // power of two, > 3x the keyword count
+
+constexpr uint32_t hash(std::string_view text, uint32_t seed) {
+    uint32_t h = seed;
+    for (char c : text) h = (h ^ (uint8_t)c) * 16777619u;
+    h ^= h >> 15; // FNV's low bits only see the low bits of the input; fold the high ones down
+    h *= 0x2c1b3c6du;
+    h ^= h >> 12;
+    return h;
+}
+
+struct Table {
+    uint32_t seed = 0;
+    size_t minLen = 0;
+    size_t maxLen = 0;
+    Entry slots[kTableSize] = {};
+};
+
+constexpr Table buildTable() {
+    Table t;
+    t.minLen = kDefault[0].text.size();
+    for (const Entry& e : kDefault) {
+        if (e.text.size() < t.minLen) t.minLen = e.text.size();
+        if (e.text.size() > t.maxLen) t.maxLen = e.text.size();
+    }
+    for (uint32_t seed = 2166136261u; seed != 2166136261u + 100000u; ++seed) {
+        bool used[kTableSize] = {};
+        bool ok = true;
+        for (const Entry& e : kDefault) {
+            size_t slot = hash(e.text, seed) & (kTableSize - 1);
+            if (used[slot]) { ok = false; break; }
+            used[slot] = true;
+        }
+        if (!ok) continue;
+        t.seed = seed;
+        for (const Entry& e : kDefault) t.slots[hash(e.text, seed) & (kTableSize - 1)] = e;
+        return t;
+    }
+    return t;
+}
+
+inline constexpr Table kTable = buildTable();
+static_assert(kTable.seed != 0, "no collision-free seed for the default keyword set; grow kTableSize");
+
+constexpr TokenType lookupDefault(std::string_view text) {
+    if (text.size() < kTable.minLen || text.size() > kTable.maxLen) return TokenType::Identifier;
+    const Entry& e = kTable.slots[hash(text, kTable.seed) & (kTableSize - 1)];
+    return e.text == text ? e.type : TokenType::Identifier;
+}
+
+constexpr bool defaultsRoundTrip() {
+    for (const Entry& e : kDefault) {
+        if (lookupDefault(e.text) != e.type) return false;
+    }
+    return lookupDefault("jikalau") == TokenType::Identifier && lookupDefault("x") == TokenType::Identifier;
+}
+static_assert(defaultsRoundTrip());
+
+} // namespace keywords
+
 class SyntaxConfig {
 public:
-    SyntaxConfig() {
-        // Initialize with default Indonesian Grammar
-        keywords["jika"] = TokenType::K_If;
-        keywords["maka"] = TokenType::K_Then;
-        keywords["tutup"] = TokenType::K_End;
-        
-        // Primary keyword mappings
-        // 'kalau' maps to ElseIf, 'sebaliknya'/'kecuali' to Else
-        keywords["kalau"] = TokenType::K_ElseIf; 
-        keywords["sebaliknya"] = TokenType::K_Else;
-        keywords["kecuali"] = TokenType::K_Else;
-        
-        keywords["fungsi"] = TokenType::K_Function;
-        keywords["kembali"] = TokenType::K_Return;
-        keywords["lokal"] = TokenType::K_Var;
-        keywords["local"] = TokenType::K_Var; // Alias for English users
-        keywords["tetap"] = TokenType::K_Const;
-        keywords["selama"] = TokenType::K_While; // changed from selagi
-        keywords["untuk"] = TokenType::K_For;
-        keywords["benar"] = TokenType::K_True;
-        keywords["salah"] = TokenType::K_False;
-        keywords["dan"] = TokenType::K_And;
-        keywords["atau"] = TokenType::K_Or;
-        keywords["nil"] = TokenType::K_Null; // changed from nihil
-        
-        // Loop / Flow
-        keywords["ke"] = TokenType::K_To;
-        keywords["langkah"] = TokenType::K_Step;
-        keywords["lakukan"] = TokenType::K_Do;
-        keywords["coba"] = TokenType::K_Try;
-        keywords["tangkap"] = TokenType::K_Catch;
-        keywords["kelas"] = TokenType::K_Class;
-        keywords["self"] = TokenType::K_Self;
-        
-        // Types
-        keywords["string"] = TokenType::K_String;
-        keywords["boolean"] = TokenType::K_Boolean;
-        keywords["i8"] = TokenType::K_Int8;
-        keywords["i16"] = TokenType::K_Int16;
-        keywords["i32"] = TokenType::K_Int32;
-        keywords["int32"] = TokenType::K_Int32;
-        keywords["i64"] = TokenType::K_Int64;
-        keywords["f32"] = TokenType::K_Float32;
-        keywords["f64"] = TokenType::K_Float64;
-        keywords["char"] = TokenType::K_Char;
-        keywords["tipe"] = TokenType::K_Type;
-
-
-        
-        keywords["bukan"] = TokenType::Bang; // Logic NOT
-    }
+    SyntaxConfig() = default; // default Indonesian grammar, served by keywords::lookupDefault
 
     TokenType lookupKeyword(std::string_view text) const {
+        if (!customized) return keywords::lookupDefault(text);
         auto it = keywords.find(text); // string_view lookup in C++20 map
         if (it != keywords.end()) {
             return it->second;
@@ -76,7 +146,28 @@ public:
         return TokenType::Identifier;
     }
 
+    // Customization switches this config over to a runtime map seeded with the defaults.
+    void setKeyword(std::string_view text, TokenType type) {
+        customize();
+        keywords[std::string(text)] = type;
+    }
+
+    void removeKeyword(std::string_view text) {
+        customize();
+        auto it = keywords.find(text);
+        if (it != keywords.end()) keywords.erase(it);
+    }
+
+    bool isCustomized() const { return customized; }
+
 private:
+    void customize() {
+        if (customized) return;
+        for (const auto& e : keywords::kDefault) keywords.emplace(std::string(e.text), e.type);
+        customized = true;
+    }
+
+    bool customized = false;
     std::unordered_map<std::string, TokenType, string_hash, std::equal_to<>> keywords;
 };
 
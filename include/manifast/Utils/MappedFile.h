@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace manifast {
+namespace utils {
+
+// Read-only view of a whole file. The file is memory-mapped where possible so
+// large scripts are paged in by the OS on demand instead of being copied into
+// a std::string; platforms or files that cannot be mapped are read instead.
+// The view stays valid for the lifetime of the MappedFile.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) { CloseHandle(file); return false; }
+        opened = true;
+        if (size.QuadPart > 0) {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping) {
+                void* p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                CloseHandle(mapping);
+                if (p) {
+                    mapped = static_cast<const char*>(p);
+                    length = (size_t)size.QuadPart;
+                }
+            }
+            if (!mapped) opened = readAll(file);
+        }
+        CloseHandle(file);
+        return opened;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) { ::close(fd); return false; }
+        opened = true;
+        if (S_ISREG(st.st_mode) && st.st_size > 0) {
+            void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL
+                madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+                mapped = static_cast<const char*>(p);
+                length = (size_t)st.st_size;
+            }
+        }
+        if (!mapped) opened = readAll(fd); // pipes, /dev/stdin, mmap failure
+        ::close(fd);
+        return opened;
+#endif
+    }
+
+    void close() {
+        if (mapped) {
+#ifdef _WIN32
+            UnmapViewOfFile(mapped);
+#else
+            munmap(const_cast<char*>(mapped), length);
+#endif
+        }
+        mapped = nullptr;
+        length = 0;
+        buffer.clear();
+        buffer.shrink_to_fit();
+        opened = false;
+    }
+
+    bool isOpen() const { return opened; }
+    bool isMapped() const { return mapped != nullptr; }
+
+    std::string_view view() const {
+        if (mapped) return std::string_view(mapped, length);
+        return buffer;
+    }
+
+private:
+#ifdef _WIN32
+    bool readAll(HANDLE file) {
+        char chunk[64 * 1024];
+        DWORD n = 0;
+        while (ReadFile(file, chunk, sizeof(chunk), &n, nullptr) && n > 0) buffer.append(chunk, n);
+        return true;
+    }
+#else
+    bool readAll(int fd) {
+        char chunk[64 * 1024];
+        ssize_t n;
+        while ((n = ::read(fd, chunk, sizeof(chunk))) > 0) buffer.append(chunk, (size_t)n);
+        return n == 0;
+    }
+#endif
+
+    const char* mapped = nullptr;
+    size_t length = 0;
+    std::string buffer;
+    bool opened = false;
+};
+
+} // namespace utils
+} // namespace manifast
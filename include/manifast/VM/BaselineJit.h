@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Tiering.h"
+#include <memory>
+
+namespace manifast {
+namespace vm {
+
+// T1 backend: a template JIT that translates each instruction of a chunk
+// into a fixed x86-64 code sequence (no register allocation, no IR), with
+// type guards that side-exit to the interpreter. Compiles in microseconds.
+// Returns nullptr on hosts it cannot generate code for (non-x86-64, WASM).
+std::shared_ptr<TierBackend> createBaselineTierBackend();
+
+} // namespace vm
+} // namespace manifast
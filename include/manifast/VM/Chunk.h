@@ -1,6 +1,7 @@
 #pragma once
 
 #include "OpCode.h"
+#include "Tiering.h"
 #include "../Runtime.h"
 #include <vector>
 #include <string>
@@ -25,6 +26,9 @@ struct Chunk {
     
     // Sub-functions (nested chunks)
     std::vector<std::unique_ptr<Chunk>> functions;
+
+    // Profile and compiled code for tiered execution
+    TierState tiering;
     
     void write(Instruction instruction, int line, int offset = -1) {
         code.push_back(instruction);
@@ -39,6 +43,7 @@ struct Chunk {
     
     // Helpers
     void free() {
+        tiering = TierState(); // first: waits for a background compile reading the code
         code.clear();
         lines.clear();
         offsets.clear();
@@ -18,13 +18,20 @@ public:
     // Entry point: compile AST into a chunk
     bool compile(const std::vector<std::unique_ptr<Stmt>>& statements, Chunk& chunk, const std::string& name = "<script>");
 
+    // Incremental form of compile(): begin(), then compileTopLevel() once per
+    // statement as it is parsed, then finish(). The compiled chunk keeps no
+    // reference to the AST, so each statement may be freed right after.
+    void begin(Chunk& chunk, const std::string& name = "<script>");
+    void compileTopLevel(Stmt* stmt);
+    void finish();
+
 private:
     Chunk* currentChunk;
     int nextReg; // Next available register index (RegStack pointer)
     
     // Scopes for local variables checking
     struct Local {
-        std::string name;
+        Symbol name;
         int depth;
         int reg; // Which register holds this local
     };
@@ -33,7 +40,13 @@ private:
     int scopeDepth;
     
     // Type alias registry (resolved at compile time)
-    std::unordered_map<std::string, Type> typeAliases;
+    std::unordered_map<Symbol, Type> typeAliases;
+
+    // Identifier -> string constant index in currentChunk, so every reference
+    // to the same global/property name shares one constant slot.
+    std::unordered_map<Symbol, int> nameConstants;
+    // Numeric literal (bit pattern) -> constant index, same idea for numbers.
+    std::unordered_map<uint64_t, int> numberConstants;
     Type resolveType(const Type& t);
     
     // Dispatch
@@ -42,11 +55,16 @@ private:
     
     // Helpers
     int emit(Instruction i, int line = 0, int offset = -1);
+    int emitABx(OpCode op, int a, int bx, int line = 0, int offset = -1);
     int makeConstant(Any value);
-    int resolveLocal(const std::string& name);
+    int nameConstant(Symbol name);
+    int numberConstant(double value);
+    int constantOperand(int k); // RK(k), or a fresh register holding K(k) if k > MAXINDEXRK
+    int resolveLocal(Symbol name);
     int allocReg();
     void freeReg(); // Pop last reg
-    void emitTypeCheck(int reg, const Type& type, int line = 0, int offset = -1);
+    // packArrays: f64[] / i32[] values are also repacked as typed arrays (declarations)
+    void emitTypeCheck(int reg, const Type& type, int line = 0, int offset = -1, bool packArrays = false);
     
     Chunk* compileFunctionBody(const std::vector<Parameter>& params, Stmt* body, const std::string& name = "<lambda>");
     int compileClass(ClassStmt* stmt);
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Tiering.h"
+#include <memory>
+
+namespace manifast {
+namespace vm {
+
+// T2 backend: lowers the numeric and control-flow part of a chunk's bytecode
+// to LLVM IR, runs the -O<optLevel> pipeline on it and JIT-compiles it.
+// Part of manifast_jit; register it with setDefaultTierBackend(Tier::T2, ...).
+std::shared_ptr<TierBackend> createLLVMTierBackend(int optLevel = 2);
+
+} // namespace vm
+} // namespace manifast
@@ -41,7 +41,7 @@ enum class OpCode : uint8_t {
     NEWARRAY,   // R(A) := {} with size B
     NEWTABLE,   // R(A) := {}
     NEWCLASS,   // R(A) := class(name=K(B))
-    SETLIST,    // R(A)[(C-1)*FPF + i] := R(A+i), 1 <= i <= B
+    SETLIST,    // R(A)[(C-1)*FPF + i] := R(A+i), 1 <= i <= B (C == 0: C in next word)
     SETTABLE,   // R(A)[RK(B)] := RK(C)
     GETTABLE,   // R(A) := R(B)[RK(C)]
     GETSLICE,   // R(A) := R(B)[RK(C):RK(D)]
@@ -59,6 +59,14 @@ enum class OpCode : uint8_t {
 
 enum class OpMode { iABC, iABx, iAsBx };
 
+constexpr int MAXARG_Bx = 0x3FFFF;
+constexpr int MAXINDEXRK = 255; // largest constant index encodable as RK(x)
+constexpr int LFIELDS_PER_FLUSH = 50; // array elements stored per SETLIST
+
+// Constant indices that do not fit in Bx are encoded as Bx == MAXARG_Bx with
+// the real index stored in the following code word (LOADK, GETGLOBAL,
+// SETGLOBAL, NEWCLASS, TYPE_CHECK). SETLIST does the same for C == 0.
+
 inline OpCode getOpCode(Instruction i) { return static_cast<OpCode>(i & 0x3F); }
 inline uint8_t getA(Instruction i) { return (i >> 6) & 0xFF; }
 inline uint16_t getB(Instruction i) { return (i >> 23) & 0x1FF; }
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "OpCode.h"
+#include "../Runtime.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace manifast {
+namespace vm {
+
+struct Chunk;
+class VM;
+
+// Execution tiers of the bytecode VM:
+//   T0 - interpreter (VM::run)
+//   T1 - baseline compiler: quick to produce, straight translation of bytecode
+//   T2 - optimizing compiler (LLVM)
+// VM::setTier() sets the highest tier a VM may promote chunks to.
+enum class Tier { T0, T1, T2 };
+
+// Compiled form of a chunk. Executes from `startPc` directly on the frame's
+// registers and returns the pc where the interpreter must resume: either an
+// instruction the tier does not handle (calls, returns, tables, ...) or one
+// whose operand types did not match the compiled fast path. Native code never
+// leaves an instruction half-done, so the interpreter simply re-executes it.
+// An entry asked to start at a pc it has no entry point for returns startPc.
+using NativeEntry = int (*)(Any* regs, const Any* constants, int startPc);
+
+// What the promoting VM lets a backend bake into compiled code.
+struct TierContext {
+    // The VM's slot for global `name`, or nullptr if it is not defined yet.
+    // Slots never move, so compiled code may load and store them directly.
+    std::function<Any*(const char* name)> globalSlot;
+};
+
+class TierBackend {
+public:
+    virtual ~TierBackend() = default;
+    virtual const char* name() const = 0;
+    // Compile `chunk`, or return nullptr to keep it in the lower tier. The
+    // code must stay valid for as long as the backend is alive.
+    virtual NativeEntry compile(const Chunk& chunk, const TierContext& context) = 0;
+    // Slow backends are run on a worker thread; the chunk keeps executing in
+    // its current tier until the code is ready. `compile` then must not call
+    // back into the VM beyond the TierContext it is given.
+    virtual bool compilesInBackground() const { return false; }
+};
+
+// A compile running on a worker thread. Destroying it waits for the worker,
+// so a chunk is never freed while it is being compiled.
+struct PendingCompile {
+    Tier tier = Tier::T0;
+    std::shared_ptr<TierBackend> backend;
+    const VM* requestedBy = nullptr;
+    NativeEntry result = nullptr;
+    std::atomic<bool> done{false};
+    std::thread worker;
+
+    ~PendingCompile() {
+        if (worker.joinable()) worker.join();
+    }
+};
+
+// Per-chunk hotness and tier state, driven by VM::run.
+struct TierState {
+    uint32_t hotness = 0;       // calls + loop back-edges
+    uint32_t nextPromotion = 1; // hotness at which VM::promote runs next
+    Tier tier = Tier::T0;
+    NativeEntry native = nullptr;
+    std::shared_ptr<TierBackend> owner; // keeps `native` alive
+    const VM* boundTo = nullptr;        // VM whose global slots `native` uses
+    std::shared_ptr<PendingCompile> pending; // background compile in flight
+};
+
+// Backends new VMs start with (VM::setTierBackend overrides per VM).
+void setDefaultTierBackend(Tier tier, std::shared_ptr<TierBackend> backend);
+std::shared_ptr<TierBackend> defaultTierBackend(Tier tier);
+
+// Bytecode shape helpers shared by the backends.
+// Number of code words taken by the instruction at `pc` (extension words included).
+int instructionLength(const Chunk& chunk, int pc);
+// Pcs native code can be entered at: the chunk start and every backward jump target.
+std::vector<int> tierEntryPoints(const Chunk& chunk);
+
+} // namespace vm
+} // namespace manifast
@@ -1,27 +1,42 @@
 #pragma once
 
 #include "manifast/VM/Chunk.h"
+#include "manifast/VM/Tiering.h"
+#include "manifast/Profile.h"
+#include <memory>
 #include <vector>
 #include <unordered_map>
 #include <string>
+#include <string_view>
 
 namespace manifast {
 namespace vm {
 
-    enum class Tier { T0, T1, T2 };
-    
 class VM {
 public:
     VM();
     ~VM();
 
+    // Highest tier hot chunks may be promoted to (T0 = interpret only, the
+    // default; the mifast CLI opts in to T2).
     void setTier(Tier t) { currentTier = t; }
     Tier getTier() const { return currentTier; }
 
+    // Hotness (calls + loop back-edges) at which a chunk moves up a tier.
+    void setTierThresholds(uint32_t t1, uint32_t t2) { tier1Threshold = t1; tier2Threshold = t2; }
+    void setTierBackend(Tier t, std::shared_ptr<TierBackend> backend);
+
+    // Record bytecode calls and `jika`/`selama`/`dan`/`atau` outcomes into
+    // `profile` (nullptr stops). Chunks stay in the interpreter while profiling.
+    void setProfile(ExecutionProfile* p) { profile = p; }
+
     void setStackSize(size_t size) { maxStackSize = size; stack.resize(maxStackSize); }
     size_t getStackSize() const { return maxStackSize; }
 
     void interpret(Chunk* chunk, std::string_view source = "");
+    // Calls a function value (bytecode or native) from native code, above the
+    // current frame, and returns its result.
+    Any call(const Any& fn, const Any* args, int n);
     void runtimeError(const std::string& message);
     
     // Globals
@@ -48,15 +63,21 @@ private:
     std::vector<CallFrame> frames;
     
     void run(int entryFrameDepth);
+    void promote(Chunk* chunk);
+    void finishPromotion(Chunk* chunk); // installs a finished background compile
     
     // Helpers
     void resetStack();
     
 private:
     Any lastResult;
-    std::string source;
+    std::string_view source; // owned by the caller of interpret()
     std::unordered_map<std::string, Any> globals;
     Tier currentTier = Tier::T0;
+    uint32_t tier1Threshold = 100;
+    uint32_t tier2Threshold = 10000;
+    std::shared_ptr<TierBackend> backends[3];
+    ExecutionProfile* profile = nullptr;
 };
 
 } // namespace vm
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+
+namespace manifast {
+namespace vecmath {
+
+// Bulk kernels behind the array forms of the `math` module (math.sin(arr),
+// math.sum(arr), ...). The instruction set is picked once per process: AVX2
+// when the CPU has it, else SSE2, else portable C++. All paths do the same
+// operations in the same order, so results do not depend on the CPU.
+enum class Isa { Scalar, Sse2, Avx2 };
+
+Isa activeIsa();
+const char* isaName(Isa isa);
+// Forces a path (tests, benchmarks); false if this build or CPU lacks it.
+bool selectIsa(Isa isa);
+
+// Elementwise; `out` may alias `x`. sin/exp match the libm result to within
+// a couple of ulps and fall back to libm outside |x| < 1e9 (sin) / 708 (exp).
+void sin(const double* x, double* out, size_t n);
+void exp(const double* x, double* out, size_t n);
+void sqrt(const double* x, double* out, size_t n);
+void axpy(double a, const double* x, double* y, size_t n); // y += a * x
+void cumsum(const double* x, double* out, size_t n);
+
+// Reductions add in eight interleaved partial sums.
+double sum(const double* x, size_t n);
+double dot(const double* x, const double* y, size_t n);
+double squaredDeviation(const double* x, size_t n, double center); // sum((x - center)^2)
+// NaNs are skipped; +inf / -inf if nothing is left.
+double min(const double* x, size_t n);
+double max(const double* x, size_t n);
+
+} // namespace vecmath
+} // namespace manifast
@@ -0,0 +1,252 @@
+#pragma once
+
+// Kernel templates shared by VecMath.cpp (portable, SSE2) and VecMathAvx2.cpp
+// (built with -mavx2). `S` wraps one instruction set: S::W doubles per S::V,
+// lane masks in S::M. Everything here has internal linkage on purpose: the
+// AVX2 translation unit's copies must never stand in for the others'.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace manifast {
+namespace vecmath {
+namespace {
+
+constexpr int kLanes = 8; // partial sums per reduction, whatever S::W is
+
+// One double per "vector"; also finishes the tails of the wider paths
+struct Scalar {
+    using V = double;
+    using M = bool;
+    static constexpr int W = 1;
+    static V load(const double* p) { return *p; }
+    static void store(double* p, V v) { *p = v; }
+    static V set1(double d) { return d; }
+    static V add(V a, V b) { return a + b; }
+    static V sub(V a, V b) { return a - b; }
+    static V mul(V a, V b) { return a * b; }
+    static V div(V a, V b) { return a / b; }
+    static V sqrt(V a) { return std::sqrt(a); }
+    static V min(V a, V b) { return a < b ? a : b; } // minpd: b unless a < b
+    static V max(V a, V b) { return a > b ? a : b; }
+    static V abs(V a) { return std::fabs(a); }
+    static M lt(V a, V b) { return a < b; }
+    static M gt(V a, V b) { return a > b; }
+    static M eq(V a, V b) { return a == b; }
+    static V select(M m, V a, V b) { return m ? a : b; }
+    static bool all(M m) { return m; }
+    static V trunc(V a) { return (double)(int32_t)a; } // |a| < 2^31
+    static V bxor(V a, V b) { return bits(raw(a) ^ raw(b)); }
+    static V signbits(V a) { return bits(raw(a) & 0x8000000000000000ull); }
+    static V pow2n(V n) { return bits((uint64_t)((int64_t)n + 1023) << 52); } // integral n in [-1022, 1023]
+
+private:
+    static uint64_t raw(double d) { uint64_t u; std::memcpy(&u, &d, sizeof u); return u; }
+    static double bits(uint64_t u) { double d; std::memcpy(&d, &u, sizeof d); return d; }
+};
+
+template <class S, size_t N>
+typename S::V polevl(typename S::V x, const double (&coef)[N]) {
+    typename S::V acc = S::set1(coef[0]);
+    for (size_t k = 1; k < N; k++) acc = S::add(S::mul(acc, x), S::set1(coef[k]));
+    return acc;
+}
+
+template <class S>
+typename S::V floorSmall(typename S::V v) { // |v| < 2^31
+    typename S::V t = S::trunc(v);
+    return S::select(S::gt(t, v), S::sub(t, S::set1(1.0)), t);
+}
+
+// Cephes exp: n = round(x / ln 2), Pade approximant on the remainder
+struct ExpOp {
+    static constexpr double limit = 708.0; // 2^n stays a normal number
+    static double libm(double x) { return std::exp(x); }
+
+    template <class S>
+    static typename S::V fast(typename S::V x) {
+        static const double P[] = {1.26177193074810590878E-4, 3.02994407707441961300E-2, 9.99999999999999999910E-1};
+        static const double Q[] = {3.00198505138664455042E-6, 2.52448340349684104192E-3,
+                                   2.27265548208155028766E-1, 2.00000000000000000009E0};
+        typename S::V n = floorSmall<S>(S::add(S::mul(S::set1(1.4426950408889634073599), x), S::set1(0.5)));
+        x = S::sub(x, S::mul(n, S::set1(6.93145751953125E-1)));
+        x = S::sub(x, S::mul(n, S::set1(1.42860682030941723212E-6)));
+        typename S::V xx = S::mul(x, x);
+        typename S::V px = S::mul(x, polevl<S>(xx, P));
+        x = S::div(px, S::sub(polevl<S>(xx, Q), px));
+        x = S::add(S::set1(1.0), S::mul(S::set1(2.0), x));
+        return S::mul(x, S::pow2n(n));
+    }
+};
+
+// Cephes sin: reduce by multiples of pi/4 (in three parts), then the sine or
+// cosine polynomial depending on the octant
+struct SinOp {
+    static constexpr double limit = 1.073741824e9;
+    static double libm(double x) { return std::sin(x); }
+
+    template <class S>
+    static typename S::V fast(typename S::V x) {
+        using V = typename S::V;
+        static const double sincof[] = {1.58962301576546568060E-10, -2.50507477628578072866E-8,
+                                        2.75573136213857245213E-6, -1.98412698295895385996E-4,
+                                        8.33333333332211858878E-3, -1.66666666666666307295E-1};
+        static const double coscof[] = {-1.13585365213876817300E-11, 2.08757008419747316778E-9,
+                                        -2.75573141792967388112E-7, 2.48015872888517045348E-5,
+                                        -1.38888888888730564116E-3, 4.16666666666665929218E-2};
+        const V one = S::set1(1.0);
+        V sign = S::signbits(x);
+        x = S::abs(x);
+        V y = S::trunc(S::div(x, S::set1(7.85398163397448309616E-1)));
+        V j = S::sub(y, S::mul(S::set1(8.0), S::trunc(S::mul(y, S::set1(0.125))))); // octant
+        auto odd = S::eq(S::sub(j, S::mul(S::set1(2.0), S::trunc(S::mul(j, S::set1(0.5))))), one);
+        y = S::select(odd, S::add(y, one), y);
+        j = S::select(odd, S::add(j, one), j);
+        j = S::select(S::eq(j, S::set1(8.0)), S::set1(0.0), j);
+        auto upper = S::gt(j, S::set1(3.0));
+        j = S::select(upper, S::sub(j, S::set1(4.0)), j);
+        sign = S::bxor(sign, S::select(upper, S::set1(-0.0), S::set1(0.0)));
+
+        V z = S::sub(x, S::mul(y, S::set1(7.85398125648498535156E-1)));
+        z = S::sub(z, S::mul(y, S::set1(3.77489470793079817668E-8)));
+        z = S::sub(z, S::mul(y, S::set1(2.69515142907905952645E-15)));
+        V zz = S::mul(z, z);
+        V c = S::add(S::sub(one, S::mul(zz, S::set1(0.5))), S::mul(S::mul(zz, zz), polevl<S>(zz, coscof)));
+        V s = S::add(z, S::mul(z, S::mul(zz, polevl<S>(zz, sincof))));
+        return S::bxor(S::select(S::eq(j, S::set1(2.0)), c, s), sign);
+    }
+};
+
+// Lanes outside Op::limit (and NaNs) are computed by libm instead
+template <class S, class Op>
+size_t mapLanes(const double* x, double* out, size_t n) {
+    size_t i = 0;
+    for (; i + S::W <= n; i += S::W) {
+        typename S::V v = S::load(x + i);
+        auto ok = S::lt(S::abs(v), S::set1(Op::limit));
+        if (S::all(ok)) {
+            S::store(out + i, Op::template fast<S>(v));
+            continue;
+        }
+        double in[S::W];
+        S::store(in, v); // out may alias x
+        S::store(out + i, Op::template fast<S>(S::select(ok, v, S::set1(0.0))));
+        for (int k = 0; k < S::W; k++) {
+            if (!(std::fabs(in[k]) < Op::limit)) out[i + k] = Op::libm(in[k]);
+        }
+    }
+    return i;
+}
+
+template <class S, class Op>
+void mapKernel(const double* x, double* out, size_t n) {
+    size_t i = mapLanes<S, Op>(x, out, n);
+    mapLanes<Scalar, Op>(x + i, out + i, n - i);
+}
+
+template <class S>
+void sqrtKernel(const double* x, double* out, size_t n) {
+    size_t i = 0;
+    for (; i + S::W <= n; i += S::W) S::store(out + i, S::sqrt(S::load(x + i)));
+    for (; i < n; i++) out[i] = std::sqrt(x[i]);
+}
+
+template <class S>
+void axpyKernel(double a, const double* x, double* y, size_t n) {
+    typename S::V va = S::set1(a);
+    size_t i = 0;
+    for (; i + S::W <= n; i += S::W) S::store(y + i, S::add(S::load(y + i), S::mul(va, S::load(x + i))));
+    for (; i < n; i++) y[i] = y[i] + a * x[i];
+}
+
+// Reductions keep kLanes partial results: lane k sees elements k, k+8, ...
+// `step` folds one vector of elements into a partial result.
+template <class S, class Step>
+size_t reduceLanes(double* lanes, double init, size_t n, Step step) {
+    constexpr int R = kLanes / S::W;
+    typename S::V acc[R];
+    for (int r = 0; r < R; r++) acc[r] = S::set1(init);
+    size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        for (int r = 0; r < R; r++) acc[r] = step(acc[r], i + r * S::W);
+    }
+    for (int r = 0; r < R; r++) S::store(lanes + r * S::W, acc[r]);
+    return i;
+}
+
+inline double combineSums(const double* lanes) {
+    double t0 = lanes[0] + lanes[4], t1 = lanes[1] + lanes[5];
+    double t2 = lanes[2] + lanes[6], t3 = lanes[3] + lanes[7];
+    return (t0 + t1) + (t2 + t3);
+}
+
+template <class S>
+double sumKernel(const double* x, size_t n) {
+    double lanes[kLanes];
+    size_t i = reduceLanes<S>(lanes, 0.0, n, [&](typename S::V acc, size_t at) { return S::add(acc, S::load(x + at)); });
+    for (size_t k = 0; i + k < n; k++) lanes[k] += x[i + k];
+    return combineSums(lanes);
+}
+
+template <class S>
+double dotKernel(const double* x, const double* y, size_t n) {
+    double lanes[kLanes];
+    size_t i = reduceLanes<S>(lanes, 0.0, n, [&](typename S::V acc, size_t at) {
+        return S::add(acc, S::mul(S::load(x + at), S::load(y + at)));
+    });
+    for (size_t k = 0; i + k < n; k++) lanes[k] += x[i + k] * y[i + k];
+    return combineSums(lanes);
+}
+
+template <class S>
+double squaredDeviationKernel(const double* x, size_t n, double center) {
+    typename S::V c = S::set1(center);
+    double lanes[kLanes];
+    size_t i = reduceLanes<S>(lanes, 0.0, n, [&](typename S::V acc, size_t at) {
+        typename S::V d = S::sub(S::load(x + at), c);
+        return S::add(acc, S::mul(d, d));
+    });
+    for (size_t k = 0; i + k < n; k++) {
+        double d = x[i + k] - center;
+        lanes[k] += d * d;
+    }
+    return combineSums(lanes);
+}
+
+// True if some element is not NaN
+inline bool anyNumber(const double* x, size_t n) {
+    for (size_t k = 0; k < n; k++) {
+        if (x[k] == x[k]) return true;
+    }
+    return false;
+}
+
+// min/max(element, partial): a NaN element leaves the partial result alone.
+// The ±inf seed only survives when every element is NaN (or is that same
+// infinity), so only then is the input scanned; with no number at all the
+// result is NaN.
+template <class S>
+double minKernel(const double* x, size_t n) {
+    double lanes[kLanes];
+    size_t i = reduceLanes<S>(lanes, INFINITY, n, [&](typename S::V acc, size_t at) { return S::min(S::load(x + at), acc); });
+    for (size_t k = 0; i + k < n; k++) lanes[k] = Scalar::min(x[i + k], lanes[k]);
+    double m = lanes[0];
+    for (int k = 1; k < kLanes; k++) m = Scalar::min(lanes[k], m);
+    return m == INFINITY && !anyNumber(x, n) ? NAN : m;
+}
+
+template <class S>
+double maxKernel(const double* x, size_t n) {
+    double lanes[kLanes];
+    size_t i = reduceLanes<S>(lanes, -INFINITY, n, [&](typename S::V acc, size_t at) { return S::max(S::load(x + at), acc); });
+    for (size_t k = 0; i + k < n; k++) lanes[k] = Scalar::max(x[i + k], lanes[k]);
+    double m = lanes[0];
+    for (int k = 1; k < kLanes; k++) m = Scalar::max(lanes[k], m);
+    return m == -INFINITY && !anyNumber(x, n) ? NAN : m;
+}
+
+} // namespace
+} // namespace vecmath
+} // namespace manifast
@@ -16,12 +16,16 @@
 #include "manifast/Runtime.h"
 #include "manifast/Lexer.h"
 #include "manifast/Parser.h"
+#include "manifast/Profile.h"
 #include "manifast/VM/Compiler.h"
 #include "manifast/VM/VM.h"
 #include "manifast/Utils/Path.h"
 #include "manifast/Utils/Process.h"
+#include "manifast/Utils/MappedFile.h"
 #ifdef MANIFAST_HAS_LLVM
 #include "manifast/CodeGen.h" 
+#include "manifast/Linker.h"
+#include "manifast/VM/LLVMTier.h"
 #endif
 
 #ifdef _WIN32
@@ -150,6 +154,7 @@ bool runTestInProcess(const std::string& source, std::string& outputLog, bool us
                     if (reusableVM) reusableVM->interpret(&chunk);
                     else {
                         manifast::vm::VM vm;
+                        vm.setTier(manifast::vm::Tier::T2);
                         vm.interpret(&chunk, source);
                     }
                     chunk.free();
@@ -179,13 +184,29 @@ bool runTestInProcess(const std::string& source, std::string& outputLog, bool us
 }
 
 
+// Reads the profile at `path` recorded for `source`. A missing, unreadable or
+// stale profile only costs the optimization, so it is reported and skipped.
+bool loadProfile(const std::string& path, std::string_view source, manifast::ExecutionProfile& profile) {
+    if (!profile.load(path)) {
+        fmt::print(fg(fmt::color::yellow), "Warning: Could not read profile '{}'; compiling without it.\n", path);
+        return false;
+    }
+    if (!profile.matches(source)) {
+        fmt::print(fg(fmt::color::yellow), "Warning: Profile '{}' was recorded for a different version of this file; ignoring it.\n", path);
+        return false;
+    }
+    return true;
+}
+
 void printUsage() {
     fmt::print(fmt::emphasis::bold, "Manifast Management Tool (mifast) v0.0.13\n");
     fmt::print("Usage: mifast <command> [args]\n\n");
     fmt::print("Commands:\n");
-    fmt::print("  run <file> [--vm] [--verbose] [--stack-size MB]  Compile and run a Manifast file\n");
-    fmt::print("  test [--vm] [--verbose]                          Run the project test suite (In-Process)\n");
-    fmt::print("  build <file> [-o output] [--verbose]             Compile a Manifast wrapper to native executable (AOT)\n");
+    fmt::print("  run <file> [--vm] [--tier 0..2] [-O0..3] [--no-cache] [--eager] [--jobs N] [--verbose] [--stack-size MB]   Compile and run a Manifast file\n");
+    fmt::print("      [--profile-out F]   with --vm: record branch and call counts of this run into F (merged with F's counts)\n");
+    fmt::print("      [--profile-use F]   without --vm: optimize the JIT code for the counts in F\n");
+    fmt::print("  test [--vm] [--verbose]                                                                Run the project test suite (In-Process)\n");
+    fmt::print("  build <file> [-o output] [-O0..3] [--profile-use F] [--verbose]                        Compile a Manifast wrapper to native executable (AOT)\n");
 }
 
 int runTestRunner(bool useVM) {
@@ -204,6 +225,7 @@ int runTestRunner(bool useVM) {
     if (useVM) {
         sharedCompiler = std::make_unique<manifast::vm::Compiler>();
         sharedVM = std::make_unique<manifast::vm::VM>();
+        sharedVM->setTier(manifast::vm::Tier::T2);
     }
     
     std::map<std::string, std::vector<TestResult>> resultsByCategory;
@@ -330,8 +352,15 @@ int main(int argc, char* argv[]) {
 #endif
     bool debugDev = false;
     size_t stackSizeMB = 16; // default 16MB stack size
+    [[maybe_unused]] int optLevel = 0; // LLVM pipeline level for run (JIT) and build (AOT)
+    int maxTier = 2; // highest tier the VM may promote hot code to
+    [[maybe_unused]] bool objectCache = true; // reuse JIT output of earlier runs (run without --vm)
+    [[maybe_unused]] bool lazyJit = true; // compile functions on first call (run without --vm)
+    [[maybe_unused]] unsigned compileJobs = std::thread::hardware_concurrency(); // LLVM compile threads
     std::string filePath;
     std::string outputPath;
+    std::string profileOut; // run --vm: record an execution profile here
+    std::string profileIn;  // run (JIT) and build: optimize for this profile
     
     // Check for --vm or --verbose in any position after command
     for(int i = 2; i < argc; i++) {
@@ -341,9 +370,22 @@ int main(int argc, char* argv[]) {
         else if(arg == "--stack-size" && i + 1 < argc) {
             stackSizeMB = std::stoull(argv[++i]);
         }
+        else if(arg == "--no-cache") objectCache = false;
+        else if(arg == "--eager") lazyJit = false;
+        else if(arg == "--jobs" && i + 1 < argc) {
+            compileJobs = (unsigned)std::max(std::atoi(argv[++i]), 1);
+        }
+        else if(arg == "--tier" && i + 1 < argc) {
+            maxTier = std::clamp(std::atoi(argv[++i]), 0, 2);
+        }
+        else if(arg == "--profile-out" && i + 1 < argc) profileOut = argv[++i];
+        else if(arg == "--profile-use" && i + 1 < argc) profileIn = argv[++i];
         else if(arg == "-o" && i + 1 < argc) {
             outputPath = argv[++i];
         }
+        else if(arg.size() == 3 && arg[0] == '-' && arg[1] == 'O' && arg[2] >= '0' && arg[2] <= '3') {
+            optLevel = arg[2] - '0';
+        }
         else if (filePath.empty()) filePath = arg;
     }
 
@@ -372,15 +414,21 @@ int main(int argc, char* argv[]) {
         manifast::Lexer lexer(source, config);
         manifast::Parser parser(lexer);
         parser.debugMode = debugDev;
+        manifast::AstArena astArena;
         
         try {
-            auto statements = parser.parse();
+            auto statements = parser.parse(astArena);
             if (parser.hadError()) {
                 fmt::print(fg(fmt::color::red), "Syntax errors found. Compilation aborted.\n");
                 return 1;
             }
             
             manifast::CodeGen codegen(source);
+            codegen.setOptLevel(optLevel);
+            manifast::ExecutionProfile profile;
+            if (!profileIn.empty() && loadProfile(profileIn, source, profile)) codegen.setProfile(&profile);
+            fs::path runtimeBitcode = fs::weakly_canonical(fs::path(argv[0])).parent_path() / "manifast_runtime.bc";
+            if (fs::exists(runtimeBitcode)) codegen.setRuntimeBitcode(runtimeBitcode.string());
             codegen.compile(statements);
             
             fs::path out(outputPath);
@@ -451,24 +499,17 @@ int main(int argc, char* argv[]) {
 #endif
 
                 // Argv-style link (no shell) — avoids command injection via paths
-                std::vector<std::string> linkArgs = {
-                    gpp, objPath, "-o", actualOut, "-L" + libDir
-                };
-#ifdef _WIN32
-                if (!extraLibDir.empty()) linkArgs.push_back("-L" + extraLibDir);
-#endif
-                linkArgs.push_back("-L.");
-                linkArgs.push_back("-lmanifast_core");
-                linkArgs.push_back("-lfmt");
-                linkArgs.push_back("-static");
+                manifast::LinkRequest link;
+                link.object = objPath;
+                link.output = actualOut;
+                link.driver = gpp;
+                link.libDirs.push_back(libDir);
+                if (!extraLibDir.empty()) link.libDirs.push_back(extraLibDir);
+                link.libDirs.push_back(".");
 
                 std::string cmdStr;
-                for (size_t i = 0; i < linkArgs.size(); ++i) {
-                    if (i) cmdStr += ' ';
-                    cmdStr += linkArgs[i];
-                }
+                int ret = manifast::linkExecutable(link, &cmdStr);
                 fmt::print("Linking executable: {}\n", cmdStr);
-                int ret = manifast::utils::runCommand(linkArgs);
                 
                 if (ret == 0) {
                     fmt::print(fg(fmt::color::green), "Created Executable: {}\n", actualOut);
@@ -492,41 +533,88 @@ int main(int argc, char* argv[]) {
             return 1;
         }
         
-        std::ifstream file(filePath);
-        if (!file) {
+        // Map the script instead of copying it; statements are parsed and
+        // compiled one at a time so only the current statement's AST is live.
+        manifast::utils::MappedFile file(filePath);
+        if (!file.isOpen()) {
             fmt::print(fg(fmt::color::red), "Error: Could not open file.\n");
             return 1;
         }
-        std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::string_view source = file.view();
         manifast::SyntaxConfig config;
         manifast::Lexer lexer(source, config);
         manifast::Parser parser(lexer);
         parser.debugMode = debugDev;
+        manifast::AstArena astArena;
+        auto parseNext = [&]() {
+            astArena.reset(); // previous statement has been compiled and freed
+            manifast::AstArena::Scope scope(astArena);
+            return parser.parseNext();
+        };
         try {
-            auto statements = parser.parse();
-            
             if (useVM) {
                 manifast::vm::Chunk chunk;
                 manifast::vm::Compiler compiler;
                 compiler.debugMode = debugDev;
-                if (compiler.compile(statements, chunk)) {
-                    manifast::vm::VM vm;
-                    vm.debugMode = debugDev;
-                    
-                    // Convert MB to number of Any variants (roughly 16 bytes each)
-                    size_t numSlots = (stackSizeMB * 1024 * 1024) / sizeof(Any);
-                    vm.setStackSize(numSlots);
-                    
-                    vm.interpret(&chunk, source);
-                    chunk.free();
-                } else {
-                     fmt::print(fg(fmt::color::red), "Compilation failed.\n");
-                     return 1;
+                compiler.begin(chunk);
+                while (auto stmt = parseNext()) {
+                    compiler.compileTopLevel(stmt.get());
+                }
+                if (parser.hadError()) {
+                    fmt::print(fg(fmt::color::red), "Syntax errors found. Execution aborted.\n");
+                    return 1;
+                }
+                compiler.finish();
+
+#ifdef MANIFAST_HAS_LLVM
+                // Hot chunks end up in LLVM-compiled code (T2)
+                manifast::vm::setDefaultTierBackend(manifast::vm::Tier::T2,
+                    manifast::vm::createLLVMTierBackend(optLevel > 0 ? optLevel : 2));
+#endif
+                manifast::vm::VM vm;
+                vm.debugMode = debugDev;
+                vm.setTier((manifast::vm::Tier)maxTier);
+                
+                // Convert MB to number of Any variants (roughly 16 bytes each)
+                size_t numSlots = (stackSizeMB * 1024 * 1024) / sizeof(Any);
+                vm.setStackSize(numSlots);
+                
+                manifast::ExecutionProfile profile;
+                if (!profileOut.empty()) {
+                    // Runs accumulate: merge into an existing profile of the same source
+                    manifast::ExecutionProfile previous;
+                    if (previous.load(profileOut) && previous.matches(source)) profile.merge(previous);
+                    profile.source = manifast::ExecutionProfile::fingerprint(source);
+                    vm.setProfile(&profile);
+                }
+
+                vm.interpret(&chunk, source);
+                chunk.free();
+                if (!profileOut.empty() && !profile.save(profileOut)) {
+                    fmt::print(fg(fmt::color::red), "Error: Could not write profile '{}'.\n", profileOut);
+                    return 1;
                 }
             } else {
 #ifdef MANIFAST_HAS_LLVM
                 manifast::CodeGen codegen(source);
-                codegen.compile(statements);
+                codegen.setOptLevel(optLevel);
+                if (objectCache) codegen.enableObjectCache();
+                codegen.setLazyCompilation(lazyJit);
+                codegen.setCompileThreads(compileJobs);
+                if (!profileOut.empty()) {
+                    fmt::print(fg(fmt::color::yellow), "Warning: --profile-out records in the bytecode VM only; add --vm.\n");
+                }
+                manifast::ExecutionProfile profile;
+                if (!profileIn.empty() && loadProfile(profileIn, source, profile)) codegen.setProfile(&profile);
+                codegen.beginMain();
+                while (auto stmt = parseNext()) {
+                    codegen.compileTopLevel(stmt.get());
+                }
+                if (parser.hadError()) {
+                    fmt::print(fg(fmt::color::red), "Syntax errors found. Execution aborted.\n");
+                    return 1;
+                }
+                codegen.finishMain();
                 if (!codegen.run()) return 1;
 #else
                 fmt::print(fg(fmt::color::red), "Error: This binary was compiled without LLVM JIT support. Use --vm.\n");
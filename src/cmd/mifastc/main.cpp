@@ -11,6 +11,8 @@
 #include "manifast/Parser.h"
 #include "manifast/AST.h"
 #include "manifast/CodeGen.h"
+#include "manifast/Linker.h"
+#include "manifast/Profile.h"
 #include "manifast/Utils/Path.h"
 #include "manifast/Utils/Process.h"
 
@@ -24,14 +26,20 @@ struct TestResult {
 
 // --- Helpers ---
 
+static int g_optLevel = 0; // -O0..-O3
+static std::string g_profilePath; // --profile-use
+static std::string g_runtimeBitcode; // manifast_runtime.bc next to mifastc, if built
+
 bool runSilent(const std::string& source) {
     manifast::SyntaxConfig config;
     manifast::Lexer lexer(source, config);
     manifast::Parser parser(lexer);
+    manifast::AstArena astArena;
     
     try {
-        auto statements = parser.parse();
+        auto statements = parser.parse(astArena);
         manifast::CodeGen codegen;
+        codegen.setOptLevel(g_optLevel);
         codegen.compile(statements);
         return codegen.run(); 
     } catch (const std::exception& e) {
@@ -52,11 +60,13 @@ void runVerbose(const std::string& path) {
     manifast::SyntaxConfig config;
     manifast::Lexer lexer(content, config);
     manifast::Parser parser(lexer);
+    manifast::AstArena astArena;
     
     try {
-        auto statements = parser.parse();
+        auto statements = parser.parse(astArena);
         std::cout << "--- Code Generation ---\n";
         manifast::CodeGen codegen;
+        codegen.setOptLevel(g_optLevel);
         codegen.compile(statements);
         codegen.printIR();
         std::cout << "--- Execution ---\n";
@@ -173,10 +183,23 @@ void compileToAOT(const std::string& inputPath, const std::string& outputPath) {
     manifast::SyntaxConfig config;
     manifast::Lexer lexer(content, config);
     manifast::Parser parser(lexer);
+    manifast::AstArena astArena;
     
     try {
-        auto statements = parser.parse();
-        manifast::CodeGen codegen;
+        auto statements = parser.parse(astArena);
+        manifast::CodeGen codegen(content);
+        codegen.setOptLevel(g_optLevel);
+        manifast::ExecutionProfile profile;
+        if (!g_profilePath.empty()) {
+            if (!profile.load(g_profilePath)) {
+                std::cerr << "Warning: Could not read profile " << g_profilePath << "; compiling without it.\n";
+            } else if (!profile.matches(content)) {
+                std::cerr << "Warning: Profile " << g_profilePath << " was recorded for a different source; ignoring it.\n";
+            } else {
+                codegen.setProfile(&profile);
+            }
+        }
+        if (!g_runtimeBitcode.empty()) codegen.setRuntimeBitcode(g_runtimeBitcode);
         codegen.compile(statements);
         
         fs::path out(outputPath);
@@ -210,17 +233,14 @@ void compileToAOT(const std::string& inputPath, const std::string& outputPath) {
             }
             codegen.emitObject(objPath);
             
-            // Invoke GCC for linking without a shell (no command injection via paths)
-            std::vector<std::string> linkArgs = {
-                "g++", objPath, "-o", actualOut, "-L.", "-lmanifast_core", "-lfmt", "-static"
-            };
+            // In-process with LLD when available, else the host g++ (never a shell)
+            manifast::LinkRequest link;
+            link.object = objPath;
+            link.output = actualOut;
+            link.libDirs.push_back(".");
             std::string cmdStr;
-            for (size_t i = 0; i < linkArgs.size(); ++i) {
-                if (i) cmdStr += ' ';
-                cmdStr += linkArgs[i];
-            }
-            std::cout << "Linking executable (External g++): " << cmdStr << "\n";
-            int ret = manifast::utils::runCommand(linkArgs);
+            int ret = manifast::linkExecutable(link, &cmdStr);
+            std::cout << "Linking executable: " << cmdStr << "\n";
             
             if (ret == 0) {
                 std::cout << "Created Executable: " << actualOut << "\n";
@@ -237,6 +257,9 @@ void compileToAOT(const std::string& inputPath, const std::string& outputPath) {
 }
 
 int main(int argc, char *argv[]) {
+    fs::path runtimeBitcode = fs::weakly_canonical(fs::path(argv[0])).parent_path() / "manifast_runtime.bc";
+    if (fs::exists(runtimeBitcode)) g_runtimeBitcode = runtimeBitcode.string();
+
     if (argc > 1) {
         std::string arg = argv[1];
         
@@ -247,6 +270,10 @@ int main(int argc, char *argv[]) {
             std::string a = argv[i];
             if (a == "-o" && i + 1 < argc) {
                 outputPath = argv[++i];
+            } else if (a == "--profile-use" && i + 1 < argc) {
+                g_profilePath = argv[++i];
+            } else if (a.size() == 3 && a[0] == '-' && a[1] == 'O' && a[2] >= '0' && a[2] <= '3') {
+                g_optLevel = a[2] - '0';
             } else if (inputPath.empty() && a[0] != '-') {
                 inputPath = a;
             }
@@ -261,12 +288,14 @@ int main(int argc, char *argv[]) {
             return 0;
         }
 
-        if (arg == "--test" && argc > 2) {
-            runTests(argv[2]);
-        } else if (fs::is_directory(arg)) {
-            runTests(arg);
+        if (arg == "--test" && !inputPath.empty()) {
+            runTests(inputPath);
+        } else if (inputPath.empty()) {
+            runREPL();
+        } else if (fs::is_directory(inputPath)) {
+            runTests(inputPath);
         } else {
-            runVerbose(arg);
+            runVerbose(inputPath);
         }
     } else {
         runREPL();
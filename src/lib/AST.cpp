@@ -0,0 +1,138 @@
+#include "manifast/AST.h"
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+
+namespace manifast {
+
+// --- AstArena ---
+
+namespace {
+thread_local AstArena* t_currentArena = nullptr;
+}
+
+AstArena::AstArena(size_t blockSize) : blockSize(blockSize) {}
+
+AstArena::~AstArena() {
+    for (char* b : blocks) std::free(b);
+}
+
+char* AstArena::newBlock(size_t size) {
+    char* b = static_cast<char*>(std::malloc(size));
+    if (!b) throw std::bad_alloc();
+    blocks.push_back(b);
+    return b;
+}
+
+void* AstArena::allocate(size_t size, size_t align) {
+    uintptr_t p = (reinterpret_cast<uintptr_t>(cursor) + (align - 1)) & ~(uintptr_t)(align - 1);
+    if (!cursor || p + size > reinterpret_cast<uintptr_t>(limit)) {
+        if (size + align > blockSize / 4) {
+            // Oversized request: give it a dedicated block, keep bumping the current one.
+            char* b = newBlock(size + align);
+            p = (reinterpret_cast<uintptr_t>(b) + (align - 1)) & ~(uintptr_t)(align - 1);
+            allocated += size;
+            last = reinterpret_cast<void*>(p);
+            return last;
+        }
+        cursor = newBlock(blockSize);
+        limit = cursor + blockSize;
+        p = (reinterpret_cast<uintptr_t>(cursor) + (align - 1)) & ~(uintptr_t)(align - 1);
+    }
+    cursor = reinterpret_cast<char*>(p + size);
+    allocated += size;
+    last = reinterpret_cast<void*>(p);
+    return last;
+}
+
+void AstArena::reset() {
+    // Keep the current bump block; older and oversized ones are released.
+    char* keep = limit ? limit - blockSize : nullptr;
+    for (char* b : blocks) {
+        if (b != keep) std::free(b);
+    }
+    blocks.clear();
+    if (keep) blocks.push_back(keep);
+    cursor = keep;
+    limit = keep ? keep + blockSize : nullptr;
+    last = nullptr;
+    allocated = 0;
+}
+
+AstArena* AstArena::current() { return t_currentArena; }
+
+AstArena::Scope::Scope(AstArena& arena) : previous(t_currentArena) {
+    t_currentArena = &arena;
+}
+
+AstArena::Scope::~Scope() {
+    t_currentArena = previous;
+}
+
+// --- ASTNode allocation ---
+
+ASTNode::ASTNode(NodeKind kind) : kind(kind) {
+    AstArena* arena = AstArena::current();
+    arenaOwned = arena && arena->isLastAllocation(this);
+}
+
+void* ASTNode::operator new(std::size_t size) {
+    if (AstArena* arena = AstArena::current()) return arena->allocate(size);
+    return ::operator new(size);
+}
+
+void ASTNode::operator delete(void* p) {
+    // Only reached when a constructor throws; arena memory is reclaimed with the arena.
+    AstArena* arena = AstArena::current();
+    if (arena && arena->isLastAllocation(p)) return;
+    ::operator delete(p);
+}
+
+void ASTNode::operator delete(ASTNode* node, std::destroying_delete_t) {
+    bool fromArena = node->arenaOwned;
+    node->~ASTNode();
+    if (!fromArena) ::operator delete(static_cast<void*>(node));
+}
+
+// --- Symbol interning ---
+
+namespace {
+
+struct SymbolTable {
+    std::mutex mutex;
+    std::deque<detail::SymbolEntry> entries; // stable addresses
+    std::unordered_map<std::string_view, const detail::SymbolEntry*> index;
+
+    SymbolTable() {
+        entries.push_back({0, std::string()});
+        index.emplace(std::string_view(entries.back().text), &entries.back());
+    }
+};
+
+SymbolTable& symbolTable() {
+    static SymbolTable* table = new SymbolTable(); // never destroyed: symbols may outlive statics
+    return *table;
+}
+
+} // namespace
+
+const detail::SymbolEntry* Symbol::emptyEntry() {
+    static const detail::SymbolEntry* empty = &symbolTable().entries.front();
+    return empty;
+}
+
+const detail::SymbolEntry* Symbol::intern(std::string_view text) {
+    if (text.empty()) return emptyEntry();
+    SymbolTable& table = symbolTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    auto it = table.index.find(text);
+    if (it != table.index.end()) return it->second;
+    table.entries.push_back({(uint32_t)table.entries.size(), std::string(text)});
+    const detail::SymbolEntry* e = &table.entries.back();
+    table.index.emplace(std::string_view(e->text), e);
+    return e;
+}
+
+} // namespace manifast
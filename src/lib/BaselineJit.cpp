@@ -0,0 +1,426 @@
+#include "manifast/VM/BaselineJit.h"
+#include "manifast/VM/Chunk.h"
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(_M_X64)) && !defined(__EMSCRIPTEN__)
+#define MANIFAST_BASELINE_JIT
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#endif
+
+namespace manifast {
+namespace vm {
+
+#ifdef MANIFAST_BASELINE_JIT
+
+namespace {
+
+static_assert(sizeof(Any) == 24 && offsetof(Any, number) == 8 && offsetof(Any, ptr) == 16,
+              "baseline JIT templates assume the {i32, double, ptr} Any layout");
+
+// Minimal x86-64 encoder covering the instruction forms the templates use.
+// Memory operands are always [r10 + disp32] (frame registers),
+// [r11 + disp32] (constants) or [r9 + disp32] (a global slot loaded with
+// movR9); rcx, xmm0 and xmm1 are scratch.
+class Assembler {
+public:
+    using Label = int;
+    enum Base { GLOBAL = 1, REGS = 2, CONSTS = 3 }; // low bits of r9 / r10 / r11
+    enum Cond : uint8_t { B = 0x2, AE = 0x3, E = 0x4, NE = 0x5, BE = 0x6, A = 0x7, P = 0xA };
+
+    std::vector<uint8_t> code;
+
+    Label newLabel() {
+        labels.push_back(-1);
+        return (Label)labels.size() - 1;
+    }
+    void bind(Label l) { labels[l] = (int)code.size(); }
+    void jmp(Label l) { byte(0xE9); fixup(l); }
+    void jcc(Cond c, Label l) { byte(0x0F); byte(0x80 | c); fixup(l); }
+
+    // Patch every rel32 jump; false if a label was never bound.
+    bool finalize() {
+        for (auto& f : fixups) {
+            int target = labels[f.second];
+            if (target < 0) return false;
+            int32_t rel = target - (f.first + 4);
+            std::memcpy(&code[f.first], &rel, 4);
+        }
+        return true;
+    }
+
+    // r10 = regs, r11 = constants, eax = startPc
+    void prologue() {
+#ifdef _WIN32
+        bytes({0x49, 0x89, 0xCA}); // mov r10, rcx
+        bytes({0x49, 0x89, 0xD3}); // mov r11, rdx
+        bytes({0x44, 0x89, 0xC0}); // mov eax, r8d
+#else
+        bytes({0x49, 0x89, 0xFA}); // mov r10, rdi
+        bytes({0x49, 0x89, 0xF3}); // mov r11, rsi
+        bytes({0x89, 0xD0});       // mov eax, edx
+#endif
+    }
+    void cmpEax(int32_t v) { byte(0x3D); imm32(v); }
+    void movEax(int32_t v) { byte(0xB8); imm32(v); }
+    void ret() { byte(0xC3); }
+
+    void cmpMem32(Base b, int32_t disp, int32_t v) { bytes({0x41, 0x81}); mem(7, b, disp); imm32(v); }
+    void movMem32(Base b, int32_t disp, int32_t v) { bytes({0x41, 0xC7}); mem(0, b, disp); imm32(v); }
+    void movMem64(Base b, int32_t disp, int32_t v) { bytes({0x49, 0xC7}); mem(0, b, disp); imm32(v); }
+    void movRcxMem(Base b, int32_t disp) { bytes({0x49, 0x8B}); mem(1, b, disp); }
+    void movMemRcx(Base b, int32_t disp) { bytes({0x49, 0x89}); mem(1, b, disp); }
+    void movRcx(uint64_t v) { bytes({0x48, 0xB9}); imm64(v); }
+    void movR9(uint64_t v) { bytes({0x49, 0xB9}); imm64(v); }
+    void btcRcx63() { bytes({0x48, 0x0F, 0xBA, 0xF9, 0x3F}); }
+    void movsdLoad(int xmm, Base b, int32_t disp) { bytes({0xF2, 0x41, 0x0F, 0x10}); mem(xmm, b, disp); }
+    void movsdStore(Base b, int32_t disp, int xmm) { bytes({0xF2, 0x41, 0x0F, 0x11}); mem(xmm, b, disp); }
+    // <prefix> 0F <op> xmm(dst), xmm(src): addsd/subsd/mulsd/divsd (F2), ucomisd/xorpd (66)
+    void sse(uint8_t prefix, uint8_t op, int dst, int src) { bytes({prefix, 0x0F, op}); byte(0xC0 | dst << 3 | src); }
+
+private:
+    std::vector<int> labels;
+    std::vector<std::pair<int, Label>> fixups;
+
+    void byte(uint8_t b) { code.push_back(b); }
+    void bytes(std::initializer_list<uint8_t> bs) { code.insert(code.end(), bs); }
+    void imm32(int32_t v) { for (int s = 0; s < 32; s += 8) byte((uint8_t)((uint32_t)v >> s)); }
+    void imm64(uint64_t v) { for (int s = 0; s < 64; s += 8) byte((uint8_t)(v >> s)); }
+    void mem(int reg, Base b, int32_t disp) { byte(0x80 | (reg & 7) << 3 | b); imm32(disp); }
+    void fixup(Label l) { fixups.push_back({(int)code.size(), l}); imm32(0); }
+};
+
+constexpr uint8_t ADDSD = 0x58, MULSD = 0x59, SUBSD = 0x5C, DIVSD = 0x5E, UCOMISD = 0x2E, XORPD = 0x57;
+
+constexpr int32_t typeAt(int slot) { return slot * (int32_t)sizeof(Any); }
+constexpr int32_t numberAt(int slot) { return typeAt(slot) + (int32_t)offsetof(Any, number); }
+constexpr int32_t ptrAt(int slot) { return typeAt(slot) + (int32_t)offsetof(Any, ptr); }
+
+uint64_t bitsOf(double d) {
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+    return bits;
+}
+
+// Emits one template per instruction, in code order, so the instruction at
+// `next` is always the fall-through of the one before it.
+class TemplateCompiler {
+public:
+    using Label = Assembler::Label;
+
+    TemplateCompiler(const Chunk& chunk, const TierContext& context)
+        : chunk(chunk), context(context), n((int)chunk.code.size()), blocks(n, -1) {}
+
+    bool compile(std::vector<uint8_t>& out) {
+        for (int pc = 0; pc < n; pc += instructionLength(chunk, pc)) blocks[pc] = as.newLabel();
+
+        as.prologue();
+        for (int pc : tierEntryPoints(chunk)) {
+            as.cmpEax(pc);
+            as.jcc(Assembler::E, at(pc));
+        }
+        as.ret(); // no entry point here: eax is still startPc
+
+        for (int pc = 0; pc < n; pc += instructionLength(chunk, pc)) {
+            int next = pc + instructionLength(chunk, pc);
+            as.bind(blocks[pc]);
+            emit(pc, next);
+            if (next >= n) as.jmp(at(next));
+        }
+
+        for (auto& e : exits) {
+            as.bind(e.second);
+            as.movEax(e.first);
+            as.ret();
+        }
+        if (!as.finalize()) return false;
+        out = std::move(as.code);
+        return true;
+    }
+
+private:
+    const Chunk& chunk;
+    const TierContext& context;
+    int n;
+    std::vector<Label> blocks;
+    std::map<int, Label> exits;
+    Assembler as;
+
+    Label exitTo(int pc) {
+        auto it = exits.find(pc);
+        if (it != exits.end()) return it->second;
+        return exits[pc] = as.newLabel();
+    }
+
+    // Label of the instruction at `pc`, or a side exit when there is none.
+    Label at(int pc) { return pc >= 0 && pc < n && blocks[pc] >= 0 ? blocks[pc] : exitTo(pc); }
+
+    void guardNumber(int reg, int pc) {
+        as.cmpMem32(Assembler::REGS, typeAt(reg), ANY_NUMBER);
+        as.jcc(Assembler::NE, exitTo(pc));
+    }
+
+    // xmm <- RK operand; false for constants that are not numbers.
+    bool loadNumber(int xmm, int rk, int pc) {
+        if (rk >= 256) {
+            int k = rk - 256;
+            if (k >= (int)chunk.constants.size() || chunk.constants[k].type != ANY_NUMBER) return false;
+            as.movsdLoad(xmm, Assembler::CONSTS, numberAt(k));
+            return true;
+        }
+        guardNumber(rk, pc);
+        as.movsdLoad(xmm, Assembler::REGS, numberAt(rk));
+        return true;
+    }
+
+    void storeNumber(int reg, int xmm) {
+        as.movMem32(Assembler::REGS, typeAt(reg), ANY_NUMBER);
+        as.movsdStore(Assembler::REGS, numberAt(reg), xmm);
+        as.movMem64(Assembler::REGS, ptrAt(reg), 0);
+    }
+
+    void storeImmediate(int reg, int type, double value) {
+        as.movMem32(Assembler::REGS, typeAt(reg), type);
+        if (bitsOf(value) == 0) {
+            as.movMem64(Assembler::REGS, numberAt(reg), 0);
+        } else {
+            as.movRcx(bitsOf(value));
+            as.movMemRcx(Assembler::REGS, numberAt(reg));
+        }
+        as.movMem64(Assembler::REGS, ptrAt(reg), 0);
+    }
+
+    void copy(Assembler::Base dstBase, int dst, Assembler::Base srcBase, int src) {
+        for (int32_t off = 0; off < (int32_t)sizeof(Any); off += 8) {
+            as.movRcxMem(srcBase, typeAt(src) + off);
+            as.movMemRcx(dstBase, typeAt(dst) + off);
+        }
+    }
+
+    // Slot of the global named by constant `k`, if the VM already has one.
+    Any* globalSlot(int k) {
+        if (k >= (int)chunk.constants.size() || !context.globalSlot) return nullptr;
+        const Any& key = chunk.constants[k];
+        if (key.type != ANY_STRING || !key.ptr) return nullptr;
+        return context.globalSlot((const char*)key.ptr);
+    }
+
+    // Interpreter truthiness: nil is false, bools and numbers are false when
+    // zero, anything else is true.
+    void branchOnTruth(int reg, Label ifTrue, Label ifFalse) {
+        Label numeric = as.newLabel();
+        as.cmpMem32(Assembler::REGS, typeAt(reg), ANY_NIL);
+        as.jcc(Assembler::E, ifFalse);
+        as.cmpMem32(Assembler::REGS, typeAt(reg), ANY_NUMBER);
+        as.jcc(Assembler::E, numeric);
+        as.cmpMem32(Assembler::REGS, typeAt(reg), ANY_BOOLEAN);
+        as.jcc(Assembler::E, numeric);
+        as.jmp(ifTrue);
+        as.bind(numeric);
+        as.movsdLoad(0, Assembler::REGS, numberAt(reg));
+        as.sse(0x66, XORPD, 1, 1);
+        as.sse(0x66, UCOMISD, 0, 1);
+        as.jcc(Assembler::P, ifTrue); // NaN != 0
+        as.jcc(Assembler::NE, ifTrue);
+        as.jmp(ifFalse);
+    }
+
+    void emit(int pc, int next) {
+        Instruction i = chunk.code[pc];
+        int a = getA(i);
+        switch (getOpCode(i)) {
+            case OpCode::MOVE:
+                copy(Assembler::REGS, a, Assembler::REGS, getB(i));
+                return;
+            case OpCode::LOADK: {
+                int k = getBx(i) == (uint32_t)MAXARG_Bx ? (int)chunk.code[pc + 1] : (int)getBx(i);
+                if (k >= (int)chunk.constants.size()) break;
+                copy(Assembler::REGS, a, Assembler::CONSTS, k);
+                return;
+            }
+            case OpCode::GETGLOBAL:
+            case OpCode::SETGLOBAL: {
+                int k = getBx(i) == (uint32_t)MAXARG_Bx ? (int)chunk.code[pc + 1] : (int)getBx(i);
+                Any* slot = globalSlot(k);
+                if (!slot) break; // undefined so far: the interpreter reports it
+                as.movR9((uint64_t)(uintptr_t)slot);
+                if (getOpCode(i) == OpCode::GETGLOBAL) copy(Assembler::REGS, a, Assembler::GLOBAL, 0);
+                else copy(Assembler::GLOBAL, 0, Assembler::REGS, a);
+                return;
+            }
+            case OpCode::LOADBOOL:
+                storeImmediate(a, ANY_BOOLEAN, (double)getB(i));
+                if (getC(i)) as.jmp(at(next + 1));
+                return;
+            case OpCode::LOADNIL:
+                for (int r = a; r <= a + getB(i); r++) storeImmediate(r, ANY_NIL, 0.0);
+                return;
+            case OpCode::ADD:
+            case OpCode::SUB:
+            case OpCode::MUL:
+            case OpCode::DIV: {
+                if (!loadNumber(0, getB(i), pc) || !loadNumber(1, getC(i), pc)) break;
+                uint8_t op = getOpCode(i) == OpCode::ADD ? ADDSD
+                           : getOpCode(i) == OpCode::SUB ? SUBSD
+                           : getOpCode(i) == OpCode::MUL ? MULSD : DIVSD;
+                as.sse(0xF2, op, 0, 1);
+                storeNumber(a, 0);
+                return;
+            }
+            case OpCode::UNM:
+                guardNumber(getB(i), pc);
+                as.movRcxMem(Assembler::REGS, numberAt(getB(i)));
+                as.btcRcx63(); // flip the sign bit
+                as.movMemRcx(Assembler::REGS, numberAt(a));
+                as.movMem32(Assembler::REGS, typeAt(a), ANY_NUMBER);
+                as.movMem64(Assembler::REGS, ptrAt(a), 0);
+                return;
+            case OpCode::NOT: {
+                Label truthy = as.newLabel(), falsy = as.newLabel(), done = as.newLabel();
+                branchOnTruth(getB(i), truthy, falsy);
+                as.bind(truthy);
+                storeImmediate(a, ANY_BOOLEAN, 0.0);
+                as.jmp(done);
+                as.bind(falsy);
+                storeImmediate(a, ANY_BOOLEAN, 1.0);
+                as.bind(done);
+                return;
+            }
+            case OpCode::LT:
+            case OpCode::LE: {
+                // if ((B < C) != A) skip; compared as C > B so unordered is false
+                if (!loadNumber(0, getB(i), pc) || !loadNumber(1, getC(i), pc)) break;
+                as.sse(0x66, UCOMISD, 1, 0);
+                bool lt = getOpCode(i) == OpCode::LT;
+                Assembler::Cond holds = lt ? Assembler::A : Assembler::AE;
+                Assembler::Cond fails = lt ? Assembler::BE : Assembler::B;
+                as.jcc(a ? fails : holds, at(next + 1));
+                return;
+            }
+            case OpCode::EQ: {
+                if (!loadNumber(0, getB(i), pc) || !loadNumber(1, getC(i), pc)) break;
+                as.sse(0x66, UCOMISD, 0, 1);
+                if (a) { // skip unless equal
+                    as.jcc(Assembler::P, at(next + 1));
+                    as.jcc(Assembler::NE, at(next + 1));
+                } else { // skip if equal
+                    Label unordered = as.newLabel();
+                    as.jcc(Assembler::P, unordered);
+                    as.jcc(Assembler::E, at(next + 1));
+                    as.bind(unordered);
+                }
+                return;
+            }
+            case OpCode::JMP:
+                as.jmp(at(pc + 1 + getsBx(i)));
+                return;
+            case OpCode::TEST: {
+                // if (truthy(A) != C) skip
+                Label fallthrough = as.newLabel();
+                if (getC(i)) branchOnTruth(a, fallthrough, at(next + 1));
+                else branchOnTruth(a, at(next + 1), fallthrough);
+                as.bind(fallthrough);
+                return;
+            }
+            case OpCode::TESTSET: {
+                // if (truthy(B) == C) A := B else skip
+                Label set = as.newLabel();
+                if (getC(i)) branchOnTruth(getB(i), set, at(next + 1));
+                else branchOnTruth(getB(i), at(next + 1), set);
+                as.bind(set);
+                copy(Assembler::REGS, a, Assembler::REGS, getB(i));
+                return;
+            }
+            default:
+                break;
+        }
+        // No template (or a constant operand of the wrong type): let the interpreter run it.
+        as.jmp(exitTo(pc));
+    }
+};
+
+class BaselineTierBackend : public TierBackend {
+public:
+    ~BaselineTierBackend() override {
+        for (auto& r : regions) release(r.first, r.second);
+    }
+
+    const char* name() const override { return "baseline-x64"; }
+
+    NativeEntry compile(const Chunk& chunk, const TierContext& context) override {
+        std::vector<uint8_t> code;
+        if (chunk.code.empty() || !TemplateCompiler(chunk, context).compile(code)) return nullptr;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t size = (code.size() + pageSize() - 1) & ~(pageSize() - 1);
+        void* mem = allocate(size);
+        if (!mem) return nullptr;
+        std::memcpy(mem, code.data(), code.size());
+        if (!makeExecutable(mem, size)) {
+            release(mem, size);
+            return nullptr;
+        }
+        regions.push_back({mem, size});
+        return (NativeEntry)mem;
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<std::pair<void*, size_t>> regions;
+
+    // Pages are mapped writable, filled, then flipped to read+execute.
+#ifdef _WIN32
+    static size_t pageSize() {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwPageSize;
+    }
+    static void* allocate(size_t size) {
+        return VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    }
+    static bool makeExecutable(void* mem, size_t size) {
+        DWORD old;
+        if (!VirtualProtect(mem, size, PAGE_EXECUTE_READ, &old)) return false;
+        FlushInstructionCache(GetCurrentProcess(), mem, size);
+        return true;
+    }
+    static void release(void* mem, size_t) { VirtualFree(mem, 0, MEM_RELEASE); }
+#else
+    static size_t pageSize() { return (size_t)sysconf(_SC_PAGESIZE); }
+    static void* allocate(size_t size) {
+        void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return mem == MAP_FAILED ? nullptr : mem;
+    }
+    static bool makeExecutable(void* mem, size_t size) { return mprotect(mem, size, PROT_READ | PROT_EXEC) == 0; }
+    static void release(void* mem, size_t size) { munmap(mem, size); }
+#endif
+};
+
+} // namespace
+
+std::shared_ptr<TierBackend> createBaselineTierBackend() {
+    return std::make_shared<BaselineTierBackend>();
+}
+
+#else
+
+std::shared_ptr<TierBackend> createBaselineTierBackend() {
+    return nullptr;
+}
+
+#endif // MANIFAST_BASELINE_JIT
+
+} // namespace vm
+} // namespace manifast
@@ -1,18 +1,35 @@
 #include "manifast/CodeGen.h"
 #include "manifast/Runtime.h"
 #include <llvm/IR/Verifier.h>
+#include <llvm/IR/MDBuilder.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Linker/Linker.h>
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
 #include <iostream>
+#include <optional>
 
 #include <llvm/Support/TargetSelect.h>
 #include <llvm/ExecutionEngine/Orc/LLJIT.h>
 #include <llvm/ExecutionEngine/Orc/Core.h>
 #include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/CompileUtils.h>
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/SHA256.h>
+#include <llvm/Support/xxhash.h>
+#include <llvm/ADT/StringExtras.h>
 #include <llvm/MC/TargetRegistry.h>
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Target/TargetOptions.h>
 #include <llvm/Support/FileSystem.h>
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/TargetParser/Host.h>
+#include <llvm/TargetParser/SubtargetFeature.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Passes/OptimizationLevel.h>
 
 // Host C++ EH personality (resolved from libgcc linked into the process).
 #if defined(_WIN32) && (defined(__SEH__) || defined(__MINGW32__))
@@ -79,6 +96,13 @@ CodeGen::CodeGen(std::string_view source) : source(source) {
     // manifast_type_check(Any*, int) -> void
     llvm::FunctionType* typeCheckFT = llvm::FunctionType::get(builder->getVoidTy(), {anyPtrTy, builder->getInt32Ty()}, false);
     llvm::Function::Create(typeCheckFT, llvm::Function::ExternalLinkage, "manifast_type_check", module.get());
+
+    // manifast_type_check_array(Any*, uint32_t kind) -> void
+    llvm::Function::Create(typeCheckFT, llvm::Function::ExternalLinkage, "manifast_type_check_array", module.get());
+
+    // manifast_object_set_raw(ManifastObject*, const char*, Any*) -> void
+    llvm::FunctionType* setRawFT = llvm::FunctionType::get(builder->getVoidTy(), {builder->getPtrTy(), builder->getPtrTy(), anyPtrTy}, false);
+    llvm::Function::Create(setRawFT, llvm::Function::ExternalLinkage, "manifast_object_set_raw", module.get());
 }
 
 void CodeGen::pushScope() {
@@ -93,15 +117,26 @@ void CodeGen::popScope() {
     }
 }
 
-CodeGen::VarInfo CodeGen::lookupVariable(const std::string& name) {
+CodeGen::VarInfo CodeGen::lookupVariable(Symbol name) {
     for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
-        if (it->find(name) != it->end()) {
-            return (*it)[name];
+        auto found = it->find(name);
+        if (found != it->end()) {
+            return found->second;
         }
     }
     return {nullptr, Type(TypeKind::Any)};
 }
 
+uint32_t CodeGen::packedArrayKind(const Type& type) {
+    Type resolved = resolveType(type);
+    if (resolved.kind != TypeKind::Array || !resolved.baseType()) return ARRAY_ANY;
+    switch (resolveType(*resolved.baseType()).kind) {
+        case TypeKind::Float32: case TypeKind::Float64: return ARRAY_F64;
+        case TypeKind::Int8: case TypeKind::Int16: case TypeKind::Int32: return ARRAY_I32;
+        default: return ARRAY_ANY;
+    }
+}
+
 int CodeGen::mapTypeToRuntime(const Type& type) {
     Type resolved = resolveType(type);
     switch (resolved.kind) {
@@ -131,6 +166,9 @@ void CodeGen::initializeTypes() {
         llvm::Type::getDoubleTy(*context),
         llvm::PointerType::getUnqual(*context)
     });
+    // Runtime payloads built on the stack by generateBorrowed (Runtime.h layouts)
+    arrayType = llvm::StructType::create(*context, {builder->getInt32Ty(), builder->getInt32Ty(), builder->getPtrTy(), builder->getInt32Ty(), builder->getInt32Ty(), builder->getPtrTy()}, "ManifastArray");
+    objectType = llvm::StructType::create(*context, {builder->getInt32Ty(), builder->getInt32Ty(), builder->getPtrTy()}, "ManifastObject");
 }
 
 llvm::CallBase* CodeGen::createCallOrInvoke(llvm::Function* callee, llvm::ArrayRef<llvm::Value*> args, const llvm::Twine& name) {
@@ -146,32 +184,31 @@ llvm::CallBase* CodeGen::createCallOrInvoke(llvm::Function* callee, llvm::ArrayR
     return builder->CreateCall(callee->getFunctionType(), callee, args, name);
 }
 
+// Literals are read-only globals rather than runtime allocations. Generated
+// code never writes through an expression's Any* (variables, arrays and
+// objects all copy the value in), so a literal can be shared by every use.
+llvm::Value* CodeGen::createLiteral(int type, double number, llvm::Constant* ptr) {
+    llvm::Constant* init = llvm::ConstantStruct::get(anyType, {
+        builder->getInt32(type),
+        llvm::ConstantFP::get(builder->getDoubleTy(), number),
+        ptr ? ptr : llvm::ConstantPointerNull::get(builder->getPtrTy())
+    });
+    auto* literal = new llvm::GlobalVariable(*module, anyType, /*isConstant=*/true,
+                                             llvm::GlobalValue::PrivateLinkage, init, "lit");
+    literal->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+    return literal;
+}
+
 llvm::Value* CodeGen::createNumber(double value) {
-    llvm::Function* func = module->getFunction("manifast_create_number");
-    if (!func) {
-        llvm::FunctionType* ft = llvm::FunctionType::get(llvm::PointerType::getUnqual(*context), {llvm::Type::getDoubleTy(*context)}, false);
-        func = llvm::Function::Create(ft, llvm::Function::ExternalLinkage, "manifast_create_number", module.get());
-    }
-    return createCallOrInvoke(func, {llvm::ConstantFP::get(*context, llvm::APFloat(value))}, "num");
+    return createLiteral(ANY_NUMBER, value);
 }
 
 llvm::Value* CodeGen::boxDouble(llvm::Value* v) {
-    llvm::Function* func = module->getFunction("manifast_create_number");
-    if (!func) {
-        llvm::FunctionType* ft = llvm::FunctionType::get(llvm::PointerType::getUnqual(*context), {llvm::Type::getDoubleTy(*context)}, false);
-        func = llvm::Function::Create(ft, llvm::Function::ExternalLinkage, "manifast_create_number", module.get());
-    }
-    return createCallOrInvoke(func, {v}, "num_box");
+    return boxNumberTemp(v);
 }
 
 llvm::Value* CodeGen::createString(const std::string& value) {
-    llvm::Function* func = module->getFunction("manifast_create_string");
-    if (!func) {
-        llvm::FunctionType* ft = llvm::FunctionType::get(llvm::PointerType::getUnqual(*context), {builder->getPtrTy()}, false);
-        func = llvm::Function::Create(ft, llvm::Function::ExternalLinkage, "manifast_create_string", module.get());
-    }
-    llvm::Value* globalStr = builder->CreateGlobalString(value);
-    return createCallOrInvoke(func, {globalStr}, "str");
+    return createLiteral(ANY_STRING, 0.0, builder->CreateGlobalString(value));
 }
 
 llvm::Value* CodeGen::unboxString(llvm::Value* anyPtr) {
@@ -186,6 +223,168 @@ llvm::Value* CodeGen::unboxNumber(llvm::Value* anyPtr) {
     return builder->CreateLoad(llvm::Type::getDoubleTy(*context), numPtr, "unbox");
 }
 
+llvm::Type* CodeGen::nativeTypeFor(const Type& type) {
+    // i32/i64 slots hold doubles too: the VM keeps typed integers as plain
+    // numbers, so truncating here would make n / 2 differ between tiers.
+    switch (resolveType(type).kind) {
+        case TypeKind::Int32:
+        case TypeKind::Int64:
+        case TypeKind::Float64: return builder->getDoubleTy();
+        default: return nullptr;
+    }
+}
+
+llvm::Value* CodeGen::boxNumberTemp(llvm::Value* d) {
+    return boxTemp(ANY_NUMBER, d);
+}
+
+llvm::AllocaInst* CodeGen::createEntryAlloca(llvm::Type* type, const llvm::Twine& name) {
+    // Hoisted to the entry block so temporaries inside a loop do not grow the stack.
+    llvm::Function* func = builder->GetInsertBlock()->getParent();
+    llvm::IRBuilder<> tmpBuilder(&func->getEntryBlock(), func->getEntryBlock().begin());
+    return tmpBuilder.CreateAlloca(type, nullptr, name);
+}
+
+llvm::Value* CodeGen::escapeToHeap(llvm::Value* any) {
+    llvm::Function* func = module->getFunction("manifast_create_nil");
+    if (!func) {
+        llvm::FunctionType* ft = llvm::FunctionType::get(builder->getPtrTy(), {}, false);
+        func = llvm::Function::Create(ft, llvm::Function::ExternalLinkage, "manifast_create_nil", module.get());
+    }
+    llvm::Value* heap = createCallOrInvoke(func, {}, "escaped");
+    builder->CreateStore(builder->CreateLoad(anyType, any), heap);
+    return heap;
+}
+
+llvm::Value* CodeGen::generateBorrowed(const Expr* expr) {
+    // Array and object literals read once by the caller (printed, measured,
+    // indexed) cannot escape: build them in this frame instead of the heap.
+    if (auto* array = nodeAs<ArrayExpr>(expr)) {
+        size_t n = array->elements.size();
+        llvm::AllocaInst* storage = createEntryAlloca(llvm::ArrayType::get(anyType, n), "arr_elems");
+        for (size_t i = 0; i < n; i++) {
+            llvm::Value* val = generateExpr(array->elements[i].get());
+            if (!val) val = createLiteral(ANY_NIL, 0.0);
+            builder->CreateStore(builder->CreateLoad(anyType, val), builder->CreateConstGEP2_32(storage->getAllocatedType(), storage, 0, (unsigned)i));
+        }
+        llvm::AllocaInst* header = createEntryAlloca(arrayType, "arr_tmp");
+        builder->CreateStore(builder->getInt32((uint32_t)n), builder->CreateStructGEP(arrayType, header, 0));
+        builder->CreateStore(builder->getInt32((uint32_t)n), builder->CreateStructGEP(arrayType, header, 1));
+        builder->CreateStore(storage, builder->CreateStructGEP(arrayType, header, 2));
+        builder->CreateStore(builder->getInt32(ARRAY_ANY), builder->CreateStructGEP(arrayType, header, 3));
+        builder->CreateStore(builder->getInt32(0), builder->CreateStructGEP(arrayType, header, 4)); // not shared
+        builder->CreateStore(llvm::ConstantPointerNull::get(builder->getPtrTy()), builder->CreateStructGEP(arrayType, header, 5)); // no sparse part
+        return boxPointerTemp(ANY_ARRAY, header);
+    }
+    if (auto* object = nodeAs<ObjectExpr>(expr)) {
+        // Capacity covers every entry, so manifast_object_set_raw never reallocates
+        size_t n = object->entries.size();
+        llvm::StructType* entryType = llvm::StructType::get(*context, {builder->getPtrTy(), anyType});
+        llvm::AllocaInst* entries = createEntryAlloca(llvm::ArrayType::get(entryType, n), "obj_entries");
+        llvm::AllocaInst* header = createEntryAlloca(objectType, "obj_tmp");
+        builder->CreateStore(builder->getInt32(0), builder->CreateStructGEP(objectType, header, 0));
+        builder->CreateStore(builder->getInt32((uint32_t)n), builder->CreateStructGEP(objectType, header, 1));
+        builder->CreateStore(entries, builder->CreateStructGEP(objectType, header, 2));
+        llvm::Function* setRaw = module->getFunction("manifast_object_set_raw");
+        for (const auto& kv : object->entries) {
+            llvm::Value* val = generateExpr(kv.second.get());
+            if (!val) continue;
+            llvm::Value* valPtr = createEntryAlloca(anyType, "field_tmp");
+            builder->CreateStore(builder->CreateLoad(anyType, val), valPtr);
+            createCallOrInvoke(setRaw, {header, builder->CreateGlobalString(kv.first.str()), valPtr});
+        }
+        return boxPointerTemp(ANY_OBJECT, header);
+    }
+    return generateExpr(expr);
+}
+
+llvm::Value* CodeGen::boxPointerTemp(int type, llvm::Value* ptr) {
+    llvm::AllocaInst* temp = createEntryAlloca(anyType, "ref_tmp");
+    builder->CreateStore(builder->getInt32(type), builder->CreateStructGEP(anyType, temp, 0));
+    builder->CreateStore(llvm::ConstantFP::get(builder->getDoubleTy(), 0.0), builder->CreateStructGEP(anyType, temp, 1));
+    builder->CreateStore(ptr, builder->CreateStructGEP(anyType, temp, 2));
+    return temp;
+}
+
+llvm::Value* CodeGen::boxTemp(int type, llvm::Value* d) {
+    // Same shape as visitVariableExpr's temp. Stack temporaries never escape:
+    // consumers copy the value out before the temp is reused, and only
+    // manifast_main's result outlives the frame (see visitReturnStmt).
+    llvm::AllocaInst* temp = createEntryAlloca(anyType, "num_tmp");
+    builder->CreateStore(builder->getInt32(type), builder->CreateStructGEP(anyType, temp, 0));
+    builder->CreateStore(d, builder->CreateStructGEP(anyType, temp, 1));
+    builder->CreateStore(llvm::ConstantPointerNull::get(builder->getPtrTy()), builder->CreateStructGEP(anyType, temp, 2));
+    return temp;
+}
+
+bool CodeGen::isStaticallyNumeric(const Expr* expr) {
+    if (!expr) return false;
+    switch (expr->kind) {
+        case NodeKind::Number:
+        case NodeKind::Char:
+            return true;
+        case NodeKind::Variable:
+            return lookupVariable(static_cast<const VariableExpr*>(expr)->name).native != nullptr;
+        case NodeKind::Binary: {
+            TokenType op = static_cast<const BinaryExpr*>(expr)->op;
+            return op != TokenType::K_And && op != TokenType::K_Or;
+        }
+        case NodeKind::Unary:
+            return static_cast<const UnaryExpr*>(expr)->op == TokenType::Minus;
+        default:
+            return false;
+    }
+}
+
+llvm::Value* CodeGen::generateNumber(const Expr* expr) {
+    if (!expr) return nullptr;
+    switch (expr->kind) {
+    case NodeKind::Number:
+        return llvm::ConstantFP::get(*context, llvm::APFloat(static_cast<const NumberExpr*>(expr)->value));
+    case NodeKind::Char:
+        return llvm::ConstantFP::get(*context, llvm::APFloat((double)static_cast<const CharExpr*>(expr)->value));
+    case NodeKind::Variable: {
+        auto* var = static_cast<const VariableExpr*>(expr);
+        VarInfo info = lookupVariable(var->name);
+        if (!info.value) {
+            std::cerr << "Unknown variable name: " << var->name.str() << "\n";
+            return nullptr;
+        }
+        if (info.native) return builder->CreateLoad(info.native, info.value, var->name.c_str());
+        return unboxNumber(info.value);
+    }
+    case NodeKind::Binary: {
+        auto* bin = static_cast<const BinaryExpr*>(expr);
+        if (bin->op == TokenType::K_And || bin->op == TokenType::K_Or) break;
+        llvm::Value* L = generateNumber(bin->left.get());
+        llvm::Value* R = generateNumber(bin->right.get());
+        if (!L || !R) return nullptr;
+        return emitNumericOp(bin->op, L, R);
+    }
+    case NodeKind::Unary: {
+        auto* un = static_cast<const UnaryExpr*>(expr);
+        if (un->op != TokenType::Minus) break;
+        llvm::Value* v = generateNumber(un->right.get());
+        return v ? builder->CreateFNeg(v, "negtmp") : nullptr;
+    }
+    default:
+        break;
+    }
+    llvm::Value* boxed = generateExpr(expr);
+    return boxed ? unboxNumber(boxed) : nullptr;
+}
+
+llvm::Value* CodeGen::generateNumberChecked(const Expr* expr, int runtimeType) {
+    if (isStaticallyNumeric(expr)) return generateNumber(expr);
+    llvm::Value* boxed = generateExpr(expr);
+    if (!boxed) return nullptr;
+    if (runtimeType != -1) {
+        llvm::Function* checkFunc = module->getFunction("manifast_type_check");
+        createCallOrInvoke(checkFunc, {boxed, builder->getInt32(runtimeType)});
+    }
+    return unboxNumber(boxed);
+}
+
 llvm::Value* CodeGen::createArray(const std::vector<llvm::Value*>& elements) {
     llvm::Function* func = module->getFunction("manifast_create_array");
     if (!func) {
@@ -206,7 +405,7 @@ llvm::Value* CodeGen::createArray(const std::vector<llvm::Value*>& elements) {
     for (uint32_t i = 0; i < elements.size(); ++i) {
         // elements[i] is Any (loaded from temp)
         // We need to pass Any* to manifast_array_set
-        llvm::Value* elemPtr = builder->CreateAlloca(anyType);
+        llvm::Value* elemPtr = createEntryAlloca(anyType, "elem_tmp");
         builder->CreateStore(elements[i], elemPtr);
         createCallOrInvoke(setFunc, {arrVal, llvm::ConstantFP::get(*context, llvm::APFloat((double)(i + 1))), elemPtr});
     }
@@ -233,7 +432,7 @@ llvm::Value* CodeGen::createObject(const std::vector<std::pair<std::string, llvm
     
     for (const auto& pair : pairs) {
         // pair.second is Any (loaded)
-        llvm::Value* valPtr = builder->CreateAlloca(anyType);
+        llvm::Value* valPtr = createEntryAlloca(anyType, "field_tmp");
         builder->CreateStore(pair.second, valPtr);
         
         llvm::Value* keyStr = builder->CreateGlobalString(pair.first);
@@ -253,6 +452,14 @@ void CodeGen::printAny(llvm::Value* anyVal) {
 }
 
 void CodeGen::compile(const std::vector<std::unique_ptr<Stmt>>& statements) {
+    beginMain();
+    for (const auto& stmt : statements) {
+        compileTopLevel(stmt.get());
+    }
+    finishMain();
+}
+
+void CodeGen::beginMain() {
     // Create a main function to hold top-level statements
     // Main returns Any* (pointer to Any)
     llvm::FunctionType* funcType = llvm::FunctionType::get(builder->getPtrTy(), false);
@@ -262,15 +469,19 @@ void CodeGen::compile(const std::vector<std::unique_ptr<Stmt>>& statements) {
 
     llvm::BasicBlock* entry = llvm::BasicBlock::Create(*context, "entry", mainFunc);
     builder->SetInsertPoint(entry);
+}
 
-    for (const auto& stmt : statements) {
-        if (builder->GetInsertBlock()->getTerminator()) break;
-        generateStmt(stmt.get());
-    }
+void CodeGen::compileTopLevel(const Stmt* stmt) {
+    if (builder->GetInsertBlock()->getTerminator()) return;
+    generateStmt(stmt);
+}
+
+void CodeGen::finishMain() {
+    llvm::Function* mainFunc = module->getFunction("manifast_main");
 
     // Default return 0 (Boxed Any*) if no terminator
     if (!builder->GetInsertBlock()->getTerminator()) {
-        llvm::Value* retVal = boxDouble(llvm::ConstantFP::get(*context, llvm::APFloat(0.0)));
+        llvm::Value* retVal = createNumber(0.0);
         builder->CreateRet(retVal);
     }
     
@@ -309,29 +520,174 @@ void CodeGen::emitIR(const std::string& path) {
 }
 
 void CodeGen::emitAssembly(const std::string& path) {
+    emitFile(path, llvm::CodeGenFileType::AssemblyFile);
+}
+
+void CodeGen::emitObject(const std::string& path) {
+    emitFile(path, llvm::CodeGenFileType::ObjectFile);
+}
+
+static llvm::CodeGenOptLevel codeGenOptLevel(int level) {
+    switch (level) {
+        case 0: return llvm::CodeGenOptLevel::None;
+        case 1: return llvm::CodeGenOptLevel::Less;
+        case 3: return llvm::CodeGenOptLevel::Aggressive;
+        default: return llvm::CodeGenOptLevel::Default;
+    }
+}
+
+static std::string hostCPUFeatures() {
+    llvm::SubtargetFeatures features;
+#if LLVM_VERSION_MAJOR >= 19
+    for (const auto& f : llvm::sys::getHostCPUFeatures()) features.AddFeature(f.getKey(), f.getValue());
+#else
+    llvm::StringMap<bool> host;
+    if (llvm::sys::getHostCPUFeatures(host)) {
+        for (const auto& f : host) features.AddFeature(f.getKey(), f.getValue());
+    }
+#endif
+    return features.getString();
+}
+
+std::unique_ptr<llvm::TargetMachine> CodeGen::createHostTargetMachine() {
     auto targetTriple = llvm::sys::getDefaultTargetTriple();
     std::string error;
     auto target = llvm::TargetRegistry::lookupTarget(targetTriple, error);
 
     if (!target) {
         std::cerr << error << std::endl;
-        return;
+        return nullptr;
     }
 
-    auto cpu = "generic";
-    auto features = "";
+    // Tune for the machine we are running on (cpu = host)
+    std::string cpu = llvm::sys::getHostCPUName().str();
+    std::string features = hostCPUFeatures();
 
     llvm::TargetOptions opt;
 #if LLVM_VERSION_MAJOR >= 21
     llvm::Triple targetTripleObj(targetTriple);
-    auto targetMachine = target->createTargetMachine(targetTripleObj, cpu, features, opt, llvm::Reloc::PIC_);
+    std::unique_ptr<llvm::TargetMachine> targetMachine(target->createTargetMachine(
+        targetTripleObj, cpu, features, opt, llvm::Reloc::PIC_, std::nullopt, codeGenOptLevel(optLevel)));
     module->setDataLayout(targetMachine->createDataLayout());
     module->setTargetTriple(targetTripleObj);
 #else
-    auto targetMachine = target->createTargetMachine(targetTriple, cpu, features, opt, llvm::Reloc::PIC_);
+    std::unique_ptr<llvm::TargetMachine> targetMachine(target->createTargetMachine(
+        targetTriple, cpu, features, opt, llvm::Reloc::PIC_, std::nullopt, codeGenOptLevel(optLevel)));
     module->setDataLayout(targetMachine->createDataLayout());
     module->setTargetTriple(targetTriple);
 #endif
+    return targetMachine;
+}
+
+// Standard new-PM pipeline (mem2reg/SROA, instcombine, GVN, LICM, vectorizers, ...).
+// The visitors emit one alloca per variable and box every temporary, so this
+// is where most of the JIT's speed comes from.
+void CodeGen::optimizeModule(llvm::Module& M, llvm::TargetMachine* targetMachine) {
+    if (optLevel == 0) return;
+
+    llvm::LoopAnalysisManager LAM;
+    llvm::FunctionAnalysisManager FAM;
+    llvm::CGSCCAnalysisManager CGAM;
+    llvm::ModuleAnalysisManager MAM;
+
+    llvm::PipelineTuningOptions PTO;
+    PTO.LoopVectorization = optLevel >= 2;
+    PTO.SLPVectorization = optLevel >= 2;
+
+    llvm::PassBuilder PB(targetMachine, PTO);
+    PB.registerModuleAnalyses(MAM);
+    PB.registerCGSCCAnalyses(CGAM);
+    PB.registerFunctionAnalyses(FAM);
+    PB.registerLoopAnalyses(LAM);
+    PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+    llvm::OptimizationLevel level = optLevel == 1 ? llvm::OptimizationLevel::O1
+                                  : optLevel == 2 ? llvm::OptimizationLevel::O2
+                                  : llvm::OptimizationLevel::O3;
+    llvm::ModulePassManager MPM = PB.buildPerModuleDefaultPipeline(level);
+    MPM.run(M, MAM);
+}
+
+// Links the runtime's bitcode into the module so the optimizer can see (and
+// inline) the bodies of runtime calls. The copies are only there to be
+// inlined: exported functions become available_externally and the program
+// still links manifast_core for the real definitions. Functions touching the
+// runtime's file-local mutable state (allocation counters, the string pool,
+// plot callbacks) stay declarations, so that state is never duplicated.
+bool CodeGen::linkRuntimeBitcode() {
+    auto buffer = llvm::MemoryBuffer::getFile(runtimeBitcode);
+    if (!buffer) {
+        std::cerr << "Warning: Could not read runtime bitcode " << runtimeBitcode << ": " << buffer.getError().message() << "\n";
+        return false;
+    }
+    auto parsed = llvm::parseBitcodeFile((*buffer)->getMemBufferRef(), *context);
+    if (!parsed) {
+        std::cerr << "Warning: Invalid runtime bitcode " << runtimeBitcode << ": " << llvm::toString(parsed.takeError()) << "\n";
+        return false;
+    }
+    std::unique_ptr<llvm::Module> runtime = std::move(*parsed);
+    runtime->setDataLayout(module->getDataLayout());
+    runtime->setTargetTriple(module->getTargetTriple());
+
+    // Static constructors already run from manifast_core
+    for (const char* name : {"llvm.global_ctors", "llvm.global_dtors"}) {
+        if (llvm::GlobalVariable* list = runtime->getNamedGlobal(name)) list->eraseFromParent();
+    }
+
+    // Functions reaching file-local mutable globals, directly or through
+    // calls to other file-local functions
+    std::unordered_set<llvm::Function*> stateful;
+    std::unordered_set<llvm::User*> visited;
+    std::vector<llvm::Function*> worklist;
+    std::function<void(llvm::User*)> markUsers = [&](llvm::User* value) {
+        for (llvm::User* user : value->users()) {
+            if (auto* inst = llvm::dyn_cast<llvm::Instruction>(user)) {
+                llvm::Function* f = inst->getFunction();
+                if (stateful.insert(f).second) worklist.push_back(f);
+            } else if (llvm::isa<llvm::Constant>(user) && visited.insert(user).second) {
+                markUsers(user);
+            }
+        }
+    };
+    for (llvm::GlobalVariable& global : runtime->globals()) {
+        if (global.hasLocalLinkage() && !global.isConstant()) markUsers(&global);
+    }
+    while (!worklist.empty()) {
+        llvm::Function* f = worklist.back();
+        worklist.pop_back();
+        if (f->hasLocalLinkage()) markUsers(f); // exported ones are called, not copied
+    }
+
+    for (llvm::Function& f : *runtime) {
+        if (f.isDeclaration() || !f.hasExternalLinkage()) continue;
+        f.setComdat(nullptr);
+        if (stateful.count(&f)) f.deleteBody();
+        else f.setLinkage(llvm::GlobalValue::AvailableExternallyLinkage);
+    }
+    for (llvm::GlobalVariable& global : runtime->globals()) {
+        if (global.isDeclaration() || !global.hasExternalLinkage()) continue;
+        global.setComdat(nullptr);
+        if (global.isConstant()) {
+            global.setLinkage(llvm::GlobalValue::AvailableExternallyLinkage);
+        } else {
+            global.setInitializer(nullptr);
+        }
+    }
+
+    // Only what the program references (and what that pulls in) is copied
+    if (llvm::Linker::linkModules(*module, std::move(runtime), llvm::Linker::Flags::LinkOnlyNeeded)) {
+        std::cerr << "Warning: Could not link runtime bitcode " << runtimeBitcode << "\n";
+        return false;
+    }
+    return true;
+}
+
+void CodeGen::emitFile(const std::string& path, llvm::CodeGenFileType fileType) {
+    auto targetMachine = createHostTargetMachine();
+    if (!targetMachine) return;
+
+    if (optLevel > 0 && !runtimeBitcode.empty()) linkRuntimeBitcode();
+    optimizeModule(*module, targetMachine.get());
 
     std::error_code ec;
     llvm::raw_fd_ostream dest(path, ec, llvm::sys::fs::OF_None);
@@ -342,7 +698,6 @@ void CodeGen::emitAssembly(const std::string& path) {
     }
 
     llvm::legacy::PassManager pass;
-    auto fileType = llvm::CodeGenFileType::AssemblyFile;
 
     if (targetMachine->addPassesToEmitFile(pass, dest, nullptr, fileType)) {
         std::cerr << "TargetMachine can't emit a file of this type" << std::endl;
@@ -353,49 +708,106 @@ void CodeGen::emitAssembly(const std::string& path) {
     dest.flush();
 }
 
-void CodeGen::emitObject(const std::string& path) {
-    auto targetTriple = llvm::sys::getDefaultTargetTriple();
-    std::string error;
-    auto target = llvm::TargetRegistry::lookupTarget(targetTriple, error);
+#ifndef MANIFAST_VERSION
+#define MANIFAST_VERSION "dev"
+#endif
 
-    if (!target) {
-        std::cerr << error << std::endl;
-        return;
+namespace {
+
+// Object files of JIT-compiled modules, stored as <dir>/<module id>.o. The
+// module identifier is the cache key, so a hit skips codegen entirely.
+class DiskObjectCache : public llvm::ObjectCache {
+public:
+    explicit DiskObjectCache(std::string dir) : dir(std::move(dir)) {}
+
+    std::string pathFor(llvm::StringRef moduleId) const {
+        llvm::SmallString<256> path(dir);
+        llvm::sys::path::append(path, moduleId + ".o");
+        return std::string(path);
+    }
+    std::string pathFor(const llvm::Module* M) const { return pathFor(M->getModuleIdentifier()); }
+
+    std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module* M) override {
+        auto buffer = llvm::MemoryBuffer::getFile(pathFor(M), /*IsText=*/false, /*RequiresNullTerminator=*/false);
+        if (!buffer) return nullptr;
+        return std::move(*buffer);
+    }
+
+    void notifyObjectCompiled(const llvm::Module* M, llvm::MemoryBufferRef obj) override {
+        // Write to a temporary and rename, so concurrent runs never see a partial object.
+        if (llvm::sys::fs::create_directories(dir)) return;
+        int fd;
+        llvm::SmallString<256> tmp;
+        if (llvm::sys::fs::createUniqueFile(pathFor(M) + ".%%%%%%.tmp", fd, tmp)) return;
+        {
+            llvm::raw_fd_ostream out(fd, /*shouldClose=*/true);
+            out << obj.getBuffer();
+            out.close();
+            if (out.has_error()) {
+                out.clear_error();
+                llvm::sys::fs::remove(tmp);
+                return;
+            }
+        }
+        if (llvm::sys::fs::rename(tmp, pathFor(M))) llvm::sys::fs::remove(tmp);
     }
 
-    auto cpu = "generic";
-    auto features = "";
-
-    llvm::TargetOptions opt;
-#if LLVM_VERSION_MAJOR >= 21
-    llvm::Triple targetTripleObj(targetTriple);
-    auto targetMachine = target->createTargetMachine(targetTripleObj, cpu, features, opt, llvm::Reloc::PIC_);
-    module->setDataLayout(targetMachine->createDataLayout());
-    module->setTargetTriple(targetTripleObj);
-#else
-    auto targetMachine = target->createTargetMachine(targetTriple, cpu, features, opt, llvm::Reloc::PIC_);
-    module->setDataLayout(targetMachine->createDataLayout());
-    module->setTargetTriple(targetTriple);
-#endif
+private:
+    std::string dir;
+};
 
-    std::error_code ec;
-    llvm::raw_fd_ostream dest(path, ec, llvm::sys::fs::OF_None);
+// Partition a function is compiled in when the module is split across the
+// compile pool. Chosen by name, so the split is the same before and after
+// optimization (cached partitions are matched to unoptimized IR). Global
+// variables all stay in partition 0.
+unsigned partitionOf(const llvm::GlobalValue& GV, unsigned partitions) {
+    if (!llvm::isa<llvm::Function>(GV)) return 0;
+    return (unsigned)(llvm::xxHash64(GV.getName()) % partitions);
+}
 
-    if (ec) {
-        std::cerr << "Could not open file: " << ec.message() << std::endl;
-        return;
+// Split modules reference each other's definitions, so nothing may stay
+// module-local. Done before optimization for the same reason as above.
+void externalizeLocals(llvm::Module& M) {
+    unsigned anonymous = 0;
+    for (llvm::GlobalValue& GV : M.global_values()) {
+        if (!GV.hasLocalLinkage()) continue;
+        if (!GV.hasName()) GV.setName("manifast_anon." + std::to_string(anonymous++));
+        GV.setLinkage(llvm::GlobalValue::ExternalLinkage);
+        GV.setVisibility(llvm::GlobalValue::HiddenVisibility);
     }
+}
 
-    llvm::legacy::PassManager pass;
-    auto fileType = llvm::CodeGenFileType::ObjectFile;
+} // namespace
 
-    if (targetMachine->addPassesToEmitFile(pass, dest, nullptr, fileType)) {
-        std::cerr << "TargetMachine can't emit a file of this type" << std::endl;
+void CodeGen::enableObjectCache(const std::string& dir) {
+    if (!dir.empty()) {
+        objectCacheDir = dir;
         return;
     }
+    llvm::SmallString<256> path;
+    if (const char* env = std::getenv("MANIFAST_CACHE_DIR")) {
+        path = env;
+    } else if (llvm::sys::path::cache_directory(path)) {
+        llvm::sys::path::append(path, "manifast");
+    } else {
+        return; // no usable cache location
+    }
+    llvm::sys::path::append(path, "jit");
+    objectCacheDir = std::string(path);
+}
 
-    pass.run(*module);
-    dest.flush();
+// Everything the machine code depends on besides the runtime's symbol names.
+std::string CodeGen::objectCacheKey(const std::string& cpu, const std::string& features) const {
+    llvm::SHA256 hash;
+    hash.update(source);
+    for (llvm::StringRef part : {llvm::StringRef(MANIFAST_VERSION), llvm::StringRef(LLVM_VERSION_STRING),
+                                 llvm::StringRef(cpu), llvm::StringRef(features)}) {
+        hash.update(llvm::StringRef("\0", 1));
+        hash.update(part);
+    }
+    hash.update(std::to_string(optLevel));
+    if (profile) hash.update(profile->serialize());
+    return "mf-" + llvm::toHex(hash.final(), /*LowerCase=*/true);
 }
 
 // Static initialization - runs once per process
@@ -408,7 +820,55 @@ static struct LLVMInit {
 } llvmInit;
 
 bool CodeGen::run() {
-    auto jit = llvm::ExitOnError()(llvm::orc::LLJITBuilder().create());
+    auto jtmb = llvm::ExitOnError()(llvm::orc::JITTargetMachineBuilder::detectHost());
+    jtmb.setCPU(llvm::sys::getHostCPUName().str());
+    jtmb.setCodeGenOptLevel(codeGenOptLevel(optLevel));
+    std::unique_ptr<llvm::TargetMachine> targetMachine;
+    if (optLevel > 0) targetMachine = llvm::ExitOnError()(jtmb.createTargetMachine());
+
+    // On-disk object cache: the module is renamed to its cache key, and a
+    // cached object for that key replaces optimization and codegen.
+    std::unique_ptr<DiskObjectCache> objectCache;
+    if (!objectCacheDir.empty() && !source.empty()) {
+        objectCache = std::make_unique<DiskObjectCache>(objectCacheDir);
+        module->setModuleIdentifier(objectCacheKey(jtmb.getCPU(), hostCPUFeatures()));
+    }
+
+    DiskObjectCache* cache = objectCache.get();
+    const bool concurrent = compileThreads > 1;
+    auto compileWithCache = [cache, concurrent](llvm::orc::JITTargetMachineBuilder builder)
+        -> llvm::Expected<std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler>> {
+        // A TargetMachine is not thread-safe; pool workers each build their own.
+        if (concurrent) return std::make_unique<llvm::orc::ConcurrentIRCompiler>(std::move(builder), cache);
+        auto tm = builder.createTargetMachine();
+        if (!tm) return tm.takeError();
+        return std::make_unique<llvm::orc::TMOwningSimpleCompiler>(std::move(*tm), cache);
+    };
+
+    // Lazy mode: every function sits behind a compile-on-first-call stub
+    // (CompileOnDemandLayer), so startup only pays for code that runs. Hosts
+    // without lazy stub support fall back to compiling everything up front.
+    std::unique_ptr<llvm::orc::LLJIT> jit;
+    llvm::orc::LLLazyJIT* lazyJit = nullptr;
+    if (lazyCompilation) {
+        llvm::orc::LLLazyJITBuilder lazyBuilder;
+        lazyBuilder.setJITTargetMachineBuilder(jtmb);
+        if (concurrent) lazyBuilder.setNumCompileThreads(compileThreads);
+        if (cache) lazyBuilder.setCompileFunctionCreator(compileWithCache);
+        if (auto created = lazyBuilder.create()) {
+            lazyJit = created->get();
+            jit = std::move(*created);
+        } else {
+            llvm::consumeError(created.takeError());
+        }
+    }
+    if (!jit) {
+        llvm::orc::LLJITBuilder jitBuilder;
+        jitBuilder.setJITTargetMachineBuilder(jtmb);
+        if (concurrent) jitBuilder.setNumCompileThreads(compileThreads);
+        if (cache) jitBuilder.setCompileFunctionCreator(compileWithCache);
+        jit = llvm::ExitOnError()(jitBuilder.create());
+    }
     
     // Add library search for host symbols
     jit->getMainJITDylib().addGenerator(
@@ -433,8 +893,11 @@ bool CodeGen::run() {
     REGISTER_SYM(manifast_create_object);
     REGISTER_SYM(manifast_object_set);
     REGISTER_SYM(manifast_object_get);
+    REGISTER_SYM(manifast_object_set_raw);
     REGISTER_SYM(manifast_array_set);
     REGISTER_SYM(manifast_array_get);
+    REGISTER_SYM(manifast_index_set);
+    REGISTER_SYM(manifast_index_get);
     REGISTER_SYM(manifast_print_any);
     REGISTER_SYM(manifast_println_any);
     REGISTER_SYM(manifast_printfmt);
@@ -444,6 +907,7 @@ bool CodeGen::run() {
     REGISTER_SYM(manifast_create_instance);
     REGISTER_SYM(manifast_class_add_method);
     REGISTER_SYM(manifast_type_check);
+    REGISTER_SYM(manifast_type_check_array);
     REGISTER_SYM(manifast_array_len);
     REGISTER_SYM(manifast_array_push);
     REGISTER_SYM(manifast_array_pop);
@@ -474,7 +938,74 @@ bool CodeGen::run() {
     module->setTargetTriple(jit->getTargetTriple().getTriple());
 #endif
 
-    auto err = jit->addIRModule(llvm::orc::ThreadSafeModule(std::move(module), std::move(context)));
+    // With a compile pool, eager mode spreads the functions over one module
+    // per worker.
+    unsigned partitions = 1;
+    if (!lazyJit && concurrent) {
+        size_t defined = llvm::count_if(module->functions(), [](const llvm::Function& F) { return !F.isDeclaration(); });
+        partitions = (unsigned)std::min<size_t>(compileThreads, defined);
+        if (partitions > 1) externalizeLocals(*module);
+    }
+    const std::string moduleId = module->getModuleIdentifier();
+    auto partitionId = [&](unsigned p) {
+        return partitions == 1 ? moduleId : moduleId + ".p" + std::to_string(p) + "of" + std::to_string(partitions);
+    };
+
+    llvm::orc::ThreadSafeModule tsm(std::move(module), std::move(context));
+    llvm::Error err = [&]() -> llvm::Error {
+        if (lazyJit) {
+            // Partitions are optimized one by one as they are first called
+            // (no inlining across them), skipping any the object cache already
+            // has. On a compile pool each partition first moves to a fresh
+            // LLVMContext; workers sharing one would take turns on its lock.
+            if (optLevel > 0 || concurrent) {
+                lazyJit->getIRTransformLayer().setTransform(
+                    [this, tm = targetMachine.get(), cache, concurrent, jtmb](llvm::orc::ThreadSafeModule partition,
+                                                                              const llvm::orc::MaterializationResponsibility&)
+                        -> llvm::Expected<llvm::orc::ThreadSafeModule> {
+                        llvm::TargetMachine* partitionTM = tm;
+                        std::unique_ptr<llvm::TargetMachine> ownTM;
+                        if (concurrent) {
+                            std::string id = partition.withModuleDo([](llvm::Module& M) { return M.getModuleIdentifier(); });
+                            partition = llvm::orc::cloneToNewContext(partition);
+                            partition.withModuleDo([&](llvm::Module& M) { M.setModuleIdentifier(id); });
+                            if (optLevel > 0) {
+                                auto created = llvm::orc::JITTargetMachineBuilder(jtmb).createTargetMachine();
+                                if (!created) return created.takeError();
+                                ownTM = std::move(*created);
+                                partitionTM = ownTM.get();
+                            }
+                        }
+                        if (optLevel > 0) {
+                            partition.withModuleDo([&](llvm::Module& M) {
+                                if (!cache || !llvm::sys::fs::exists(cache->pathFor(&M))) optimizeModule(M, partitionTM);
+                            });
+                        }
+                        return std::move(partition);
+                    });
+            }
+            return lazyJit->addLazyIRModule(std::move(tsm));
+        }
+
+        bool cachedObject = cache != nullptr;
+        for (unsigned p = 0; cachedObject && p < partitions; p++) {
+            cachedObject = llvm::sys::fs::exists(cache->pathFor(partitionId(p)));
+        }
+        tsm.withModuleDo([&](llvm::Module& M) {
+            if (!cachedObject) optimizeModule(M, targetMachine.get());
+        });
+        if (partitions == 1) return jit->addIRModule(std::move(tsm));
+
+        // Each part gets its own LLVMContext so the workers never contend.
+        for (unsigned p = 0; p < partitions; p++) {
+            auto part = llvm::orc::cloneToNewContext(tsm, [&](const llvm::GlobalValue& GV) {
+                return partitionOf(GV, partitions) == p;
+            });
+            part.withModuleDo([&](llvm::Module& M) { M.setModuleIdentifier(partitionId(p)); });
+            if (auto partErr = jit->addIRModule(std::move(part))) return partErr;
+        }
+        return llvm::Error::success();
+    }();
     if (err) {
         std::cerr << "Error adding IR module: " << llvm::toString(std::move(err)) << "\n";
         return false;
@@ -500,56 +1031,51 @@ bool CodeGen::run() {
 }
 
 llvm::Value* CodeGen::generateExpr(const Expr* expr) {
-    if (auto* num = dynamic_cast<const NumberExpr*>(expr)) return visitNumberExpr(num);
-    if (auto* bin = dynamic_cast<const BinaryExpr*>(expr)) return visitBinaryExpr(bin);
-    if (auto* var = dynamic_cast<const VariableExpr*>(expr)) return visitVariableExpr(var);
-    if (auto* bl = dynamic_cast<const BoolExpr*>(expr)) return visitBoolExpr(bl);
-    if (auto* nl = dynamic_cast<const NilExpr*>(expr)) return visitNilExpr(nl);
-    if (auto* un = dynamic_cast<const UnaryExpr*>(expr)) return visitUnaryExpr(un);
-    if (auto* assign = dynamic_cast<const AssignExpr*>(expr)) return visitAssignExpr(assign);
-    if (auto* call = dynamic_cast<const CallExpr*>(expr)) return visitCallExpr(call);
-    if (auto* arr = dynamic_cast<const ArrayExpr*>(expr)) return visitArrayExpr(arr);
-    if (auto* obj = dynamic_cast<const ObjectExpr*>(expr)) return visitObjectExpr(obj);
-    if (auto* str = dynamic_cast<const StringExpr*>(expr)) return visitStringExpr(str);
-    if (auto* chr = dynamic_cast<const CharExpr*>(expr)) return visitCharExpr(chr);
-    if (auto* fnExpr = dynamic_cast<const FunctionExpr*>(expr)) return visitFunctionExpr(fnExpr);
-    if (auto* idx = dynamic_cast<const IndexExpr*>(expr)) return visitIndexExpr(idx);
-    if (auto* get = dynamic_cast<const GetExpr*>(expr)) return visitGetExpr(get);
-    return nullptr;
+    if (!expr) return nullptr;
+    switch (expr->kind) {
+    case NodeKind::Number:   return visitNumberExpr(static_cast<const NumberExpr*>(expr));
+    case NodeKind::Binary:   return visitBinaryExpr(static_cast<const BinaryExpr*>(expr));
+    case NodeKind::Variable: return visitVariableExpr(static_cast<const VariableExpr*>(expr));
+    case NodeKind::Bool:     return visitBoolExpr(static_cast<const BoolExpr*>(expr));
+    case NodeKind::Nil:      return visitNilExpr(static_cast<const NilExpr*>(expr));
+    case NodeKind::Unary:    return visitUnaryExpr(static_cast<const UnaryExpr*>(expr));
+    case NodeKind::Assign:   return visitAssignExpr(static_cast<const AssignExpr*>(expr));
+    case NodeKind::Call:     return visitCallExpr(static_cast<const CallExpr*>(expr));
+    case NodeKind::Array:    return visitArrayExpr(static_cast<const ArrayExpr*>(expr));
+    case NodeKind::Object:   return visitObjectExpr(static_cast<const ObjectExpr*>(expr));
+    case NodeKind::String:   return visitStringExpr(static_cast<const StringExpr*>(expr));
+    case NodeKind::Char:     return visitCharExpr(static_cast<const CharExpr*>(expr));
+    case NodeKind::Function: return visitFunctionExpr(static_cast<const FunctionExpr*>(expr));
+    case NodeKind::Index:    return visitIndexExpr(static_cast<const IndexExpr*>(expr));
+    case NodeKind::Get:      return visitGetExpr(static_cast<const GetExpr*>(expr));
+    default:                 return nullptr;
+    }
 }
 
 void CodeGen::generateStmt(const Stmt* stmt) {
-    if (auto* exprStmt = dynamic_cast<const ExprStmt*>(stmt)) {
-        generateExpr(exprStmt->expression.get());
-    } else if (auto* varDecl = dynamic_cast<const VarDeclStmt*>(stmt)) {
-        visitVarDeclStmt(varDecl);
-    } else if (auto* retStmt = dynamic_cast<const ReturnStmt*>(stmt)) {
-        visitReturnStmt(retStmt);
-    } else if (auto* block = dynamic_cast<const BlockStmt*>(stmt)) {
-        visitBlockStmt(block);
-    } else if (auto* ifStmt = dynamic_cast<const IfStmt*>(stmt)) {
-        visitIfStmt(ifStmt);
-    } else if (auto* whileStmt = dynamic_cast<const WhileStmt*>(stmt)) {
-        visitWhileStmt(whileStmt);
-    } else if (auto* forStmt = dynamic_cast<const ForStmt*>(stmt)) {
-        visitForStmt(forStmt);
-    } else if (auto* tryStmt = dynamic_cast<const TryStmt*>(stmt)) {
-        visitTryStmt(tryStmt);
-    } else if (auto* funcStmt = dynamic_cast<const FunctionStmt*>(stmt)) {
-        visitFunctionStmt(funcStmt);
-    } else if (auto* classStmt = dynamic_cast<const ClassStmt*>(stmt)) {
-        visitClassStmt(classStmt);
-    } else if (auto* aliasStmt = dynamic_cast<const TypeAliasStmt*>(stmt)) {
-        visitTypeAliasStmt(aliasStmt);
+    if (!stmt) return;
+    switch (stmt->kind) {
+    case NodeKind::ExprStmt:
+        generateExpr(static_cast<const ExprStmt*>(stmt)->expression.get());
+        break;
+    case NodeKind::VarDecl:      visitVarDeclStmt(static_cast<const VarDeclStmt*>(stmt)); break;
+    case NodeKind::Return:       visitReturnStmt(static_cast<const ReturnStmt*>(stmt)); break;
+    case NodeKind::Block:        visitBlockStmt(static_cast<const BlockStmt*>(stmt)); break;
+    case NodeKind::If:           visitIfStmt(static_cast<const IfStmt*>(stmt)); break;
+    case NodeKind::While:        visitWhileStmt(static_cast<const WhileStmt*>(stmt)); break;
+    case NodeKind::For:          visitForStmt(static_cast<const ForStmt*>(stmt)); break;
+    case NodeKind::Try:          visitTryStmt(static_cast<const TryStmt*>(stmt)); break;
+    case NodeKind::FunctionDecl: visitFunctionStmt(static_cast<const FunctionStmt*>(stmt)); break;
+    case NodeKind::Class:        visitClassStmt(static_cast<const ClassStmt*>(stmt)); break;
+    case NodeKind::TypeAlias:    visitTypeAliasStmt(static_cast<const TypeAliasStmt*>(stmt)); break;
+    default: break;
     }
 }
 
 void CodeGen::visitIfStmt(const IfStmt* stmt) {
-    llvm::Value* condV = generateExpr(stmt->condition.get());
-    if (!condV) return;
-
-    // Unbox condition (Any* -> double)
-    llvm::Value* unpacked = unboxNumber(condV);
+    // Condition as an unboxed double (comparisons never get boxed)
+    llvm::Value* unpacked = generateNumber(stmt->condition.get());
+    if (!unpacked) return;
     // Convert condition to bool (double != 0)
     unpacked = builder->CreateFCmpONE(unpacked, llvm::ConstantFP::get(*context, llvm::APFloat(0.0)), "ifcond");
 
@@ -560,9 +1086,9 @@ void CodeGen::visitIfStmt(const IfStmt* stmt) {
     llvm::BasicBlock* mergeBB = llvm::BasicBlock::Create(*context, "ifcont");
 
     if (stmt->elseBranch) {
-        builder->CreateCondBr(unpacked, thenBB, elseBB);
+        builder->CreateCondBr(unpacked, thenBB, elseBB, branchWeights(stmt->offset));
     } else {
-        builder->CreateCondBr(unpacked, thenBB, mergeBB);
+        builder->CreateCondBr(unpacked, thenBB, mergeBB, branchWeights(stmt->offset));
     }
 
     // Emit then block
@@ -599,12 +1125,10 @@ void CodeGen::visitWhileStmt(const WhileStmt* stmt) {
     builder->CreateBr(condBB);
     builder->SetInsertPoint(condBB);
 
-    llvm::Value* condV = generateExpr(stmt->condition.get());
-    if (!condV) return;
-    
-    llvm::Value* unpacked = unboxNumber(condV);
+    llvm::Value* unpacked = generateNumber(stmt->condition.get());
+    if (!unpacked) return;
     unpacked = builder->CreateFCmpONE(unpacked, llvm::ConstantFP::get(*context, llvm::APFloat(0.0)), "whilecond");
-    builder->CreateCondBr(unpacked, bodyBB, afterBB);
+    builder->CreateCondBr(unpacked, bodyBB, afterBB, branchWeights(stmt->offset));
 
     bodyBB->insertInto(func);
     builder->SetInsertPoint(bodyBB);
@@ -623,20 +1147,19 @@ void CodeGen::visitForStmt(const ForStmt* stmt) {
     pushScope(); // Loop scope for i
 
     // 1. Initializer
-    llvm::Value* startV = generateExpr(stmt->start.get()); // Any*
-    if (!startV) {
+    llvm::Value* startDouble = generateNumber(stmt->start.get());
+    if (!startDouble) {
         popScope();
         return;
     }
 
+    // The counter stays an unboxed double for the whole loop (steps may be
+    // fractional); it is only boxed when the body reads it as a value.
     llvm::IRBuilder<> tmpBuilder(&func->getEntryBlock(), func->getEntryBlock().begin());
-    llvm::AllocaInst* alloca = tmpBuilder.CreateAlloca(anyType, nullptr, stmt->varName);
+    llvm::AllocaInst* alloca = tmpBuilder.CreateAlloca(builder->getDoubleTy(), nullptr, stmt->varName.str());
+    builder->CreateStore(startDouble, alloca);
     
-    // Copy startV to alloca
-    llvm::Value* startLoaded = builder->CreateLoad(anyType, startV);
-    builder->CreateStore(startLoaded, alloca);
-    
-    scopes.back()[stmt->varName] = {alloca, Type(TypeKind::Int32)}; // Loop index is i32
+    scopes.back()[stmt->varName] = VarInfo(alloca, Type(TypeKind::Int32), builder->getDoubleTy()); // Loop index is i32
 
     // 2. Blocks
     llvm::BasicBlock* condBB = llvm::BasicBlock::Create(*context, "forcond", func);
@@ -647,14 +1170,12 @@ void CodeGen::visitForStmt(const ForStmt* stmt) {
     builder->SetInsertPoint(condBB);
 
     // 3. Condition (i <= end)
-    llvm::Value* currV = builder->CreateLoad(anyType, alloca, stmt->varName.c_str());
-    llvm::Value* currValPtr = builder->CreateAlloca(anyType); // Temp ptr for unbox
-    builder->CreateStore(currV, currValPtr);
-    
-    llvm::Value* currDouble = unboxNumber(currValPtr);
-    
-    llvm::Value* endV = generateExpr(stmt->end.get());
-    llvm::Value* endDouble = unboxNumber(endV);
+    llvm::Value* currDouble = builder->CreateLoad(builder->getDoubleTy(), alloca, stmt->varName.c_str());
+    llvm::Value* endDouble = generateNumber(stmt->end.get());
+    if (!endDouble) {
+        popScope();
+        return;
+    }
     
     llvm::Value* condV = builder->CreateFCmpOLE(currDouble, endDouble, "fortmp");
     builder->CreateCondBr(condV, bodyBB, afterBB);
@@ -664,25 +1185,15 @@ void CodeGen::visitForStmt(const ForStmt* stmt) {
     builder->SetInsertPoint(bodyBB);
     generateStmt(stmt->body.get());
 
-    // 5. Update (i = i + step)
-    llvm::Value* stepV = stmt->step ? generateExpr(stmt->step.get()) : boxDouble(llvm::ConstantFP::get(*context, llvm::APFloat(1.0)));
-    llvm::Value* stepDouble = unboxNumber(stepV);
-    
-    // currDouble is potentially stale, should reload? No, we are in correct block order?
-    // Actually we need to reload i inside the loop/latch if it was modified?
-    // Simplified: i = i + step.
-    // Reload currVal
-    llvm::Value* loadedCurr = builder->CreateLoad(anyType, alloca);
-    builder->CreateStore(loadedCurr, currValPtr); // Reuse temp
-    llvm::Value* valNow = unboxNumber(currValPtr);
-    
-    llvm::Value* nextDouble = builder->CreateFAdd(valNow, stepDouble, "nextvar");
-    llvm::Value* nextAny = boxDouble(nextDouble); // Returns Any* (temp)
-    
-    llvm::Value* nextLoaded = builder->CreateLoad(anyType, nextAny);
-    builder->CreateStore(nextLoaded, alloca);
-
+    // 5. Update (i = i + step), reloading i in case the body assigned it
     if (!builder->GetInsertBlock()->getTerminator()) {
+        llvm::Value* stepDouble = stmt->step ? generateNumber(stmt->step.get())
+                                             : llvm::ConstantFP::get(*context, llvm::APFloat(1.0));
+        if (stepDouble) {
+            llvm::Value* valNow = builder->CreateLoad(builder->getDoubleTy(), alloca);
+            llvm::Value* nextDouble = builder->CreateFAdd(valNow, stepDouble, "nextvar");
+            builder->CreateStore(nextDouble, alloca);
+        }
         builder->CreateBr(condBB);
     }
 
@@ -692,6 +1203,35 @@ void CodeGen::visitForStmt(const ForStmt* stmt) {
     popScope();
 }
 
+llvm::MDNode* CodeGen::branchWeights(int offset) {
+    if (!profile) return nullptr;
+    auto it = profile->branches.find(offset);
+    if (it == profile->branches.end()) return nullptr;
+    uint64_t taken = it->second.taken, notTaken = it->second.notTaken;
+    if (taken + notTaken == 0) return nullptr;
+    // Weights are 32-bit; only their ratio matters
+    uint64_t scale = std::max(taken, notTaken) / UINT32_MAX + 1;
+    return llvm::MDBuilder(*context).createBranchWeights((uint32_t)(taken / scale), (uint32_t)(notTaken / scale));
+}
+
+// Functions the profiled run never called are moved out of the way
+// (.text.unlikely, optimized for size); the most called ones are marked hot.
+void CodeGen::applyCallProfile(llvm::Function* func, const std::string& name) {
+    if (!profile) return;
+    uint64_t maxCalls = 0;
+    for (const auto& [fn, count] : profile->calls) maxCalls = std::max(maxCalls, count);
+    auto it = profile->calls.find(name);
+    uint64_t calls = it == profile->calls.end() ? 0 : it->second;
+    func->setEntryCount(calls);
+    if (calls == 0) {
+        func->addFnAttr(llvm::Attribute::Cold);
+        func->setSectionPrefix("unlikely");
+    } else if (calls * 10 >= maxCalls) {
+        func->addFnAttr(llvm::Attribute::Hot);
+        func->setSectionPrefix("hot");
+    }
+}
+
 llvm::Value* CodeGen::visitNumberExpr(const NumberExpr* expr) {
     return createNumber(expr->value);
 }
@@ -709,8 +1249,8 @@ llvm::Value* CodeGen::visitBinaryExpr(const BinaryExpr* expr) {
         llvm::BasicBlock* rightBB = llvm::BasicBlock::Create(*context, "logical_right", func);
         llvm::BasicBlock* mergeBB = llvm::BasicBlock::Create(*context, "logical_merge", func);
         
-        if (isAnd) builder->CreateCondBr(LCond, rightBB, mergeBB);
-        else builder->CreateCondBr(LCond, mergeBB, rightBB);
+        if (isAnd) builder->CreateCondBr(LCond, rightBB, mergeBB, branchWeights(expr->offset));
+        else builder->CreateCondBr(LCond, mergeBB, rightBB, branchWeights(expr->offset));
         
         // Eval Right
         builder->SetInsertPoint(rightBB);
@@ -727,17 +1267,16 @@ llvm::Value* CodeGen::visitBinaryExpr(const BinaryExpr* expr) {
         return phi;
     }
 
-    llvm::Value* L = generateExpr(expr->left.get());
-    llvm::Value* R = generateExpr(expr->right.get());
-    if (!L || !R) return nullptr;
-
-    // Unbox inputs (assuming they are Any*)
-    llvm::Value* LVal = unboxNumber(L);
-    llvm::Value* RVal = unboxNumber(R);
+    // Operands and nested arithmetic stay unboxed; only the result is boxed.
+    llvm::Value* res = generateNumber(expr);
+    if (!res) return nullptr;
+    return boxDouble(res);
+}
 
+llvm::Value* CodeGen::emitNumericOp(TokenType op, llvm::Value* LVal, llvm::Value* RVal) {
     // Compute result (double or bool)
     llvm::Value* res = nullptr;
-    switch (expr->op) {
+    switch (op) {
         case TokenType::Plus:  res = builder->CreateFAdd(LVal, RVal, "addtmp"); break;
         case TokenType::Minus: res = builder->CreateFSub(LVal, RVal, "subtmp"); break;
         case TokenType::Star:  res = builder->CreateFMul(LVal, RVal, "multmp"); break;
@@ -814,61 +1353,41 @@ llvm::Value* CodeGen::visitBinaryExpr(const BinaryExpr* expr) {
         }
         
         default: 
-            std::cerr << "Unimplemented binary operator: " << tokenTypeToString(expr->op) << "\n";
+            std::cerr << "Unimplemented binary operator: " << tokenTypeToString(op) << "\n";
             return nullptr;
     }
     
-    // Box result
-    return boxDouble(res);
+    return res;
 }
 
 llvm::Value* CodeGen::visitBoolExpr(const BoolExpr* expr) {
-    llvm::Function* func = module->getFunction("manifast_create_boolean");
-    if (!func) {
-        llvm::FunctionType* ft = llvm::FunctionType::get(builder->getPtrTy(), {builder->getInt1Ty()}, false);
-        func = llvm::Function::Create(ft, llvm::Function::ExternalLinkage, "manifast_create_boolean", module.get());
-    }
-    return createCallOrInvoke(func, {builder->getInt1(expr->value)});
+    return createLiteral(ANY_BOOLEAN, expr->value ? 1.0 : 0.0);
 }
 
 llvm::Value* CodeGen::visitNilExpr(const NilExpr* expr) {
-    llvm::Function* func = module->getFunction("manifast_create_nil");
-    if (!func) {
-        llvm::FunctionType* ft = llvm::FunctionType::get(builder->getPtrTy(), {}, false);
-        func = llvm::Function::Create(ft, llvm::Function::ExternalLinkage, "manifast_create_nil", module.get());
-    }
-    return createCallOrInvoke(func, {});
+    return createLiteral(ANY_NIL, 0.0);
 }
 
 llvm::Value* CodeGen::visitCharExpr(const CharExpr* expr) {
-    llvm::Function* func = module->getFunction("manifast_create_number");
-    if (!func) {
-        llvm::FunctionType* ft = llvm::FunctionType::get(builder->getPtrTy(), {builder->getDoubleTy()}, false);
-        func = llvm::Function::Create(ft, llvm::Function::ExternalLinkage, "manifast_create_number", module.get());
-    }
-    return createCallOrInvoke(func, {llvm::ConstantFP::get(*context, llvm::APFloat((double)expr->value))});
+    return createNumber((double)expr->value);
 }
 
 llvm::Value* CodeGen::visitUnaryExpr(const UnaryExpr* expr) {
+    if (expr->op == TokenType::Minus) {
+        llvm::Value* res = generateNumber(expr);
+        return res ? boxDouble(res) : nullptr;
+    }
+
     llvm::Value* v = generateExpr(expr->right.get());
     if (!v) return nullptr;
     
     llvm::Value* val = unboxNumber(v);
     
-    if (expr->op == TokenType::Minus) {
-        llvm::Value* res = builder->CreateFNeg(val, "negtmp");
-        return boxDouble(res);
-    } else if (expr->op == TokenType::Bang) {
+    if (expr->op == TokenType::Bang) {
         // Truthiness: 0 is false, others are true.
         // !v => (v == 0) ? 1 : 0
         llvm::Value* cond = builder->CreateFCmpOEQ(val, llvm::ConstantFP::get(*context, llvm::APFloat(0.0)), "nottmp");
-        
-        llvm::Function* func = module->getFunction("manifast_create_boolean");
-        if (!func) {
-            llvm::FunctionType* ft = llvm::FunctionType::get(builder->getPtrTy(), {builder->getInt1Ty()}, false);
-            func = llvm::Function::Create(ft, llvm::Function::ExternalLinkage, "manifast_create_boolean", module.get());
-        }
-        return createCallOrInvoke(func, {cond});
+        return boxTemp(ANY_BOOLEAN, builder->CreateUIToFP(cond, builder->getDoubleTy()));
     }
     return v;
 }
@@ -876,9 +1395,13 @@ llvm::Value* CodeGen::visitUnaryExpr(const UnaryExpr* expr) {
 llvm::Value* CodeGen::visitVariableExpr(const VariableExpr* expr) {
     VarInfo info = lookupVariable(expr->name);
     if (!info.value) {
-        std::cerr << "Unknown variable name: " << expr->name << "\n";
+        std::cerr << "Unknown variable name: " << expr->name.str() << "\n";
         return nullptr;
     }
+    if (info.native) {
+        // Escapes to the dynamic runtime: box as a plain number
+        return boxNumberTemp(builder->CreateLoad(info.native, info.value, expr->name.c_str()));
+    }
     
     llvm::Value* temp = builder->CreateAlloca(anyType, nullptr, "var_read");
     llvm::Value* val = builder->CreateLoad(anyType, info.value, expr->name.c_str());
@@ -886,14 +1409,41 @@ llvm::Value* CodeGen::visitVariableExpr(const VariableExpr* expr) {
     return temp;
 }
 
+llvm::Value* CodeGen::assignNative(const VarInfo& info, const AssignExpr* expr) {
+    int runtimeType = mapTypeToRuntime(info.type);
+    llvm::Value* RVal = generateNumberChecked(expr->value.get(), runtimeType);
+    if (!RVal) return nullptr;
+
+    llvm::Value* res = RVal;
+    if (expr->op != TokenType::Equal) {
+        llvm::Value* LVal = builder->CreateLoad(info.native, info.value);
+        switch (expr->op) {
+            case TokenType::PlusEqual:    res = builder->CreateFAdd(LVal, RVal, "addtmp"); break;
+            case TokenType::MinusEqual:   res = builder->CreateFSub(LVal, RVal, "subtmp"); break;
+            case TokenType::StarEqual:    res = builder->CreateFMul(LVal, RVal, "multmp"); break;
+            case TokenType::SlashEqual:   res = builder->CreateFDiv(LVal, RVal, "divtmp"); break;
+            case TokenType::PercentEqual: res = builder->CreateFRem(LVal, RVal, "remtmp"); break;
+            default: break;
+        }
+    }
+
+    builder->CreateStore(res, info.value);
+    return boxNumberTemp(res);
+}
+
 llvm::Value* CodeGen::visitAssignExpr(const AssignExpr* expr) {
+    if (auto* var = nodeAs<VariableExpr>(expr->target.get())) {
+        VarInfo info = lookupVariable(var->name);
+        if (info.native) return assignNative(info, expr);
+    }
+
     llvm::Value* val = generateExpr(expr->value.get()); // Returns Any* (temp)
     if (!val) return nullptr;
 
-    if (auto* var = dynamic_cast<VariableExpr*>(expr->target.get())) {
+    if (auto* var = nodeAs<VariableExpr>(expr->target.get())) {
         VarInfo info = lookupVariable(var->name);
         if (!info.value) {
-            std::cerr << "Unknown variable name: " << var->name << "\n";
+            std::cerr << "Unknown variable name: " << var->name.str() << "\n";
             return nullptr;
         }
 
@@ -922,9 +1472,9 @@ llvm::Value* CodeGen::visitAssignExpr(const AssignExpr* expr) {
         llvm::Value* loadedVal = builder->CreateLoad(anyType, val);
         builder->CreateStore(loadedVal, info.value);
         return val;
-    } else if (auto* get = dynamic_cast<GetExpr*>(expr->target.get())) {
+    } else if (auto* get = nodeAs<GetExpr>(expr->target.get())) {
         llvm::Value* obj = generateExpr(get->object.get());
-        llvm::Value* keyStr = builder->CreateGlobalString(get->name);
+        llvm::Value* keyStr = builder->CreateGlobalString(get->name.str());
         
         llvm::Function* func = module->getFunction("manifast_object_set");
         if (!func) {
@@ -933,9 +1483,21 @@ llvm::Value* CodeGen::visitAssignExpr(const AssignExpr* expr) {
         }
         createCallOrInvoke(func, {obj, keyStr, val});
         return val;
-    } else if (auto* idx = dynamic_cast<IndexExpr*>(expr->target.get())) {
+    } else if (auto* idx = nodeAs<IndexExpr>(expr->target.get())) {
         llvm::Value* obj = generateExpr(idx->object.get());
-        llvm::Value* indexVal = unboxNumber(generateExpr(idx->index.get()));
+        if (!isStaticallyNumeric(idx->index.get())) {
+            llvm::Value* key = generateExpr(idx->index.get());
+            if (!key) return nullptr;
+            llvm::Function* func = module->getFunction("manifast_index_set");
+            if (!func) {
+                llvm::FunctionType* ft = llvm::FunctionType::get(builder->getVoidTy(), {builder->getPtrTy(), builder->getPtrTy(), builder->getPtrTy()}, false);
+                func = llvm::Function::Create(ft, llvm::Function::ExternalLinkage, "manifast_index_set", module.get());
+            }
+            createCallOrInvoke(func, {obj, key, val});
+            return val;
+        }
+        llvm::Value* indexVal = generateNumber(idx->index.get());
+        if (!indexVal) return nullptr;
         
         llvm::Function* func = module->getFunction("manifast_array_set");
         if (!func) {
@@ -951,9 +1513,9 @@ llvm::Value* CodeGen::visitAssignExpr(const AssignExpr* expr) {
 }
 
 llvm::Value* CodeGen::visitCallExpr(const CallExpr* expr) {
-    auto* var = dynamic_cast<VariableExpr*>(expr->callee.get());
+    auto* var = nodeAs<VariableExpr>(expr->callee.get());
     if (!var) {
-        auto* get = dynamic_cast<GetExpr*>(expr->callee.get());
+        auto* get = nodeAs<GetExpr>(expr->callee.get());
         if (get) {
             llvm::Value* obj = generateExpr(get->object.get()); // Any*
             std::string methodName = get->name;
@@ -965,7 +1527,7 @@ llvm::Value* CodeGen::visitCallExpr(const CallExpr* expr) {
                 }
                 llvm::Value* arg = generateExpr(expr->args[0].get()); // Any*
                 createCallOrInvoke(module->getFunction("manifast_array_push"), {obj, arg});
-                return boxDouble(llvm::ConstantFP::get(*context, llvm::APFloat(0.0)));
+                return createNumber(0.0);
             } else if (methodName == "pop") {
                 return createCallOrInvoke(module->getFunction("manifast_array_pop"), {obj});
             } else {
@@ -1000,27 +1562,55 @@ llvm::Value* CodeGen::visitCallExpr(const CallExpr* expr) {
     }
 
     std::string funcName = var->name;
-    VarInfo varInfo = lookupVariable(funcName);
+    VarInfo varInfo = lookupVariable(var->name);
 
     // Static Type Checking for Arguments if function signature is known
     Type ft = resolveType(varInfo.type);
     if (ft.kind == TypeKind::Function) {
-        for (size_t i = 0; i < expr->args.size() && i < ft.params.size(); i++) {
-            enforceStaticType(expr->args[i].get(), ft.params[i], "argumen " + std::to_string(i+1));
+        for (size_t i = 0; i < expr->args.size() && i < ft.params().size(); i++) {
+            enforceStaticType(expr->args[i].get(), ft.params()[i], "argumen " + std::to_string(i+1));
         }
     }
 
     if (varInfo.value) {
-        // Treat as dynamic call
-        llvm::Value* calleeVal = varInfo.value; // Already Any*
-        llvm::Value* argsArr = builder->CreateAlloca(anyType, builder->getInt32(expr->args.size()));
-        for (size_t i = 0; i < expr->args.size(); ++i) {
-            llvm::Value* argVal = generateExpr(expr->args[i].get()); 
-            llvm::Value* argObj = builder->CreateLoad(anyType, argVal);
-            llvm::Value* slot = builder->CreateGEP(anyType, argsArr, {builder->getInt32(i)});
-            builder->CreateStore(argObj, slot);
+        llvm::Value* calleeVal = varInfo.native ? visitVariableExpr(var) : varInfo.value; // Any*
+        std::vector<llvm::Value*> boxed, numbers;
+        generateCallArgs(expr, boxed, numbers);
+
+        auto direct = varInfo.function ? directEntries.find(varInfo.function) : directEntries.end();
+        if (direct == directEntries.end() || direct->second.params.size() != expr->args.size()) {
+            return emitDynamicCall(calleeVal, boxed);
         }
-        return createCallOrInvoke(module->getFunction("manifast_call_dynamic"), {calleeVal, argsArr, builder->getInt32(expr->args.size())});
+
+        // A `fungsi` declared in an enclosing function's frame cannot be read
+        // from here; calls to it always reach the declaration.
+        llvm::Function* parent = builder->GetInsertBlock()->getParent();
+        auto* slot = llvm::dyn_cast<llvm::AllocaInst>(varInfo.value);
+        if (slot && slot->getFunction() != parent) return emitDirectCall(direct->second, boxed, numbers);
+
+        // Still bound to the declared `fungsi`: call its typed entry directly
+        // (inlinable); otherwise it was reassigned and goes through the runtime.
+        llvm::BasicBlock* directBB = llvm::BasicBlock::Create(*context, "call.direct", parent);
+        llvm::BasicBlock* dynamicBB = llvm::BasicBlock::Create(*context, "call.dynamic", parent);
+        llvm::BasicBlock* mergeBB = llvm::BasicBlock::Create(*context, "call.cont", parent);
+        llvm::Value* bound = builder->CreateLoad(builder->getPtrTy(), builder->CreateStructGEP(anyType, calleeVal, 2));
+        builder->CreateCondBr(builder->CreateICmpEQ(bound, varInfo.function), directBB, dynamicBB);
+
+        builder->SetInsertPoint(directBB);
+        llvm::Value* directRes = emitDirectCall(direct->second, boxed, numbers);
+        llvm::BasicBlock* directEnd = builder->GetInsertBlock();
+        builder->CreateBr(mergeBB);
+
+        builder->SetInsertPoint(dynamicBB);
+        llvm::Value* dynamicRes = emitDynamicCall(calleeVal, boxed);
+        llvm::BasicBlock* dynamicEnd = builder->GetInsertBlock();
+        builder->CreateBr(mergeBB);
+
+        builder->SetInsertPoint(mergeBB);
+        llvm::PHINode* res = builder->CreatePHI(builder->getPtrTy(), 2, "call_res");
+        res->addIncoming(directRes, directEnd);
+        res->addIncoming(dynamicRes, dynamicEnd);
+        return res;
     }
 
     llvm::Function* func = nullptr;
@@ -1046,7 +1636,7 @@ llvm::Value* CodeGen::visitCallExpr(const CallExpr* expr) {
         if (expr->args.size() != 1) {
             throw manifast::RuntimeError("Runtime Error: len() membutuhkan 1 argumen");
         }
-        llvm::Value* arg = generateExpr(expr->args[0].get());
+        llvm::Value* arg = generateBorrowed(expr->args[0].get());
         llvm::Value* lenVal = createCallOrInvoke(module->getFunction("manifast_array_len"), {arg});
         return boxDouble(lenVal);
     } else {
@@ -1070,7 +1660,7 @@ llvm::Value* CodeGen::visitCallExpr(const CallExpr* expr) {
                     llvm::Value* tab = createString("\t");
                     createCallOrInvoke(module->getFunction("manifast_print_any"), {tab});
                 }
-                llvm::Value* argVal = generateExpr(expr->args[i].get());
+                llvm::Value* argVal = generateBorrowed(expr->args[i].get());
                 if (!argVal) return nullptr;
                 createCallOrInvoke(module->getFunction("manifast_print_any"), {argVal});
             }
@@ -1078,17 +1668,25 @@ llvm::Value* CodeGen::visitCallExpr(const CallExpr* expr) {
                 llvm::Value* nl = createString("\n");
                 createCallOrInvoke(module->getFunction("manifast_print_any"), {nl});
             }
-            return boxDouble(llvm::ConstantFP::get(*context, llvm::APFloat(0.0)));
+            return createNumber(0.0);
         }
 
         std::vector<llvm::Value*> argsV;
         for (const auto& arg : expr->args) {
-            llvm::Value* argVal = generateExpr(arg.get());
+            llvm::Value* argVal = generateBorrowed(arg.get()); // builtins only read their arguments
             if (!argVal) return nullptr;
             argsV.push_back(argVal);
         }
         return builder->CreateCall(func, argsV);
     } else {
+        // Calls by name always reach the declared function (recursion).
+        auto direct = directEntries.find(func);
+        if (direct != directEntries.end() && direct->second.params.size() == expr->args.size()) {
+            std::vector<llvm::Value*> boxed, numbers;
+            generateCallArgs(expr, boxed, numbers);
+            return emitDirectCall(direct->second, boxed, numbers);
+        }
+
         // JIT (Native Signature) Call: void (void* vm, Any* args, int nargs)
         // Result slot at argsArr[0], args start at argsArr[1]
         llvm::Value* argsArr = builder->CreateAlloca(anyType, builder->getInt32(expr->args.size() + 1));
@@ -1110,47 +1708,58 @@ llvm::Value* CodeGen::visitCallExpr(const CallExpr* expr) {
 }
 
 void CodeGen::visitVarDeclStmt(const VarDeclStmt* stmt) {
+    Type resolved = resolveType(stmt->typeAnnotation);
+    llvm::Type* native = nativeTypeFor(resolved);
+    int runtimeType = mapTypeToRuntime(stmt->typeAnnotation);
+
     if (scopes.size() == 1) { // Module-level Global
-        auto* gVar = new llvm::GlobalVariable(*module, anyType, false,
+        llvm::Type* slotTy = native ? native : anyType;
+        auto* gVar = new llvm::GlobalVariable(*module, slotTy, false,
                                              llvm::GlobalValue::InternalLinkage,
-                                             llvm::ConstantAggregateZero::get(anyType),
-                                             stmt->name);
-        
-        Type resolved = resolveType(stmt->typeAnnotation);
+                                             llvm::Constant::getNullValue(slotTy),
+                                             stmt->name.str());
 
         if (stmt->initializer) {
             enforceStaticType(stmt->initializer.get(), resolved, "variabel '" + stmt->name + "'");
-            llvm::Value* initVal = generateExpr(stmt->initializer.get());
-            if (initVal) {
+            if (native) {
+                llvm::Value* d = generateNumberChecked(stmt->initializer.get(), runtimeType);
+                if (d) builder->CreateStore(d, gVar);
+            } else if (llvm::Value* initVal = generateExpr(stmt->initializer.get())) {
                 // Type Check
-                int runtimeType = mapTypeToRuntime(stmt->typeAnnotation);
-                if (runtimeType != -1) {
+                if (uint32_t kind = packedArrayKind(resolved)) {
+                    createCallOrInvoke(module->getFunction("manifast_type_check_array"), {initVal, builder->getInt32(kind)});
+                } else if (runtimeType != -1) {
                     llvm::Function* checkFunc = module->getFunction("manifast_type_check");
                     createCallOrInvoke(checkFunc, {initVal, builder->getInt32(runtimeType)});
                 }
                 builder->CreateStore(builder->CreateLoad(anyType, initVal), gVar);
             }
         }
-        scopes.back()[stmt->name] = VarInfo(gVar, stmt->typeAnnotation);
+        scopes.back()[stmt->name] = VarInfo(gVar, stmt->typeAnnotation, native);
     } else {
         llvm::Function* func = builder->GetInsertBlock()->getParent();
         llvm::IRBuilder<> tmpBuilder(&func->getEntryBlock(), func->getEntryBlock().begin());
-        llvm::AllocaInst* alloca = tmpBuilder.CreateAlloca(anyType, nullptr, stmt->name);
+        llvm::AllocaInst* alloca = tmpBuilder.CreateAlloca(native ? native : anyType, nullptr, stmt->name.str());
         
-        scopes.back()[stmt->name] = VarInfo(alloca, stmt->typeAnnotation);
+        scopes.back()[stmt->name] = VarInfo(alloca, stmt->typeAnnotation, native);
         
         if (stmt->initializer) {
-            enforceStaticType(stmt->initializer.get(), resolveType(stmt->typeAnnotation), "variabel '" + stmt->name + "'");
-            llvm::Value* initVal = generateExpr(stmt->initializer.get());
-            if (initVal) {
+            enforceStaticType(stmt->initializer.get(), resolved, "variabel '" + stmt->name + "'");
+            if (native) {
+                llvm::Value* d = generateNumberChecked(stmt->initializer.get(), runtimeType);
+                if (d) builder->CreateStore(d, alloca);
+            } else if (llvm::Value* initVal = generateExpr(stmt->initializer.get())) {
                 // Type Check
-                int runtimeType = mapTypeToRuntime(stmt->typeAnnotation);
-                if (runtimeType != -1) {
+                if (uint32_t kind = packedArrayKind(resolved)) {
+                    createCallOrInvoke(module->getFunction("manifast_type_check_array"), {initVal, builder->getInt32(kind)});
+                } else if (runtimeType != -1) {
                     llvm::Function* checkFunc = module->getFunction("manifast_type_check");
                     createCallOrInvoke(checkFunc, {initVal, builder->getInt32(runtimeType)});
                 }
                 builder->CreateStore(builder->CreateLoad(anyType, initVal), alloca);
             }
+        } else if (native) {
+            builder->CreateStore(llvm::Constant::getNullValue(native), alloca);
         }
     }
 }
@@ -1163,23 +1772,21 @@ void CodeGen::visitReturnStmt(const ReturnStmt* stmt) {
         llvm::Value* val = generateExpr(stmt->value.get()); // Any*
         if (val) {
             if (isMain) {
-                builder->CreateRet(val);
+                builder->CreateRet(escapeToHeap(val));
             } else {
                 // Native: store in args[-1]
-                llvm::Value* argsPtr = func->getArg(1);
-                llvm::Value* resSlot = builder->CreateGEP(anyType, argsPtr, {builder->getInt32(-1)});
+                llvm::Value* resSlot = returnSlot(func);
                 llvm::Value* valObj = builder->CreateLoad(anyType, val);
                 builder->CreateStore(valObj, resSlot);
                 builder->CreateRetVoid();
             }
         }
     } else {
-        llvm::Value* retVal = boxDouble(llvm::ConstantFP::get(*context, llvm::APFloat(0.0)));
+        llvm::Value* retVal = createNumber(0.0);
         if (isMain) {
             builder->CreateRet(retVal);
         } else {
-            llvm::Value* argsPtr = func->getArg(1);
-            llvm::Value* resSlot = builder->CreateGEP(anyType, argsPtr, {builder->getInt32(-1)});
+            llvm::Value* resSlot = returnSlot(func);
             llvm::Value* nilObj = builder->CreateLoad(anyType, retVal); // retVal is 0.0 boxed
             builder->CreateStore(nilObj, resSlot);
             builder->CreateRetVoid();
@@ -1261,6 +1868,94 @@ void CodeGen::visitTryStmt(const TryStmt* stmt) {
     builder->SetInsertPoint(contBB);
 }
 
+void CodeGen::bindParameter(llvm::Function* func, const Parameter& param, size_t index) {
+    llvm::Value* argsPtr = func->getArg(1);
+    llvm::Value* slot = builder->CreateGEP(anyType, argsPtr, {builder->getInt32(index)});
+    llvm::Type* native = nativeTypeFor(param.type);
+
+    llvm::IRBuilder<> tmpBuilder(&func->getEntryBlock(), func->getEntryBlock().begin());
+    llvm::AllocaInst* alloca = tmpBuilder.CreateAlloca(native ? native : anyType, nullptr, param.name.str()); 
+
+    if (native) {
+        // Typed numeric parameter: check once on entry, then keep it unboxed
+        llvm::Function* checkFunc = module->getFunction("manifast_type_check");
+        createCallOrInvoke(checkFunc, {slot, builder->getInt32(mapTypeToRuntime(param.type))});
+        builder->CreateStore(unboxNumber(slot), alloca);
+    } else {
+        llvm::Value* loadedArg = builder->CreateLoad(anyType, slot);
+        builder->CreateStore(loadedArg, alloca);
+    }
+    
+    scopes.back()[param.name] = VarInfo(alloca, param.type, native); 
+}
+
+void CodeGen::bindDirectParameter(llvm::Function* func, const Parameter& param, size_t index) {
+    llvm::Value* arg = func->getArg(index + 1);
+    llvm::Type* native = nativeTypeFor(param.type);
+
+    llvm::IRBuilder<> tmpBuilder(&func->getEntryBlock(), func->getEntryBlock().begin());
+    llvm::AllocaInst* alloca = tmpBuilder.CreateAlloca(native ? native : anyType, nullptr, param.name.str());
+    // Typed numeric arguments arrive checked and unboxed; the rest by pointer
+    builder->CreateStore(native ? arg : builder->CreateLoad(anyType, arg), alloca);
+
+    scopes.back()[param.name] = VarInfo(alloca, param.type, native);
+}
+
+llvm::Value* CodeGen::returnSlot(llvm::Function* func) {
+    if (directBodies.count(func)) return func->getArg(0);
+    return builder->CreateGEP(anyType, func->getArg(1), {builder->getInt32(-1)});
+}
+
+void CodeGen::generateCallArgs(const CallExpr* expr, std::vector<llvm::Value*>& boxed, std::vector<llvm::Value*>& numbers) {
+    for (const auto& arg : expr->args) {
+        llvm::Value* number = nullptr;
+        llvm::Value* value = nullptr;
+        if (isStaticallyNumeric(arg.get())) {
+            number = generateNumber(arg.get());
+            if (number) value = boxNumberTemp(number);
+        } else {
+            value = generateExpr(arg.get());
+        }
+        if (!value) value = createNumber(0.0);
+        boxed.push_back(value);
+        numbers.push_back(number);
+    }
+}
+
+llvm::Value* CodeGen::emitDynamicCall(llvm::Value* callee, const std::vector<llvm::Value*>& boxed) {
+    llvm::Value* argsArr = builder->CreateAlloca(anyType, builder->getInt32(boxed.size()));
+    for (size_t i = 0; i < boxed.size(); ++i) {
+        llvm::Value* argObj = builder->CreateLoad(anyType, boxed[i]);
+        builder->CreateStore(argObj, builder->CreateGEP(anyType, argsArr, {builder->getInt32(i)}));
+    }
+    return createCallOrInvoke(module->getFunction("manifast_call_dynamic"), {callee, argsArr, builder->getInt32(boxed.size())});
+}
+
+llvm::Value* CodeGen::emitDirectCall(const DirectEntry& entry, const std::vector<llvm::Value*>& boxed,
+                                     const std::vector<llvm::Value*>& numbers) {
+    llvm::Function* parent = builder->GetInsertBlock()->getParent();
+    llvm::IRBuilder<> tmpBuilder(&parent->getEntryBlock(), parent->getEntryBlock().begin());
+    llvm::Value* result = tmpBuilder.CreateAlloca(anyType, nullptr, "direct_res");
+
+    std::vector<llvm::Value*> args{result};
+    for (size_t i = 0; i < entry.params.size(); i++) {
+        llvm::Type* native = nativeTypeFor(entry.params[i]);
+        if (!native) {
+            args.push_back(boxed[i]);
+            continue;
+        }
+        // The VM-ABI entry checks typed parameters; do the same before unboxing
+        llvm::Value* d = numbers[i];
+        if (!d) {
+            createCallOrInvoke(module->getFunction("manifast_type_check"), {boxed[i], builder->getInt32(mapTypeToRuntime(entry.params[i]))});
+            d = unboxNumber(boxed[i]);
+        }
+        args.push_back(d);
+    }
+    createCallOrInvoke(entry.function, args);
+    return result;
+}
+
 void CodeGen::visitFunctionStmt(const FunctionStmt* stmt) {
     // Signature: void (void* vm, Any* args, int nargs)
     llvm::Type* vmPtrTy = builder->getPtrTy();
@@ -1268,29 +1963,37 @@ void CodeGen::visitFunctionStmt(const FunctionStmt* stmt) {
     llvm::Type* nargsTy = builder->getInt32Ty();
 
     llvm::FunctionType* ft = llvm::FunctionType::get(builder->getVoidTy(), {vmPtrTy, argsPtrTy, nargsTy}, false);
-    llvm::Function* func = llvm::Function::Create(ft, llvm::Function::ExternalLinkage, stmt->name, module.get());
+    llvm::Function* func = llvm::Function::Create(ft, llvm::Function::ExternalLinkage, stmt->name.str(), module.get());
     func->addFnAttr("stack-probe-size", "1048576"); 
     func->addFnAttr("no-stack-arg-probe");
 
-    llvm::BasicBlock* bb = llvm::BasicBlock::Create(*context, "entry", func);
+    // The body goes into the typed direct entry: void (Any* result, params...)
+    DirectEntry entry;
+    std::vector<llvm::Type*> directParams{builder->getPtrTy()};
+    for (const auto& p : stmt->params) {
+        llvm::Type* native = nativeTypeFor(p.type);
+        directParams.push_back(native ? native : builder->getPtrTy());
+        entry.params.push_back(p.type);
+    }
+    llvm::FunctionType* directFT = llvm::FunctionType::get(builder->getVoidTy(), directParams, false);
+    entry.function = llvm::Function::Create(directFT, llvm::Function::InternalLinkage, stmt->name.str() + ".direct", module.get());
+    entry.function->addFnAttr("stack-probe-size", "1048576");
+    entry.function->addFnAttr("no-stack-arg-probe");
+    entry.function->getArg(0)->setName("result");
+    directEntries[func] = entry; // before the body, so recursive calls bind directly
+    applyCallProfile(func, stmt->name.str());
+    applyCallProfile(entry.function, stmt->name.str());
+    directBodies.insert(entry.function);
+
+    llvm::BasicBlock* bb = llvm::BasicBlock::Create(*context, "entry", entry.function);
     
     llvm::BasicBlock* oldBB = builder->GetInsertBlock();
     builder->SetInsertPoint(bb);
 
     pushScope();
     
-    // Extract parameters from args array
-    llvm::Value* argsPtr = func->getArg(1);
-    
     for (size_t i = 0; i < stmt->params.size(); i++) {
-        llvm::IRBuilder<> tmpBuilder(&func->getEntryBlock(), func->getEntryBlock().begin());
-        llvm::AllocaInst* alloca = tmpBuilder.CreateAlloca(anyType, nullptr, stmt->params[i].name); 
-        
-        llvm::Value* slot = builder->CreateGEP(anyType, argsPtr, {builder->getInt32(i)});
-        llvm::Value* loadedArg = builder->CreateLoad(anyType, slot);
-        builder->CreateStore(loadedArg, alloca);
-        
-        scopes.back()[stmt->params[i].name] = VarInfo(alloca, stmt->params[i].type); 
+        bindDirectParameter(entry.function, stmt->params[i], i);
     }
 
     // Body
@@ -1298,25 +2001,39 @@ void CodeGen::visitFunctionStmt(const FunctionStmt* stmt) {
     
     // Default return nil (Any*) if no return stmt
     if (!builder->GetInsertBlock()->getTerminator()) {
-        llvm::Value* retVal = boxDouble(llvm::ConstantFP::get(*context, llvm::APFloat(0.0)));
-        llvm::Value* argsPtr = func->getArg(1);
-        llvm::Value* resSlot = builder->CreateGEP(anyType, argsPtr, {builder->getInt32(-1)});
+        llvm::Value* retVal = createNumber(0.0);
         llvm::Value* nilObj = builder->CreateLoad(anyType, retVal);
-        builder->CreateStore(nilObj, resSlot);
+        builder->CreateStore(nilObj, returnSlot(entry.function));
         builder->CreateRetVoid();
     }
     
     popScope();
 
-    if (llvm::verifyFunction(*func, &llvm::errs())) {
-        std::cerr << "Function verification failed for " << stmt->name << "\n";
+    // VM-ABI body: extract parameters from the args array and forward
+    builder->SetInsertPoint(llvm::BasicBlock::Create(*context, "entry", func));
+    std::vector<llvm::Value*> forwarded{builder->CreateGEP(anyType, func->getArg(1), {builder->getInt32(-1)})};
+    for (size_t i = 0; i < stmt->params.size(); i++) {
+        llvm::Value* slot = builder->CreateGEP(anyType, func->getArg(1), {builder->getInt32(i)});
+        if (nativeTypeFor(stmt->params[i].type)) {
+            // Typed numeric parameter: checked once here, then passed unboxed
+            builder->CreateCall(module->getFunction("manifast_type_check"), {slot, builder->getInt32(mapTypeToRuntime(stmt->params[i].type))});
+            forwarded.push_back(unboxNumber(slot));
+        } else {
+            forwarded.push_back(slot);
+        }
+    }
+    builder->CreateCall(entry.function, forwarded);
+    builder->CreateRetVoid();
+
+    if (llvm::verifyFunction(*entry.function, &llvm::errs()) || llvm::verifyFunction(*func, &llvm::errs())) {
+        std::cerr << "Function verification failed for " << stmt->name.str() << "\n";
     }
     
     if (oldBB) {
         builder->SetInsertPoint(oldBB);
         
         // Hoist function into the current scope
-        llvm::Value* alloca = builder->CreateAlloca(anyType, nullptr, stmt->name);
+        llvm::Value* alloca = builder->CreateAlloca(anyType, nullptr, stmt->name.str());
         llvm::Value* typeSlot = builder->CreateStructGEP(anyType, alloca, 0);
         builder->CreateStore(builder->getInt32(4), typeSlot); // ANY_NATIVE = 4
 
@@ -1329,21 +2046,24 @@ void CodeGen::visitFunctionStmt(const FunctionStmt* stmt) {
         llvm::Value* funcPtr = builder->CreateBitOrPointerCast(func, builder->getPtrTy());
         builder->CreateStore(funcPtr, ptrSlot);
 
-        Type funcType(TypeKind::Function);
-        for (const auto& p : stmt->params) funcType.params.push_back(p.type);
-        funcType.returnType = std::make_shared<Type>(stmt->returnType);
-        scopes.back()[stmt->name] = VarInfo(alloca, std::move(funcType));
+        std::vector<Type> paramTypes;
+        for (const auto& p : stmt->params) paramTypes.push_back(p.type);
+        VarInfo info(alloca, Type::makeFunction(std::move(paramTypes), stmt->returnType));
+        info.function = func;
+        scopes.back()[stmt->name] = info;
     }
 }
 
 llvm::Value* CodeGen::visitFunctionExpr(const FunctionExpr* expr) {
-    std::string anonName = "anon_fn_" + std::to_string(reinterpret_cast<uintptr_t>(expr));
+    // Numbered in source order: the name must be the same on every run of the
+    // same script, or cached objects would define the wrong symbols
+    std::string anonName = "anon_fn_" + std::to_string(anonFunctions++);
     llvm::Type* vmPtrTy = builder->getPtrTy();
     llvm::Type* argsPtrTy = builder->getPtrTy();
     llvm::Type* nargsTy = builder->getInt32Ty();
 
     llvm::FunctionType* ft = llvm::FunctionType::get(builder->getVoidTy(), {vmPtrTy, argsPtrTy, nargsTy}, false);
-    llvm::Function* func = llvm::Function::Create(ft, llvm::Function::ExternalLinkage, anonName, module.get());
+    llvm::Function* func = llvm::Function::Create(ft, llvm::Function::InternalLinkage, anonName, module.get());
     func->addFnAttr("stack-probe-size", "1048576"); 
     func->addFnAttr("no-stack-arg-probe");
 
@@ -1352,23 +2072,14 @@ llvm::Value* CodeGen::visitFunctionExpr(const FunctionExpr* expr) {
     builder->SetInsertPoint(bb);
 
     pushScope();
-    llvm::Value* argsPtr = func->getArg(1);
-    
     for (size_t i = 0; i < expr->params.size(); i++) {
-        llvm::IRBuilder<> tmpBuilder(&func->getEntryBlock(), func->getEntryBlock().begin());
-        llvm::AllocaInst* alloca = tmpBuilder.CreateAlloca(anyType, nullptr, expr->params[i].name); 
-        
-        llvm::Value* slot = builder->CreateGEP(anyType, argsPtr, {builder->getInt32(i)});
-        llvm::Value* loadedArg = builder->CreateLoad(anyType, slot);
-        builder->CreateStore(loadedArg, alloca);
-        
-        scopes.back()[expr->params[i].name] = VarInfo(alloca, expr->params[i].type);
+        bindParameter(func, expr->params[i], i);
     }
 
     generateStmt(expr->body.get());
     
     if (!builder->GetInsertBlock()->getTerminator()) {
-        llvm::Value* retVal = boxDouble(llvm::ConstantFP::get(*context, llvm::APFloat(0.0)));
+        llvm::Value* retVal = createNumber(0.0);
         llvm::Value* argsPtr = func->getArg(1);
         llvm::Value* resSlot = builder->CreateGEP(anyType, argsPtr, {builder->getInt32(-1)});
         llvm::Value* nilObj = builder->CreateLoad(anyType, retVal);
@@ -1439,23 +2150,40 @@ llvm::Value* CodeGen::visitStringExpr(const StringExpr* expr) {
 }
 
 llvm::Value* CodeGen::visitIndexExpr(const IndexExpr* expr) {
-    llvm::Value* obj = generateExpr(expr->object.get());
-    llvm::Value* idx = generateExpr(expr->index.get());
-    if (!obj || !idx) return nullptr;
+    llvm::Value* obj = generateBorrowed(expr->object.get());
+    if (!obj) return nullptr;
 
-    // idx is Any*, we need the double value
-    llvm::Value* idxVal = unboxNumber(idx);
+    llvm::Value* res = nullptr;
+    if (isStaticallyNumeric(expr->index.get())) {
+        // Index as a plain double; loop counters never get boxed here
+        llvm::Value* idxVal = generateNumber(expr->index.get());
+        if (!idxVal) return nullptr;
 
-    llvm::Function* func = module->getFunction("manifast_array_get");
-    if (!func) {
-        llvm::FunctionType* ft = llvm::FunctionType::get(builder->getPtrTy(), {builder->getPtrTy(), builder->getDoubleTy()}, false);
-        func = llvm::Function::Create(ft, llvm::Function::ExternalLinkage, "manifast_array_get", module.get());
+        llvm::Function* func = module->getFunction("manifast_array_get");
+        if (!func) {
+            llvm::FunctionType* ft = llvm::FunctionType::get(builder->getPtrTy(), {builder->getPtrTy(), builder->getDoubleTy()}, false);
+            func = llvm::Function::Create(ft, llvm::Function::ExternalLinkage, "manifast_array_get", module.get());
+        }
+        // Packed arrays hand back a scratch slot that the next read reuses
+        res = createCallOrInvoke(func, {obj, idxVal}, "index_res");
+    } else {
+        // Could be a string key: the runtime dispatches on the object's type
+        llvm::Value* key = generateExpr(expr->index.get());
+        if (!key) return nullptr;
+        llvm::Function* func = module->getFunction("manifast_index_get");
+        if (!func) {
+            llvm::FunctionType* ft = llvm::FunctionType::get(builder->getPtrTy(), {builder->getPtrTy(), builder->getPtrTy()}, false);
+            func = llvm::Function::Create(ft, llvm::Function::ExternalLinkage, "manifast_index_get", module.get());
+        }
+        res = createCallOrInvoke(func, {obj, key}, "index_res");
     }
-    return createCallOrInvoke(func, {obj, idxVal}, "index_res");
+    llvm::Value* temp = createEntryAlloca(anyType, "index_val");
+    builder->CreateStore(builder->CreateLoad(anyType, res), temp);
+    return temp;
 }
 
 llvm::Value* CodeGen::visitGetExpr(const GetExpr* expr) {
-    llvm::Value* obj = generateExpr(expr->object.get());
+    llvm::Value* obj = generateBorrowed(expr->object.get());
     if (!obj) return nullptr;
 
     llvm::Function* func = module->getFunction("manifast_object_get");
@@ -1463,7 +2191,7 @@ llvm::Value* CodeGen::visitGetExpr(const GetExpr* expr) {
         llvm::FunctionType* ft = llvm::FunctionType::get(builder->getPtrTy(), {builder->getPtrTy(), builder->getPtrTy()}, false);
         func = llvm::Function::Create(ft, llvm::Function::ExternalLinkage, "manifast_object_get", module.get());
     }
-    llvm::Value* keyStr = builder->CreateGlobalString(expr->name);
+    llvm::Value* keyStr = builder->CreateGlobalString(expr->name.str());
     return createCallOrInvoke(func, {obj, keyStr}, "get_res");
 }
 
@@ -1474,13 +2202,13 @@ void CodeGen::visitClassStmt(const ClassStmt* stmt) {
         createClassFunc = llvm::Function::Create(ft, llvm::Function::ExternalLinkage, "manifast_create_class", module.get());
     }
     
-    llvm::Value* classNameStr = builder->CreateGlobalString(stmt->name);
+    llvm::Value* classNameStr = builder->CreateGlobalString(stmt->name.str());
     llvm::Value* klassAny = createCallOrInvoke(createClassFunc, {classNameStr});
     
     // Define class in scope
     llvm::Function* currentFunc = builder->GetInsertBlock()->getParent();
     llvm::IRBuilder<> tmpBuilder(&currentFunc->getEntryBlock(), currentFunc->getEntryBlock().begin());
-    llvm::AllocaInst* alloca = tmpBuilder.CreateAlloca(anyType, nullptr, stmt->name);
+    llvm::AllocaInst* alloca = tmpBuilder.CreateAlloca(anyType, nullptr, stmt->name.str());
     scopes.back()[stmt->name] = VarInfo(alloca, Type(TypeKind::Any));
     
     llvm::Value* loadedKlass = builder->CreateLoad(anyType, klassAny);
@@ -1519,8 +2247,9 @@ Type CodeGen::resolveType(const Type& type) {
     
     // Scoped lookup for alias
     for (auto it = typeAliases.rbegin(); it != typeAliases.rend(); ++it) {
-        if (it->find(type.aliasName) != it->end()) {
-            return resolveType((*it).at(type.aliasName)); // Recursive resolution
+        auto found = it->find(type.aliasSymbol());
+        if (found != it->end()) {
+            return resolveType(found->second); // Recursive resolution
         }
     }
     
@@ -1529,6 +2258,7 @@ Type CodeGen::resolveType(const Type& type) {
 }
 
 void CodeGen::enforceStaticType(const Expr* expr, const Type& expected, const std::string& context) {
+    if (!expr) return;
     Type resolved = resolveType(expected);
     if (resolved.kind == TypeKind::Any) return;
 
@@ -1550,8 +2280,8 @@ void CodeGen::enforceStaticType(const Expr* expr, const Type& expected, const st
     std::string prefix = context.empty() ? "" : (context + " ");
 
     if (resolved.kind == TypeKind::Struct) {
-        if (auto* objExpr = dynamic_cast<const ObjectExpr*>(expr)) {
-            for (const auto& field : resolved.fields) {
+        if (auto* objExpr = nodeAs<ObjectExpr>(expr)) {
+            for (const auto& field : resolved.fields()) {
                 bool found = false;
                 for (const auto& prop : objExpr->entries) {
                     if (prop.first == field.name) {
@@ -1570,11 +2300,14 @@ void CodeGen::enforceStaticType(const Expr* expr, const Type& expected, const st
     } else {
         std::string actualName = "";
 
-        if (dynamic_cast<const NumberExpr*>(expr)) actualName = "angka";
-        else if (dynamic_cast<const StringExpr*>(expr)) actualName = "string";
-        else if (dynamic_cast<const BoolExpr*>(expr)) actualName = "boolean";
-        else if (dynamic_cast<const ArrayExpr*>(expr)) actualName = "array";
-        else if (dynamic_cast<const ObjectExpr*>(expr)) actualName = "objek";
+        switch (expr->kind) {
+            case NodeKind::Number: actualName = "angka"; break;
+            case NodeKind::String: actualName = "string"; break;
+            case NodeKind::Bool:   actualName = "boolean"; break;
+            case NodeKind::Array:  actualName = "array"; break;
+            case NodeKind::Object: actualName = "objek"; break;
+            default: break;
+        }
 
         if (!actualName.empty()) {
             if (actualName != expectedName) {
@@ -10,19 +10,31 @@ namespace vm {
 Compiler::Compiler() : nextReg(0), scopeDepth(0), currentChunk(nullptr) {}
 
 bool Compiler::compile(const std::vector<std::unique_ptr<Stmt>>& statements, Chunk& chunk, const std::string& name) {
+    begin(chunk, name);
+    for (const auto& stmt : statements) {
+        compileTopLevel(stmt.get());
+    }
+    finish();
+    return true;
+}
+
+void Compiler::begin(Chunk& chunk, const std::string& name) {
     chunk.name = name;
     currentChunk = &chunk;
     nextReg = 0;
     locals.clear();
+    nameConstants.clear();
+    numberConstants.clear();
     scopeDepth = 0;
-    
-    for (const auto& stmt : statements) {
-        compile(stmt.get());
-    }
-    
+}
+
+void Compiler::compileTopLevel(Stmt* stmt) {
+    compile(stmt);
+}
+
+void Compiler::finish() {
     // Emit return 0 at end
     emit(createABC(OpCode::RETURN, 0, 1, 0)); 
-    return true;
 }
 
 // Helpers
@@ -39,11 +51,43 @@ void Compiler::freeReg() {
     nextReg--;
 }
 
+int Compiler::emitABx(OpCode op, int a, int bx, int line, int offset) {
+    if (bx < MAXARG_Bx) return emit(createABx(op, a, bx), line, offset);
+    int pc = emit(createABx(op, a, MAXARG_Bx), line, offset);
+    emit((Instruction)bx, line, offset);
+    return pc;
+}
+
 int Compiler::makeConstant(Any value) {
     return currentChunk->addConstant(value);
 }
 
-int Compiler::resolveLocal(const std::string& name) {
+int Compiler::nameConstant(Symbol name) {
+    auto it = nameConstants.find(name);
+    if (it != nameConstants.end()) return it->second;
+    int k = makeConstant({1, 0.0, mf_strdup(name.c_str())});
+    nameConstants.emplace(name, k);
+    return k;
+}
+
+int Compiler::numberConstant(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof bits);
+    auto it = numberConstants.find(bits);
+    if (it != numberConstants.end()) return it->second;
+    int k = makeConstant({0, value, nullptr});
+    numberConstants.emplace(bits, k);
+    return k;
+}
+
+int Compiler::constantOperand(int k) {
+    if (k <= MAXINDEXRK) return k + 256;
+    int r = allocReg();
+    emitABx(OpCode::LOADK, r, k);
+    return r;
+}
+
+int Compiler::resolveLocal(Symbol name) {
     for (int i = (int)locals.size() - 1; i >= 0; i--) {
         if (locals[i].name == name) {
             return locals[i].reg;
@@ -72,11 +116,16 @@ void Compiler::endScope() {
 // Dispatch
 
 void Compiler::compile(Stmt* stmt) {
-    if (auto* s = dynamic_cast<ExprStmt*>(stmt)) {
+    if (!stmt) return; // left behind by a syntax error
+    switch (stmt->kind) {
+    case NodeKind::ExprStmt: {
+        auto* s = static_cast<ExprStmt*>(stmt);
         int r = compile(s->expression.get());
         freeReg(); // Statement expression result discarded
+        break;
     }
-    else if (auto* s = dynamic_cast<VarDeclStmt*>(stmt)) {
+    case NodeKind::VarDecl: {
+        auto* s = static_cast<VarDeclStmt*>(stmt);
         // Top-level variables in main script (where name is empty) should be globals 
         // if they are at scope 0, so functions can see them.
         // This matches JIT behavior.
@@ -92,11 +141,11 @@ void Compiler::compile(Stmt* stmt) {
 
             // Match locals/JIT: enforce annotations on top-level globals too
             if (s->typeAnnotation.kind != TypeKind::Any) {
-                emitTypeCheck(valReg, s->typeAnnotation, s->line, s->offset);
+                emitTypeCheck(valReg, s->typeAnnotation, s->line, s->offset, true);
             }
 
-            int kName = makeConstant({1, 0.0, mf_strdup(s->name.c_str())});
-            emit(createABx(OpCode::SETGLOBAL, valReg, kName), s->line, s->offset);
+            int kName = nameConstant(s->name);
+            emitABx(OpCode::SETGLOBAL, valReg, kName, s->line, s->offset);
             freeReg();
         } else {
             int reg = allocReg(); 
@@ -110,20 +159,24 @@ void Compiler::compile(Stmt* stmt) {
             
             // Emit TYPE_CHECK if annotation is present
             if (s->typeAnnotation.kind != TypeKind::Any) {
-                emitTypeCheck(reg, s->typeAnnotation, s->line, s->offset);
+                emitTypeCheck(reg, s->typeAnnotation, s->line, s->offset, true);
             }
             
             locals.push_back({s->name, scopeDepth, reg});
         }
+        break;
     }
-    else if (auto* s = dynamic_cast<BlockStmt*>(stmt)) {
+    case NodeKind::Block: {
+        auto* s = static_cast<BlockStmt*>(stmt);
         beginScope();
         for (auto& st : s->statements) {
             compile(st.get());
         }
         endScope();
+        break;
     }
-    else if (auto* s = dynamic_cast<IfStmt*>(stmt)) {
+    case NodeKind::If: {
+        auto* s = static_cast<IfStmt*>(stmt);
         int condReg = compile(s->condition.get());
         
         // We want to skip JMP if condReg is true (C=0)
@@ -154,8 +207,10 @@ void Compiler::compile(Stmt* stmt) {
         }
         
         freeReg();
+        break;
     }
-    else if (auto* s = dynamic_cast<WhileStmt*>(stmt)) {
+    case NodeKind::While: {
+        auto* s = static_cast<WhileStmt*>(stmt);
         int startPos = (int)currentChunk->code.size();
         int condReg = compile(s->condition.get());
         
@@ -175,8 +230,10 @@ void Compiler::compile(Stmt* stmt) {
         currentChunk->code[jmpEndIdx] = createAsBx(OpCode::JMP, 0, endPos - bodyStart);
         
         freeReg();
+        break;
     }
-    else if (auto* s = dynamic_cast<ForStmt*>(stmt)) {
+    case NodeKind::For: {
+        auto* s = static_cast<ForStmt*>(stmt);
         // Snapshot so nested for-loops cannot permanently reclaim outer temps
         // (endScope + freeReg LIFO was clobbering parent loop end/step registers).
         const int baseReg = nextReg;
@@ -198,14 +255,14 @@ void Compiler::compile(Stmt* stmt) {
         if (s->step) {
             rStep = compile(s->step.get());
         } else {
-            int k1 = makeConstant({0, 1.0, nullptr});
+            int k1 = numberConstant(1.0);
             rStep = allocReg();
-            emit(createABx(OpCode::LOADK, rStep, k1), s->line, s->offset);
+            emitABx(OpCode::LOADK, rStep, k1, s->line, s->offset);
         }
 
-        int k0 = makeConstant({0, 0.0, nullptr});
+        int k0 = numberConstant(0.0);
         int rZero = allocReg();
-        emit(createABx(OpCode::LOADK, rZero, k0), s->line, s->offset);
+        emitABx(OpCode::LOADK, rZero, k0, s->line, s->offset);
 
         int loopTop = (int)currentChunk->code.size();
 
@@ -233,12 +290,14 @@ void Compiler::compile(Stmt* stmt) {
         // the register watermark so nested loops never steal outer end/step regs.
         endScope();
         nextReg = baseReg;
+        break;
     }
-    else if (auto* s = dynamic_cast<FunctionStmt*>(stmt)) {
+    case NodeKind::FunctionDecl: {
+        auto* s = static_cast<FunctionStmt*>(stmt);
         Chunk* funcChunk = compileFunctionBody(s->params, s->body.get(), s->name);
         
         // Define as global
-        int kName = makeConstant({1, 0.0, mf_strdup(s->name.c_str())}); // Type 1: String
+        int kName = nameConstant(s->name); // Type 1: String
         
         // Create function object
         Any funcVal;
@@ -248,20 +307,26 @@ void Compiler::compile(Stmt* stmt) {
         
         int kFunc = makeConstant(funcVal);
         int r = allocReg();
-        emit(createABx(OpCode::LOADK, r, kFunc));
-        emit(createABx(OpCode::SETGLOBAL, r, kName));
+        emitABx(OpCode::LOADK, r, kFunc);
+        emitABx(OpCode::SETGLOBAL, r, kName);
         freeReg();
+        break;
     }
-    else if (auto* s = dynamic_cast<ClassStmt*>(stmt)) {
+    case NodeKind::Class: {
+        auto* s = static_cast<ClassStmt*>(stmt);
         int r = compileClass(s);
         freeReg(); // free the class object if it's just a statement?
         // Actually, classes are usually stored in a variable by the identifier name.
+        break;
     }
-    else if (auto* s = dynamic_cast<TypeAliasStmt*>(stmt)) {
+    case NodeKind::TypeAlias: {
+        auto* s = static_cast<TypeAliasStmt*>(stmt);
         // Register the type alias for compile-time resolution
         typeAliases[s->name] = s->type;
+        break;
     }
-    else if (auto* s = dynamic_cast<ReturnStmt*>(stmt)) {
+    case NodeKind::Return: {
+        auto* s = static_cast<ReturnStmt*>(stmt);
         if (s->value) {
             int r = compile(s->value.get());
             emit(createABC(OpCode::RETURN, r, 2, 0), s->line, s->offset); // Return 1 result
@@ -269,6 +334,10 @@ void Compiler::compile(Stmt* stmt) {
         } else {
             emit(createABC(OpCode::RETURN, 0, 1, 0), s->line, s->offset); // Return 0 results (nil)
         }
+        break;
+    }
+    default:
+        break;
     }
 }
 
@@ -289,7 +358,7 @@ Chunk* Compiler::compileFunctionBody(const std::vector<Parameter>& params, Stmt*
     for (int pi = 0; pi < (int)params.size(); pi++) {
         sub.emitTypeCheck(pi, params[pi].type, params[pi].line, params[pi].offset);
     }
-    if (auto* b = dynamic_cast<BlockStmt*>(body)) {
+    if (auto* b = nodeAs<BlockStmt>(body)) {
         for (const auto& s : b->statements) {
             sub.compile(s.get());
         }
@@ -308,8 +377,8 @@ Chunk* Compiler::compileFunctionBody(const std::vector<Parameter>& params, Stmt*
 
 int Compiler::compileClass(ClassStmt* stmt) {
     int r = allocReg();
-    int kName = makeConstant({1, 0.0, mf_strdup(stmt->name.c_str())});
-    emit(createABx(OpCode::NEWCLASS, r, kName));
+    int kName = nameConstant(stmt->name);
+    emitABx(OpCode::NEWCLASS, r, kName);
     
     // Current approach: classes are just collections of functions
     for (auto& method : stmt->methods) {
@@ -320,27 +389,35 @@ int Compiler::compileClass(ClassStmt* stmt) {
         }
         Chunk* mChunk = compileFunctionBody(params, method->body.get(), stmt->name + "." + method->name);
         int kMethod = makeConstant({5, 0.0, mChunk}); // 5=Bytecode/Function
-        int kMethodName = makeConstant({1, 0.0, mf_strdup(method->name.c_str())});
+        int kMethodName = nameConstant(method->name);
         
         // Use SETTABLE R(A)[K(B)] = RK(C)
-        emit(createABC(OpCode::SETTABLE, r, kMethodName + 256, kMethod + 256));
+        int key = constantOperand(kMethodName);
+        int val = constantOperand(kMethod);
+        emit(createABC(OpCode::SETTABLE, r, key, val));
+        if (val < 256) freeReg();
+        if (key < 256) freeReg();
     }
     
     // Store class in global variable
-    int kClassName = makeConstant({1, 0.0, mf_strdup(stmt->name.c_str())});
-    emit(createABx(OpCode::SETGLOBAL, r, kClassName));
+    int kClassName = nameConstant(stmt->name);
+    emitABx(OpCode::SETGLOBAL, r, kClassName);
     
     return r;
 }
 
 int Compiler::compile(Expr* expr) {
-    if (auto* e = dynamic_cast<NumberExpr*>(expr)) {
+    if (!expr) return allocReg();
+    switch (expr->kind) {
+    case NodeKind::Number: {
+        auto* e = static_cast<NumberExpr*>(expr);
         int r = allocReg();
-        int k = makeConstant({0, e->value, nullptr});
-        emit(createABx(OpCode::LOADK, r, k), e->line, e->offset);
+        int k = numberConstant(e->value);
+        emitABx(OpCode::LOADK, r, k, e->line, e->offset);
         return r;
     }
-    else if (auto* e = dynamic_cast<StringExpr*>(expr)) {
+    case NodeKind::String: {
+        auto* e = static_cast<StringExpr*>(expr);
         int r = allocReg();
         std::string val = e->value;
         std::string processed;
@@ -361,20 +438,22 @@ int Compiler::compile(Expr* expr) {
             }
         }
         int k = makeConstant({1, 0.0, mf_strdup(processed.c_str())}); 
-        emit(createABx(OpCode::LOADK, r, k), e->line, e->offset);
+        emitABx(OpCode::LOADK, r, k, e->line, e->offset);
         return r;
     }
-    else if (auto* e = dynamic_cast<BoolExpr*>(expr)) {
+    case NodeKind::Bool: {
+        auto* e = static_cast<BoolExpr*>(expr);
         int r = allocReg();
         emit(createABC(OpCode::LOADBOOL, r, e->value ? 1 : 0, 0), e->line, e->offset);
         return r;
     }
-    else if (dynamic_cast<NilExpr*>(expr)) {
+    case NodeKind::Nil: {
         int r = allocReg();
         emit(createABC(OpCode::LOADNIL, r, 0, 0), expr->line, expr->offset);
         return r;
     }
-    else if (auto* e = dynamic_cast<UnaryExpr*>(expr)) {
+    case NodeKind::Unary: {
+        auto* e = static_cast<UnaryExpr*>(expr);
         int right = compile(e->right.get());
         OpCode op = OpCode::NOT;
         if (e->op == TokenType::Minus) {
@@ -389,7 +468,8 @@ int Compiler::compile(Expr* expr) {
         emit(createABC(op, right, right, 0), e->line, e->offset);
         return right;
     }
-    else if (auto* e = dynamic_cast<BinaryExpr*>(expr)) {
+    case NodeKind::Binary: {
+        auto* e = static_cast<BinaryExpr*>(expr);
         if (e->op == TokenType::K_And || e->op == TokenType::K_Or) {
             int left = compile(e->left.get());
             
@@ -446,8 +526,9 @@ int Compiler::compile(Expr* expr) {
         freeReg(); // Free right
         return left;
     }
-    else if (auto* e = dynamic_cast<AssignExpr*>(expr)) {
-        if (auto* v = dynamic_cast<VariableExpr*>(e->target.get())) {
+    case NodeKind::Assign: {
+        auto* e = static_cast<AssignExpr*>(expr);
+        if (auto* v = nodeAs<VariableExpr>(e->target.get())) {
             int valReg = compile(e->value.get());
             int local = resolveLocal(v->name);
             
@@ -457,8 +538,8 @@ int Compiler::compile(Expr* expr) {
                 if (local != -1) {
                     emit(createABC(OpCode::MOVE, targetReg, local, 0), e->line, e->offset);
                 } else {
-                    int k = makeConstant({1, 0.0, mf_strdup(v->name.c_str())});
-                    emit(createABx(OpCode::GETGLOBAL, targetReg, k), e->line, e->offset);
+                    int k = nameConstant(v->name);
+                    emitABx(OpCode::GETGLOBAL, targetReg, k, e->line, e->offset);
                 }
                 
                 OpCode op = OpCode::ADD;
@@ -480,11 +561,11 @@ int Compiler::compile(Expr* expr) {
                 freeReg();
                 return local;
             } else {
-                int k = makeConstant({1, 0.0, mf_strdup(v->name.c_str())});
-                emit(createABx(OpCode::SETGLOBAL, valReg, k), e->line, e->offset);
+                int k = nameConstant(v->name);
+                emitABx(OpCode::SETGLOBAL, valReg, k, e->line, e->offset);
                 return valReg;
             }
-        } else if (auto* idx = dynamic_cast<IndexExpr*>(e->target.get())) {
+        } else if (auto* idx = nodeAs<IndexExpr>(e->target.get())) {
             int objReg = compile(idx->object.get());
             int keyReg = compile(idx->index.get());
             int valReg = compile(e->value.get());
@@ -509,14 +590,14 @@ int Compiler::compile(Expr* expr) {
             emit(createABC(OpCode::SETTABLE, objReg, keyReg, valReg));
             nextReg -= 2; // free key and value
             return valReg;
-        } else if (auto* get = dynamic_cast<GetExpr*>(e->target.get())) {
+        } else if (auto* get = nodeAs<GetExpr>(e->target.get())) {
             int objReg = compile(get->object.get());
-            int kKey = makeConstant({1, 0.0, mf_strdup(get->name.c_str())});
+            int key = constantOperand(nameConstant(get->name));
             int valReg = compile(e->value.get());
             
             if (e->op != TokenType::Equal) {
                 int targetReg = allocReg();
-                emit(createABC(OpCode::GETTABLE, targetReg, objReg, kKey + 256), e->line, e->offset);
+                emit(createABC(OpCode::GETTABLE, targetReg, objReg, key), e->line, e->offset);
                 OpCode op = OpCode::ADD;
                 switch (e->op) {
                     case TokenType::PlusEqual: op = OpCode::ADD; break;
@@ -531,22 +612,26 @@ int Compiler::compile(Expr* expr) {
                 valReg = targetReg;
             }
             
-            emit(createABC(OpCode::SETTABLE, objReg, kKey + 256, valReg), e->line, e->offset);
+            emit(createABC(OpCode::SETTABLE, objReg, key, valReg), e->line, e->offset);
             freeReg(); // free value
+            if (key < 256) freeReg();
             return valReg;
         }
         return allocReg();
     }
-    else if (auto* e = dynamic_cast<GetExpr*>(expr)) {
+    case NodeKind::Get: {
+        auto* e = static_cast<GetExpr*>(expr);
         int objReg = compile(e->object.get());
-        int kKey = makeConstant({1, 0.0, mf_strdup(e->name.c_str())});
+        int key = constantOperand(nameConstant(e->name));
         // Result goes into objReg (reuse it)
-        emit(createABC(OpCode::GETTABLE, objReg, objReg, kKey + 256));
+        emit(createABC(OpCode::GETTABLE, objReg, objReg, key));
+        if (key < 256) freeReg();
         return objReg;
     }
-    else if (auto* e = dynamic_cast<IndexExpr*>(expr)) {
+    case NodeKind::Index: {
+        auto* e = static_cast<IndexExpr*>(expr);
         int objReg = compile(e->object.get());
-        if (auto* slice = dynamic_cast<SliceExpr*>(e->index.get())) {
+        if (auto* slice = nodeAs<SliceExpr>(e->index.get())) {
             int startReg = slice->start ? compile(slice->start.get()) : -1;
             int endReg = slice->end ? compile(slice->end.get()) : -1;
             
@@ -555,8 +640,8 @@ int Compiler::compile(Expr* expr) {
             // My OpCode.h says: GETSLICE,   // R(A) := R(B)[RK(C):RK(D)]
             // If start/end is null, we can use a special constant (nil or -1).
             
-            int sVal = (startReg == -1) ? makeConstant({3, 0.0, nullptr}) + 256 : startReg;
-            int eVal = (endReg == -1) ? makeConstant({3, 0.0, nullptr}) + 256 : endReg;
+            int sVal = (startReg == -1) ? constantOperand(makeConstant({3, 0.0, nullptr})) : startReg;
+            int eVal = (endReg == -1) ? constantOperand(makeConstant({3, 0.0, nullptr})) : endReg;
             
             emit(createABC(OpCode::GETSLICE, objReg, objReg, sVal));
             // Wait, GETSLICE needs 4 operands? A, B, C, D.
@@ -567,6 +652,8 @@ int Compiler::compile(Expr* expr) {
             // I'll emitEnd(eVal) as the next instruction?
             emit(eVal); 
             
+            if (endReg == -1 && eVal < 256) freeReg();
+            if (startReg == -1 && sVal < 256) freeReg();
             if (endReg != -1) freeReg();
             if (startReg != -1) freeReg();
             return objReg;
@@ -578,48 +665,70 @@ int Compiler::compile(Expr* expr) {
             return objReg;
         }
     }
-    else if (auto* e = dynamic_cast<ArrayExpr*>(expr)) {
+    case NodeKind::Array: {
+        auto* e = static_cast<ArrayExpr*>(expr);
         int r = allocReg();
-        emit(createABC(OpCode::NEWARRAY, r, (int)e->elements.size(), 0));
-        for (int i = 0; i < (int)e->elements.size(); i++) {
+        int count = (int)e->elements.size();
+        emit(createABC(OpCode::NEWARRAY, r, count, 0));
+        // Flush every LFIELDS_PER_FLUSH elements so large literals never run
+        // out of registers.
+        int pending = 0;
+        int batch = 1;
+        for (int i = 0; i < count; i++) {
             compile(e->elements[i].get()); // evaluates into nextReg
-        }
-        if (!e->elements.empty()) {
-            emit(createABC(OpCode::SETLIST, r, (int)e->elements.size(), 1));
-            nextReg -= (int)e->elements.size();
+            if (++pending == LFIELDS_PER_FLUSH || i == count - 1) {
+                if (batch <= 0x1FF) {
+                    emit(createABC(OpCode::SETLIST, r, pending, batch));
+                } else {
+                    emit(createABC(OpCode::SETLIST, r, pending, 0));
+                    emit((Instruction)batch);
+                }
+                nextReg -= pending;
+                pending = 0;
+                batch++;
+            }
         }
         return r;
     }
-    else if (auto* e = dynamic_cast<ObjectExpr*>(expr)) {
+    case NodeKind::Object: {
+        auto* e = static_cast<ObjectExpr*>(expr);
         int r = allocReg();
         emit(createABC(OpCode::NEWTABLE, r, 0, 0));
         for (auto& entry : e->entries) {
-            int kKey = makeConstant({1, 0.0, mf_strdup(entry.first.c_str())});
+            int key = constantOperand(nameConstant(entry.first));
             int valReg = compile(entry.second.get());
-            emit(createABC(OpCode::SETTABLE, r, kKey + 256, valReg));
+            emit(createABC(OpCode::SETTABLE, r, key, valReg));
             freeReg();
+            if (key < 256) freeReg();
         }
         return r;
     }
-    else if (auto* e = dynamic_cast<VariableExpr*>(expr)) {
+    case NodeKind::Variable: {
+        auto* e = static_cast<VariableExpr*>(expr);
         int local = resolveLocal(e->name);
         int r = allocReg();
         if (local != -1) {
             emit(createABC(OpCode::MOVE, r, local, 0), e->line, e->offset);
         } else {
             // Global lookup
-            int k = makeConstant({1, 0.0, mf_strdup(e->name.c_str())}); 
-            emit(createABx(OpCode::GETGLOBAL, r, k), e->line, e->offset);
+            int k = nameConstant(e->name); 
+            emitABx(OpCode::GETGLOBAL, r, k, e->line, e->offset);
         }
         return r;
     }
-    else if (auto* e = dynamic_cast<CallExpr*>(expr)) {
-        if (auto* get = dynamic_cast<GetExpr*>(e->callee.get())) {
+    case NodeKind::Call: {
+        auto* e = static_cast<CallExpr*>(expr);
+        if (auto* get = nodeAs<GetExpr>(e->callee.get())) {
             // Method call budi.bicara()
             int objReg = compile(get->object.get());
-            int kProp = makeConstant({1, 0.0, mf_strdup(get->name.c_str())});
+            int kProp = nameConstant(get->name);
             int funcReg = allocReg();
-            emit(createABC(OpCode::GETTABLE, funcReg, objReg, kProp + 256));
+            int key = kProp + 256;
+            if (kProp > MAXINDEXRK) { // GETTABLE reads the key before writing R(A)
+                emitABx(OpCode::LOADK, funcReg, kProp);
+                key = funcReg;
+            }
+            emit(createABC(OpCode::GETTABLE, funcReg, objReg, key));
             
             // Pass obj as first argument (self)
             int selfReg = allocReg();
@@ -647,7 +756,8 @@ int Compiler::compile(Expr* expr) {
             return funcReg;
         }
     }
-    else if (auto* e = dynamic_cast<FunctionExpr*>(expr)) {
+    case NodeKind::Function: {
+        auto* e = static_cast<FunctionExpr*>(expr);
         Chunk* funcChunk = compileFunctionBody(e->params, e->body.get(), "<lambda>");
         
         // Create function object result
@@ -658,23 +768,26 @@ int Compiler::compile(Expr* expr) {
         
         int kFunc = makeConstant(funcVal);
         int r = allocReg();
-        emit(createABx(OpCode::LOADK, r, kFunc));
+        emitABx(OpCode::LOADK, r, kFunc);
         return r;
     }
+    default:
+        break;
+    }
 
     return allocReg(); // Fallback
 }
 
 Type Compiler::resolveType(const Type& t) {
     if (t.kind != TypeKind::Alias) return t;
-    auto it = typeAliases.find(t.aliasName);
+    auto it = typeAliases.find(t.aliasSymbol());
     if (it != typeAliases.end()) {
         return resolveType(it->second);
     }
     return t; // Unresolved alias treated as Any
 }
 
-void Compiler::emitTypeCheck(int reg, const Type& type, int line, int offset) {
+void Compiler::emitTypeCheck(int reg, const Type& type, int line, int offset, bool packArrays) {
     Type t = resolveType(type);
     if (t.kind == TypeKind::Any) return;
 
@@ -689,10 +802,18 @@ void Compiler::emitTypeCheck(int reg, const Type& type, int line, int offset) {
         case TypeKind::Bool: runtimeType = 2; break;
         case TypeKind::Char: runtimeType = 0; break; 
         case TypeKind::Function: runtimeType = 5; break;
-        case TypeKind::Array: runtimeType = 6; break;
+        case TypeKind::Array: {
+            runtimeType = 6;
+            if (packArrays && t.baseType()) {
+                TypeKind base = resolveType(*t.baseType()).kind;
+                if (base == TypeKind::Float64 || base == TypeKind::Float32) runtimeType = 12; // f64[]
+                else if (base == TypeKind::Int32 || base == TypeKind::Int16 || base == TypeKind::Int8) runtimeType = 13; // i32[]
+            }
+            break;
+        }
         case TypeKind::Struct: {
             Any* schemaObj = manifast_create_object();
-            for (const auto& field : t.fields) {
+            for (const auto& field : t.fields()) {
                 int ft = 11;
                 if (field.type) {
                     Type ft_res = resolveType(*field.type);
@@ -713,7 +834,7 @@ void Compiler::emitTypeCheck(int reg, const Type& type, int line, int offset) {
             }
             Any typeConst = {0, 10.0, schemaObj->ptr}; // 10 = struct
             int k = makeConstant(typeConst);
-            emit(createABx(OpCode::TYPE_CHECK, reg, k), line, offset);
+            emitABx(OpCode::TYPE_CHECK, reg, k, line, offset);
             return;
         }
         default: runtimeType = 11; break;
@@ -722,7 +843,7 @@ void Compiler::emitTypeCheck(int reg, const Type& type, int line, int offset) {
     if (runtimeType != 11) {
         Any typeConst = {0, (double)runtimeType, nullptr};
         int k = makeConstant(typeConst);
-        emit(createABx(OpCode::TYPE_CHECK, reg, k), line, offset);
+        emitABx(OpCode::TYPE_CHECK, reg, k, line, offset);
     }
 }
 
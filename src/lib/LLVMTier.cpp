@@ -0,0 +1,375 @@
+#include "manifast/VM/LLVMTier.h"
+#include "manifast/VM/Chunk.h"
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Passes/OptimizationLevel.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/TargetParser/Host.h>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace manifast {
+namespace vm {
+
+namespace {
+
+// Lowers one chunk into `i32 fn(ptr regs, ptr constants, i32 startPc)`.
+// Every instruction start gets a basic block; instructions without a fast
+// path, and failed type guards, branch to a block returning their pc.
+class ChunkLowering {
+public:
+    ChunkLowering(const Chunk& chunk, const TierContext& context, llvm::Module& module)
+        : chunk(chunk), context(context), ctx(module.getContext()), b(module.getContext()) {
+        anyTy = llvm::StructType::get(ctx, {b.getInt32Ty(), b.getDoubleTy(), b.getPtrTy()});
+        auto* fnTy = llvm::FunctionType::get(b.getInt32Ty(), {b.getPtrTy(), b.getPtrTy(), b.getInt32Ty()}, false);
+        fn = llvm::Function::Create(fnTy, llvm::Function::ExternalLinkage, "chunk", module);
+        fn->addParamAttr(0, llvm::Attribute::NoAlias);
+        fn->addParamAttr(1, llvm::Attribute::NoAlias);
+        regs = fn->getArg(0);
+        constants = fn->getArg(1);
+    }
+
+    llvm::Function* lower() {
+        int n = (int)chunk.code.size();
+        for (int pc = 0; pc < n; pc += instructionLength(chunk, pc)) {
+            blocks[pc] = llvm::BasicBlock::Create(ctx, "pc" + std::to_string(pc), fn);
+        }
+
+        llvm::BasicBlock* entry = llvm::BasicBlock::Create(ctx, "entry", fn, blocks.empty() ? nullptr : blocks[0]);
+        b.SetInsertPoint(entry);
+        std::vector<int> entries = tierEntryPoints(chunk);
+        llvm::Value* startPc = fn->getArg(2);
+        llvm::BasicBlock* noEntry = llvm::BasicBlock::Create(ctx, "no_entry", fn);
+        auto* sw = b.CreateSwitch(startPc, noEntry, (unsigned)entries.size());
+        for (int pc : entries) {
+            if (blocks.count(pc)) sw->addCase(b.getInt32(pc), blocks[pc]);
+        }
+        b.SetInsertPoint(noEntry);
+        b.CreateRet(startPc);
+
+        for (int pc = 0; pc < n; pc += instructionLength(chunk, pc)) {
+            b.SetInsertPoint(blocks[pc]);
+            lowerInstruction(pc, pc + instructionLength(chunk, pc));
+        }
+        return fn;
+    }
+
+private:
+    const Chunk& chunk;
+    const TierContext& context;
+    llvm::LLVMContext& ctx;
+    llvm::IRBuilder<> b;
+    llvm::StructType* anyTy;
+    llvm::Function* fn;
+    llvm::Value* regs;
+    llvm::Value* constants;
+    std::unordered_map<int, llvm::BasicBlock*> blocks;
+    std::unordered_map<int, llvm::BasicBlock*> exits;
+
+    llvm::BasicBlock* exitTo(int pc) {
+        auto it = exits.find(pc);
+        if (it != exits.end()) return it->second;
+        llvm::BasicBlock* bb = llvm::BasicBlock::Create(ctx, "exit" + std::to_string(pc), fn);
+        llvm::IRBuilder<> eb(bb);
+        eb.CreateRet(eb.getInt32(pc));
+        return exits[pc] = bb;
+    }
+
+    // Block for the instruction at `pc`, or a side exit when it is not one.
+    llvm::BasicBlock* blockAt(int pc) {
+        auto it = blocks.find(pc);
+        return it != blocks.end() ? it->second : exitTo(pc);
+    }
+
+    llvm::Value* slot(int reg) { return b.CreateInBoundsGEP(anyTy, regs, b.getInt32(reg)); }
+    llvm::Value* typeOf(int reg) { return b.CreateLoad(b.getInt32Ty(), b.CreateStructGEP(anyTy, slot(reg), 0)); }
+    llvm::Value* numberOf(int reg) { return b.CreateLoad(b.getDoubleTy(), b.CreateStructGEP(anyTy, slot(reg), 1)); }
+
+    void store(int reg, int type, llvm::Value* number) {
+        llvm::Value* s = slot(reg);
+        b.CreateStore(b.getInt32(type), b.CreateStructGEP(anyTy, s, 0));
+        b.CreateStore(number, b.CreateStructGEP(anyTy, s, 1));
+        b.CreateStore(llvm::ConstantPointerNull::get(b.getPtrTy()), b.CreateStructGEP(anyTy, s, 2));
+    }
+
+    // Continue in a fresh block when `cond` holds, otherwise leave at `pc`.
+    void guard(llvm::Value* cond, int pc) {
+        llvm::BasicBlock* ok = llvm::BasicBlock::Create(ctx, "", fn);
+        b.CreateCondBr(cond, ok, exitTo(pc));
+        b.SetInsertPoint(ok);
+    }
+
+    // RK operand as a double, guarding register operands on ANY_NUMBER.
+    // Returns nullptr for constants that are not numbers.
+    llvm::Value* number(int rk, int pc) {
+        if (rk >= 256) {
+            int k = rk - 256;
+            if (k >= (int)chunk.constants.size() || chunk.constants[k].type != ANY_NUMBER) return nullptr;
+            return llvm::ConstantFP::get(b.getDoubleTy(), chunk.constants[k].number);
+        }
+        guard(b.CreateICmpEQ(typeOf(rk), b.getInt32(ANY_NUMBER)), pc);
+        return numberOf(rk);
+    }
+
+    // Same truthiness as the interpreter: nil is false, bools and numbers are
+    // false when zero, anything else is true.
+    llvm::Value* truthy(int reg) {
+        llvm::Value* type = typeOf(reg);
+        llvm::Value* nonZero = b.CreateFCmpUNE(numberOf(reg), llvm::ConstantFP::get(b.getDoubleTy(), 0.0));
+        llvm::Value* numeric = b.CreateOr(b.CreateICmpEQ(type, b.getInt32(ANY_BOOLEAN)),
+                                          b.CreateICmpEQ(type, b.getInt32(ANY_NUMBER)));
+        llvm::Value* other = b.CreateICmpNE(type, b.getInt32(ANY_NIL));
+        return b.CreateSelect(numeric, nonZero, other);
+    }
+
+    // The VM's slot for the global named by constant `k`, as a pointer constant.
+    llvm::Value* globalSlot(int k) {
+        if (k >= (int)chunk.constants.size() || !context.globalSlot) return nullptr;
+        const Any& key = chunk.constants[k];
+        if (key.type != ANY_STRING || !key.ptr) return nullptr;
+        Any* address = context.globalSlot((const char*)key.ptr);
+        if (!address) return nullptr;
+        return b.CreateIntToPtr(b.getInt64((uint64_t)(uintptr_t)address), b.getPtrTy());
+    }
+
+    // if (cond) skip the next instruction word
+    void skipIf(llvm::Value* cond, int next) {
+        b.CreateCondBr(cond, blockAt(next + 1), blockAt(next));
+    }
+
+    void lowerInstruction(int pc, int next) {
+        Instruction i = chunk.code[pc];
+        int a = getA(i);
+        switch (getOpCode(i)) {
+            case OpCode::MOVE: {
+                b.CreateStore(b.CreateLoad(anyTy, slot(getB(i))), slot(a));
+                b.CreateBr(blockAt(next));
+                return;
+            }
+            case OpCode::LOADK: {
+                int k = getBx(i) == (uint32_t)MAXARG_Bx ? (int)chunk.code[pc + 1] : (int)getBx(i);
+                if (k >= (int)chunk.constants.size()) break;
+                const Any& c = chunk.constants[k];
+                if (c.type == ANY_NUMBER || c.type == ANY_BOOLEAN || c.type == ANY_NIL) {
+                    store(a, c.type, llvm::ConstantFP::get(b.getDoubleTy(), c.number));
+                } else {
+                    llvm::Value* src = b.CreateInBoundsGEP(anyTy, constants, b.getInt32(k));
+                    b.CreateStore(b.CreateLoad(anyTy, src), slot(a));
+                }
+                b.CreateBr(blockAt(next));
+                return;
+            }
+            case OpCode::GETGLOBAL:
+            case OpCode::SETGLOBAL: {
+                int k = getBx(i) == (uint32_t)MAXARG_Bx ? (int)chunk.code[pc + 1] : (int)getBx(i);
+                llvm::Value* global = globalSlot(k);
+                if (!global) break; // undefined so far: the interpreter reports it
+                if (getOpCode(i) == OpCode::GETGLOBAL) b.CreateStore(b.CreateLoad(anyTy, global), slot(a));
+                else b.CreateStore(b.CreateLoad(anyTy, slot(a)), global);
+                b.CreateBr(blockAt(next));
+                return;
+            }
+            case OpCode::LOADBOOL: {
+                store(a, ANY_BOOLEAN, llvm::ConstantFP::get(b.getDoubleTy(), (double)getB(i)));
+                b.CreateBr(blockAt(getC(i) ? next + 1 : next));
+                return;
+            }
+            case OpCode::LOADNIL: {
+                for (int r = a; r <= a + getB(i); r++) store(r, ANY_NIL, llvm::ConstantFP::get(b.getDoubleTy(), 0.0));
+                b.CreateBr(blockAt(next));
+                return;
+            }
+            case OpCode::ADD:
+            case OpCode::SUB:
+            case OpCode::MUL:
+            case OpCode::DIV:
+            case OpCode::MOD: {
+                llvm::Value* x = number(getB(i), pc);
+                llvm::Value* y = x ? number(getC(i), pc) : nullptr;
+                if (!y) break;
+                llvm::Value* r = nullptr;
+                switch (getOpCode(i)) {
+                    case OpCode::ADD: r = b.CreateFAdd(x, y); break;
+                    case OpCode::SUB: r = b.CreateFSub(x, y); break;
+                    case OpCode::MUL: r = b.CreateFMul(x, y); break;
+                    case OpCode::DIV: r = b.CreateFDiv(x, y); break;
+                    default:          r = b.CreateFRem(x, y); break; // fmod semantics
+                }
+                store(a, ANY_NUMBER, r);
+                b.CreateBr(blockAt(next));
+                return;
+            }
+            case OpCode::UNM: {
+                llvm::Value* x = number(getB(i), pc);
+                store(a, ANY_NUMBER, b.CreateFNeg(x));
+                b.CreateBr(blockAt(next));
+                return;
+            }
+            case OpCode::NOT: {
+                llvm::Value* v = b.CreateSelect(truthy(getB(i)), llvm::ConstantFP::get(b.getDoubleTy(), 0.0),
+                                                llvm::ConstantFP::get(b.getDoubleTy(), 1.0));
+                store(a, ANY_BOOLEAN, v);
+                b.CreateBr(blockAt(next));
+                return;
+            }
+            case OpCode::EQ:
+            case OpCode::LT:
+            case OpCode::LE: {
+                llvm::Value* x = number(getB(i), pc);
+                llvm::Value* y = x ? number(getC(i), pc) : nullptr;
+                if (!y) break;
+                llvm::Value* res = getOpCode(i) == OpCode::EQ ? b.CreateFCmpOEQ(x, y)
+                                 : getOpCode(i) == OpCode::LT ? b.CreateFCmpOLT(x, y)
+                                                              : b.CreateFCmpOLE(x, y);
+                skipIf(a ? b.CreateNot(res) : res, next);
+                return;
+            }
+            case OpCode::JMP: {
+                b.CreateBr(blockAt(pc + 1 + getsBx(i)));
+                return;
+            }
+            case OpCode::TEST: {
+                llvm::Value* val = truthy(a);
+                skipIf(getC(i) ? b.CreateNot(val) : val, next);
+                return;
+            }
+            case OpCode::TESTSET: {
+                llvm::Value* val = truthy(getB(i));
+                llvm::BasicBlock* set = llvm::BasicBlock::Create(ctx, "", fn);
+                b.CreateCondBr(getC(i) ? val : b.CreateNot(val), set, blockAt(next + 1));
+                b.SetInsertPoint(set);
+                b.CreateStore(b.CreateLoad(anyTy, slot(getB(i))), slot(a));
+                b.CreateBr(blockAt(next));
+                return;
+            }
+            default:
+                break;
+        }
+        // No fast path: hand this instruction to the interpreter.
+        if (!b.GetInsertBlock()->getTerminator()) b.CreateBr(exitTo(pc));
+    }
+};
+
+static llvm::CodeGenOptLevel codeGenOptLevel(int level) {
+    switch (level) {
+        case 0: return llvm::CodeGenOptLevel::None;
+        case 1: return llvm::CodeGenOptLevel::Less;
+        case 3: return llvm::CodeGenOptLevel::Aggressive;
+        default: return llvm::CodeGenOptLevel::Default;
+    }
+}
+
+class LLVMTierBackend : public TierBackend {
+public:
+    explicit LLVMTierBackend(int optLevel) : optLevel(optLevel) {}
+
+    const char* name() const override { return "llvm"; }
+    // Optimizing a chunk takes milliseconds; keep that off the interpreter thread.
+    bool compilesInBackground() const override { return true; }
+
+    NativeEntry compile(const Chunk& chunk, const TierContext& tierContext) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!jit && !createJIT()) return nullptr;
+
+        auto context = std::make_unique<llvm::LLVMContext>();
+        std::string symbol = "manifast_tier2_" + std::to_string(nextId++);
+        auto module = std::make_unique<llvm::Module>(symbol, *context);
+        module->setDataLayout(jit->getDataLayout());
+
+        llvm::Function* fn = ChunkLowering(chunk, tierContext, *module).lower();
+        fn->setName(symbol);
+        if (llvm::verifyFunction(*fn, &llvm::errs())) {
+            std::cerr << "Error: T2 lowering of '" << chunk.name << "' failed verification\n";
+            return nullptr;
+        }
+        optimize(*module);
+
+        if (auto err = jit->addIRModule(llvm::orc::ThreadSafeModule(std::move(module), std::move(context)))) {
+            std::cerr << "Error adding T2 module: " << llvm::toString(std::move(err)) << "\n";
+            return nullptr;
+        }
+        auto sym = jit->lookup(symbol);
+        if (!sym) {
+            llvm::consumeError(sym.takeError());
+            return nullptr;
+        }
+        return (NativeEntry)(*sym).getValue();
+    }
+
+private:
+    bool createJIT() {
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+
+        auto jtmb = llvm::orc::JITTargetMachineBuilder::detectHost();
+        if (!jtmb) {
+            llvm::consumeError(jtmb.takeError());
+            return false;
+        }
+        jtmb->setCPU(llvm::sys::getHostCPUName().str());
+        jtmb->setCodeGenOptLevel(codeGenOptLevel(optLevel));
+        if (optLevel > 0) {
+            auto tm = jtmb->createTargetMachine();
+            if (!tm) {
+                llvm::consumeError(tm.takeError());
+                return false;
+            }
+            targetMachine = std::move(*tm);
+        }
+
+        auto created = llvm::orc::LLJITBuilder().setJITTargetMachineBuilder(std::move(*jtmb)).create();
+        if (!created) {
+            std::cerr << "Error creating T2 JIT: " << llvm::toString(created.takeError()) << "\n";
+            return false;
+        }
+        jit = std::move(*created);
+        // frem lowers to a libm fmod call
+        jit->getMainJITDylib().addGenerator(
+            llvm::cantFail(llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+                jit->getDataLayout().getGlobalPrefix())));
+        return true;
+    }
+
+    void optimize(llvm::Module& module) {
+        if (optLevel == 0) return;
+
+        llvm::LoopAnalysisManager LAM;
+        llvm::FunctionAnalysisManager FAM;
+        llvm::CGSCCAnalysisManager CGAM;
+        llvm::ModuleAnalysisManager MAM;
+
+        llvm::PassBuilder PB(targetMachine.get());
+        PB.registerModuleAnalyses(MAM);
+        PB.registerCGSCCAnalyses(CGAM);
+        PB.registerFunctionAnalyses(FAM);
+        PB.registerLoopAnalyses(LAM);
+        PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+        llvm::OptimizationLevel level = optLevel == 1 ? llvm::OptimizationLevel::O1
+                                      : optLevel == 2 ? llvm::OptimizationLevel::O2
+                                      : llvm::OptimizationLevel::O3;
+        PB.buildPerModuleDefaultPipeline(level).run(module, MAM);
+    }
+
+    int optLevel;
+    std::mutex mutex;
+    std::unique_ptr<llvm::orc::LLJIT> jit;
+    std::unique_ptr<llvm::TargetMachine> targetMachine;
+    unsigned nextId = 0;
+};
+
+} // namespace
+
+std::shared_ptr<TierBackend> createLLVMTierBackend(int optLevel) {
+    return std::make_shared<LLVMTierBackend>(optLevel < 0 ? 0 : (optLevel > 3 ? 3 : optLevel));
+}
+
+} // namespace vm
+} // namespace manifast
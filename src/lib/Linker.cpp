@@ -0,0 +1,203 @@
+#include "manifast/Linker.h"
+#include "manifast/Utils/Process.h"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/Chrono.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/Program.h>
+#include <llvm/Support/SHA256.h>
+#include <llvm/Support/raw_ostream.h>
+#include <cstdlib>
+#include <mutex>
+#include <optional>
+
+#ifdef MANIFAST_HAS_LLD
+#include <lld/Common/Driver.h>
+LLD_HAS_DRIVER(elf)
+LLD_HAS_DRIVER(mingw)
+#endif
+
+namespace manifast {
+
+namespace {
+
+// Stand-ins for the per-build paths in the cached link line. Plain words:
+// both the driver and LLD read arguments starting with '@' as response files.
+const char* const kObjectSlot = "manifast-link-object.o";
+const char* const kOutputSlot = "manifast-link-output";
+
+std::vector<std::string> driverArgs(const LinkRequest& request, const std::string& object, const std::string& output) {
+    std::vector<std::string> args{request.driver, object, "-o", output};
+    for (const std::string& dir : request.libDirs) args.push_back("-L" + dir);
+    for (const std::string& lib : request.libs) args.push_back("-l" + lib);
+    args.push_back("-static");
+    return args;
+}
+
+std::string joined(const std::vector<std::string>& args) {
+    std::string line;
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (i) line += ' ';
+        line += args[i];
+    }
+    return line;
+}
+
+#ifdef MANIFAST_HAS_LLD
+std::mutex lldMutex;      // LLD keeps global state; one link at a time
+bool lldReusable = true;  // false once LLD reports it cannot run again
+
+// One line of `-###` output: "quoted" (backslash escapes) or bare words.
+std::vector<std::string> splitCommandLine(llvm::StringRef line) {
+    std::vector<std::string> words;
+    size_t i = 0;
+    while (i < line.size()) {
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\r')) ++i;
+        if (i == line.size()) break;
+        std::string word;
+        if (line[i] == '"') {
+            for (++i; i < line.size() && line[i] != '"'; ++i) {
+                if (line[i] == '\\' && i + 1 < line.size()) ++i;
+                word += line[i];
+            }
+            ++i; // closing quote
+        } else {
+            while (i < line.size() && line[i] != ' ' && line[i] != '\r') word += line[i++];
+        }
+        words.push_back(std::move(word));
+    }
+    return words;
+}
+
+// <cache dir>/link/<key>.args; the key covers the driver binary and the request.
+std::string cachePath(const LinkRequest& request, llvm::StringRef driverPath) {
+    llvm::SmallString<256> path;
+    if (const char* env = std::getenv("MANIFAST_CACHE_DIR")) {
+        path = env;
+    } else if (llvm::sys::path::cache_directory(path)) {
+        llvm::sys::path::append(path, "manifast");
+    } else {
+        return {};
+    }
+    llvm::sys::path::append(path, "link");
+
+    llvm::SHA256 hash;
+    hash.update(driverPath);
+    llvm::sys::fs::file_status status;
+    if (!llvm::sys::fs::status(driverPath, status)) {
+        hash.update(std::to_string(llvm::sys::toTimeT(status.getLastModificationTime()))); // toolchain upgrades
+    }
+    for (const std::string& arg : driverArgs(request, kObjectSlot, kOutputSlot)) {
+        hash.update(llvm::StringRef("\0", 1));
+        hash.update(arg);
+    }
+    llvm::sys::path::append(path, llvm::toHex(hash.final(), /*LowerCase=*/true).substr(0, 16) + ".args");
+    return std::string(path);
+}
+
+// The linker invocation `driver -###` would run, rewritten for LLD.
+std::vector<std::string> probeLinkLine(const LinkRequest& request, llvm::StringRef driverPath) {
+    llvm::SmallString<128> log;
+    if (llvm::sys::fs::createTemporaryFile("manifast-link", "txt", log)) return {};
+    std::vector<std::string> args = driverArgs(request, kObjectSlot, kOutputSlot);
+    args.insert(args.begin() + 1, "-###");
+    std::vector<llvm::StringRef> argRefs(args.begin(), args.end());
+    std::optional<llvm::StringRef> redirects[] = {std::nullopt, std::nullopt, llvm::StringRef(log)};
+    int ret = llvm::sys::ExecuteAndWait(driverPath, argRefs, std::nullopt, redirects);
+    auto output = llvm::MemoryBuffer::getFile(log);
+    llvm::sys::fs::remove(log);
+    if (ret != 0 || !output) return {};
+
+    // The last command that runs collect2 or ld
+    std::vector<std::string> linkLine;
+    llvm::SmallVector<llvm::StringRef, 16> lines;
+    (*output)->getBuffer().split(lines, '\n');
+    for (llvm::StringRef line : lines) {
+        std::vector<std::string> words = splitCommandLine(line);
+        if (words.empty()) continue;
+        llvm::StringRef program = llvm::sys::path::stem(words[0]); // ld.bfd, ld.exe -> ld
+        if (program == "collect2" || program == "ld") linkLine = std::move(words);
+    }
+    if (linkLine.empty()) return {};
+
+    // The GCC LTO plugin is collect2's business; our objects are native code
+    std::vector<std::string> lldLine{"ld.lld"};
+    for (size_t i = 1; i < linkLine.size(); ++i) {
+        if (linkLine[i] == "-plugin") { ++i; continue; }
+        if (linkLine[i].rfind("-plugin-opt", 0) == 0) continue;
+        lldLine.push_back(linkLine[i]);
+    }
+    return lldLine;
+}
+
+void storeLinkLine(const std::string& path, const std::vector<std::string>& line) {
+    llvm::sys::fs::create_directories(llvm::sys::path::parent_path(path));
+    // Parallel builds may probe at the same time: write aside, rename into place
+    std::string tmp = path + ".tmp" + std::to_string(llvm::sys::Process::getProcessId());
+    {
+        std::error_code ec;
+        llvm::raw_fd_ostream out(tmp, ec, llvm::sys::fs::OF_None);
+        if (ec) return;
+        for (const std::string& arg : line) out << arg << '\n';
+    }
+    if (llvm::sys::fs::rename(tmp, path)) llvm::sys::fs::remove(tmp);
+}
+
+std::vector<std::string> loadLinkLine(const std::string& path) {
+    auto buffer = llvm::MemoryBuffer::getFile(path);
+    if (!buffer) return {};
+    std::vector<std::string> line;
+    llvm::SmallVector<llvm::StringRef, 64> words;
+    (*buffer)->getBuffer().split(words, '\n', -1, /*KeepEmpty=*/false);
+    for (llvm::StringRef word : words) line.push_back(word.str());
+    return line;
+}
+
+// Returns the link's exit code, or -1 if it could not be attempted.
+int linkInProcess(const LinkRequest& request, std::string* command) {
+    std::lock_guard<std::mutex> lock(lldMutex);
+    if (!lldReusable) return -1;
+    auto driverPath = llvm::sys::findProgramByName(request.driver);
+    if (!driverPath) return -1;
+
+    std::string cache = cachePath(request, *driverPath);
+    std::vector<std::string> line = cache.empty() ? std::vector<std::string>{} : loadLinkLine(cache);
+    if (line.empty()) {
+        line = probeLinkLine(request, *driverPath);
+        if (line.empty()) return -1;
+        if (!cache.empty()) storeLinkLine(cache, line);
+    }
+
+    for (std::string& arg : line) {
+        if (arg == kObjectSlot) arg = request.object;
+        else if (arg == kOutputSlot) arg = request.output;
+    }
+    if (command) *command = joined(line);
+
+    std::vector<const char*> argv;
+    for (const std::string& arg : line) argv.push_back(arg.c_str());
+    lld::Result result = lld::lldMain(argv, llvm::outs(), llvm::errs(),
+                                      {{lld::Gnu, &lld::elf::link}, {lld::MinGW, &lld::mingw::link}});
+    if (!result.canRunAgain) lldReusable = false;
+    if (result.retCode != 0 && !cache.empty()) llvm::sys::fs::remove(cache); // re-probe next time
+    return result.retCode;
+}
+#endif
+
+} // namespace
+
+int linkExecutable(const LinkRequest& request, std::string* command) {
+#ifdef MANIFAST_HAS_LLD
+    int ret = linkInProcess(request, command);
+    if (ret == 0) return 0;
+    // Not linkable in-process (no driver to probe, LLD error): let the driver try
+#endif
+    std::vector<std::string> args = driverArgs(request, request.object, request.output);
+    if (command) *command = joined(args);
+    return utils::runCommand(args);
+}
+
+} // namespace manifast
@@ -137,32 +137,38 @@ void Parser::synchronize() {
 
 std::vector<std::unique_ptr<Stmt>> Parser::parse() {
     std::vector<std::unique_ptr<Stmt>> statements;
-    int iterations = 0;
-    while (currentToken.type != TokenType::EndOfFile) {
-        if (iterations++ > 10000) {
-            fprintf(stderr, "Kesalahan Kritis: Parser terjebak dalam loop tak terbatas.\n");
-            break;
+    while (!atEnd()) {
+        auto stmt = parseNext();
+        if (stmt) {
+            statements.push_back(std::move(stmt));
         }
+    }
+    return statements;
+}
 
+std::unique_ptr<Stmt> Parser::parseNext() {
+    while (currentToken.type != TokenType::EndOfFile) {
         Token startToken = currentToken;
         if (debugMode) {
             fprintf(stderr, "[PARSER] Parsing statement at line %d (token: '%s')\n", currentToken.location.line, std::string(currentToken.lexeme).c_str());
             fflush(stderr);
         }
         auto stmt = parseStatement();
-        if (stmt) {
-            statements.push_back(std::move(stmt));
-        }
-        
-        if (currentToken.type == TokenType::EndOfFile) break;
 
         // Safety: If no progress was made, synchronize
         // Use offset to distinguish between identical tokens at different positions
-        if (currentToken.location.offset == startToken.location.offset) {
+        if (currentToken.type != TokenType::EndOfFile &&
+            currentToken.location.offset == startToken.location.offset) {
             synchronize();
         }
+        if (stmt) return stmt;
     }
-    return statements;
+    return nullptr;
+}
+
+std::vector<std::unique_ptr<Stmt>> Parser::parse(AstArena& arena) {
+    AstArena::Scope scope(arena);
+    return parse();
 }
 
 // --- Statements ---
@@ -219,7 +225,7 @@ std::unique_ptr<Stmt> Parser::parseClassStatement() {
     }
     
     consume(TokenType::K_End, "Diharapkan 'tutup' setelah isi kelas");
-    return makeNode<ClassStmt>(keyword, std::string(name.lexeme), std::move(methods));
+    return makeNode<ClassStmt>(keyword, Symbol(name.lexeme), std::move(methods));
 }
 
 std::unique_ptr<Stmt> Parser::parseFunctionStatement() {
@@ -235,7 +241,7 @@ std::unique_ptr<Stmt> Parser::parseFunctionStatement() {
             if (match(TokenType::Colon)) {
                 paramType = parseType();
             }
-            params.push_back({std::string(param.lexeme), std::move(paramType), param.location.line, param.location.offset});
+            params.push_back({Symbol(param.lexeme), std::move(paramType), param.location.line, param.location.offset});
         } while (match(TokenType::Comma));
     }
     consume(TokenType::RParen, "Diharapkan ')' setelah parameter");
@@ -249,7 +255,7 @@ std::unique_ptr<Stmt> Parser::parseFunctionStatement() {
     std::vector<std::unique_ptr<Stmt>> body = parseBlock(&body_start); 
     consume(TokenType::K_End, "Diharapkan 'tutup' setelah isi fungsi");
     
-    return makeNode<FunctionStmt>(keyword, std::string(name.lexeme), std::move(params), std::move(returnType), makeNode<BlockStmt>(body_start, std::move(body)));
+    return makeNode<FunctionStmt>(keyword, Symbol(name.lexeme), std::move(params), std::move(returnType), makeNode<BlockStmt>(body_start, std::move(body)));
 }
 
 std::unique_ptr<Stmt> Parser::parseIfStatement() {
@@ -325,7 +331,7 @@ std::unique_ptr<Stmt> Parser::parseForStatement() {
     Token body_start = currentToken;
     std::vector<std::unique_ptr<Stmt>> bodyStmts = parseBlock();
     consume(TokenType::K_End, "Diharapkan 'tutup' setelah pengulangan 'untuk'");
-    return makeNode<ForStmt>(keyword, std::string(varToken.lexeme), std::move(start), std::move(end), std::move(step), makeNode<BlockStmt>(body_start, std::move(bodyStmts)));
+    return makeNode<ForStmt>(keyword, Symbol(varToken.lexeme), std::move(start), std::move(end), std::move(step), makeNode<BlockStmt>(body_start, std::move(bodyStmts)));
 }
 
 std::unique_ptr<Stmt> Parser::parseTryStatement() {
@@ -337,13 +343,13 @@ std::unique_ptr<Stmt> Parser::parseTryStatement() {
     }
     
     std::unique_ptr<Stmt> catchBranch = nullptr;
-    std::string catchVar = "";
+    Symbol catchVar;
 
     if (match(TokenType::K_Catch)) {
         Token catch_token = previous();
         if (check(TokenType::Identifier)) {
             Token varName = consume(TokenType::Identifier, "Diharapkan nama variabel eksepsi");
-            catchVar = std::string(varName.lexeme);
+            catchVar = Symbol(varName.lexeme);
             if (check(TokenType::K_Then)) advance(); 
         }
         Token catch_body_start = currentToken;
@@ -376,7 +382,7 @@ std::unique_ptr<Stmt> Parser::parseVarDeclaration() {
         initializer = parseExpression();
     }
     match(TokenType::Semicolon);
-    return makeNode<VarDeclStmt>(name, std::string(name.lexeme), std::move(typeAnnotation), std::move(initializer), false);
+    return makeNode<VarDeclStmt>(name, Symbol(name.lexeme), std::move(typeAnnotation), std::move(initializer), false);
 }
 
 std::vector<std::unique_ptr<Stmt>> Parser::parseBlock(Token* firstToken) {
@@ -409,9 +415,9 @@ std::unique_ptr<Expr> Parser::parseAssignment() {
         
         auto value = parseAssignment();
         
-        if (dynamic_cast<VariableExpr*>(expr.get()) ||
-            dynamic_cast<GetExpr*>(expr.get()) ||
-            dynamic_cast<IndexExpr*>(expr.get())) {
+        if (expr && (expr->kind == NodeKind::Variable ||
+                     expr->kind == NodeKind::Get ||
+                     expr->kind == NodeKind::Index)) {
              return makeNode<AssignExpr>(opToken, std::move(expr), std::move(value), op);
         }
         error(opToken, "Lokasi assignment tidak sah."); 
@@ -549,7 +555,7 @@ std::unique_ptr<Expr> Parser::parseCall() {
         } else if (match(TokenType::Dot)) {
             Token dotToken = previous();
             Token name = consume(TokenType::Identifier, "Diharapkan nama properti");
-             expr = makeNode<GetExpr>(dotToken, std::move(expr), std::string(name.lexeme));
+             expr = makeNode<GetExpr>(dotToken, std::move(expr), Symbol(name.lexeme));
         } else if (match(TokenType::LBracket)) {
             Token open = previous();
             std::unique_ptr<Expr> index = nullptr;
@@ -594,7 +600,7 @@ std::unique_ptr<Expr> Parser::parseFunctionExpression(const Token& keyword) {
             if (match(TokenType::Colon)) {
                 paramType = parseType();
             }
-            params.push_back({std::string(param.lexeme), std::move(paramType), param.location.line, param.location.offset});
+            params.push_back({Symbol(param.lexeme), std::move(paramType), param.location.line, param.location.offset});
         } while (match(TokenType::Comma));
     }
     consume(TokenType::RParen, "Expect ')' after parameters");
@@ -629,22 +635,22 @@ Type Parser::parseType() {
         else if (name == "void") type = Type(TypeKind::Void);
         else {
             // It might be a custom type alias
-            type.kind = TypeKind::Alias;
-            type.aliasName = std::string(name);
+            type = Type::makeAlias(std::string(name));
         }
     } else if (match(TokenType::LBrace)) {
         // Struct Type: { field: type, ... }
-        type.kind = TypeKind::Struct;
+        std::vector<Type::Field> fields;
         if (!check(TokenType::RBrace)) {
             while (!check(TokenType::RBrace) && !check(TokenType::EndOfFile)) {
                 Token fieldName = consume(TokenType::Identifier, "Diharapkan nama field");
                 consume(TokenType::Colon, "Diharapkan ':' setelah nama field");
                 Type fieldType = parseType();
-                type.fields.push_back(Type::Field{std::string(fieldName.lexeme), std::make_shared<Type>(std::move(fieldType))});
+                fields.push_back(Type::Field{std::string(fieldName.lexeme), std::make_shared<Type>(std::move(fieldType))});
                 match(TokenType::Comma); // Optional comma
             }
         }
         consume(TokenType::RBrace, "Diharapkan '}' setelah field struct");
+        type = Type::makeStruct(std::move(fields));
     } else if (match(TokenType::K_Int32)) { // Legacy / keyword mapped
         type = Type(TypeKind::Int32);
     } else if (match(TokenType::K_String)) {
@@ -664,16 +670,16 @@ Type Parser::parseType() {
     } else if (match(TokenType::K_Char)) {
         type = Type(TypeKind::Char);
     } else if (match(TokenType::K_Function)) {
-        type = Type(TypeKind::Function);
+        std::vector<Type> params;
         consume(TokenType::LParen, "Diharapkan '(' setelah 'fungsi'");
         if (!check(TokenType::RParen)) {
             do {
-                type.params.push_back(parseType());
+                params.push_back(parseType());
             } while (match(TokenType::Comma));
         }
         consume(TokenType::RParen, "Diharapkan ')'");
         consume(TokenType::Colon, "Diharapkan ':' sebelum tipe kembalian");
-        type.returnType = std::make_shared<Type>(parseType());
+        type = Type::makeFunction(std::move(params), parseType());
     } else if (match(TokenType::Star)) {
         type = Type::makePointer(parseType());
     }
@@ -692,7 +698,7 @@ std::unique_ptr<Stmt> Parser::parseTypeDeclaration() {
     Token name = consume(TokenType::Identifier, "Expect type name");
     consume(TokenType::Equal, "Expect '=' after type name");
     Type type = parseType();
-    return makeNode<TypeAliasStmt>(keyword, std::string(name.lexeme), std::move(type));
+    return makeNode<TypeAliasStmt>(keyword, Symbol(name.lexeme), std::move(type));
 }
 
 std::unique_ptr<Expr> Parser::parsePrimary() {
@@ -712,7 +718,7 @@ std::unique_ptr<Expr> Parser::parsePrimary() {
         // Remove quotes
         return makeNode<StringExpr>(str, lex.substr(1, lex.length() - 2));
     }
-    if (match(TokenType::Identifier)) return makeNode<VariableExpr>(previous(), std::string(previous().lexeme));
+    if (match(TokenType::Identifier)) return makeNode<VariableExpr>(previous(), Symbol(previous().lexeme));
     if (match(TokenType::K_Self)) return makeNode<VariableExpr>(previous(), "self");
     
     if (match(TokenType::LParen)) {
@@ -737,13 +743,13 @@ std::unique_ptr<Expr> Parser::parsePrimary() {
     // Object Literal { key: value, key2: value2 }
     if (match(TokenType::LBrace)) {
         Token open = previous();
-        std::vector<std::pair<std::string, std::unique_ptr<Expr>>> entries;
+        std::vector<std::pair<Symbol, std::unique_ptr<Expr>>> entries;
         if (!check(TokenType::RBrace)) {
             do {
                 Token key = consume(TokenType::Identifier, "Diharapkan kunci objek");
                 consume(TokenType::Colon, "Diharapkan ':' setelah kunci");
                 auto value = parseExpression();
-                entries.push_back({std::string(key.lexeme), std::move(value)});
+                entries.push_back({Symbol(key.lexeme), std::move(value)});
             } while (match(TokenType::Comma));
         }
         consume(TokenType::RBrace, "Diharapkan '}' setelah isi objek");
@@ -0,0 +1,91 @@
+#include "manifast/Profile.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace manifast {
+
+uint64_t ExecutionProfile::fingerprint(std::string_view source) {
+    // FNV-1a; only has to tell edited sources apart
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : source) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+void ExecutionProfile::merge(const ExecutionProfile& other) {
+    for (const auto& [name, count] : other.calls) calls[name] += count;
+    for (const auto& [offset, counts] : other.branches) {
+        BranchCounts& c = branches[offset];
+        c.taken += counts.taken;
+        c.notTaken += counts.notTaken;
+    }
+}
+
+std::string ExecutionProfile::serialize() const {
+    std::vector<std::pair<std::string, uint64_t>> sortedCalls(calls.begin(), calls.end());
+    std::sort(sortedCalls.begin(), sortedCalls.end());
+    std::vector<std::pair<int, BranchCounts>> sortedBranches(branches.begin(), branches.end());
+    std::sort(sortedBranches.begin(), sortedBranches.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::ostringstream out;
+    out << "manifast-profile 1\n";
+    out << "source " << source << "\n";
+    for (const auto& [name, count] : sortedCalls) out << "call " << count << " " << name << "\n";
+    for (const auto& [offset, c] : sortedBranches) {
+        out << "branch " << offset << " " << c.taken << " " << c.notTaken << "\n";
+    }
+    return out.str();
+}
+
+bool ExecutionProfile::parse(std::string_view text) {
+    ExecutionProfile parsed;
+    std::istringstream in{std::string(text)};
+    std::string line;
+    if (!std::getline(in, line) || line != "manifast-profile 1") return false;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        std::istringstream fields(line);
+        std::string kind;
+        fields >> kind;
+        if (kind == "source") {
+            if (!(fields >> parsed.source)) return false;
+        } else if (kind == "call") {
+            uint64_t count;
+            std::string name;
+            if (!(fields >> count) || !(fields >> std::ws) || !std::getline(fields, name)) return false;
+            parsed.calls[name] += count;
+        } else if (kind == "branch") {
+            int offset;
+            BranchCounts c;
+            if (!(fields >> offset >> c.taken >> c.notTaken)) return false;
+            BranchCounts& slot = parsed.branches[offset];
+            slot.taken += c.taken;
+            slot.notTaken += c.notTaken;
+        } else {
+            return false;
+        }
+    }
+    *this = std::move(parsed);
+    return true;
+}
+
+bool ExecutionProfile::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return parse(text);
+}
+
+bool ExecutionProfile::save(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    file << serialize();
+    return (bool)file;
+}
+
+} // namespace manifast
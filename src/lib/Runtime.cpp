@@ -1,4 +1,5 @@
 #include "manifast/Runtime.h"
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <cstdio>
@@ -19,6 +20,8 @@
 #endif
 
 #include "manifast/PlotBackend.h"
+#include "manifast/VecMath.h"
+#include "manifast/Sort.h"
 
 
 extern "C" {
@@ -140,13 +143,13 @@ static void plot_for_impl(Any* y_arr, Any* x_arr, Any* config) {
          if (x_arr && x_arr->type == ANY_ARRAY) {
              ManifastArray* xa = (ManifastArray*)x_arr->ptr;
              s.x.reserve(xa->size);
-             for (uint32_t i = 0; i < xa->size; i++) s.x.push_back(xa->elements[i].number);
-             for (uint32_t i = 0; i < ya->size; i++) s.y.push_back(ya->elements[i].number);
+             for (uint32_t i = 0; i < xa->size; i++) s.x.push_back(manifast_array_element(xa, i).number);
+             for (uint32_t i = 0; i < ya->size; i++) s.y.push_back(manifast_array_element(ya, i).number);
          } else {
              s.x.reserve(ya->size);
              for (uint32_t i = 0; i < ya->size; i++) {
                  s.x.push_back((double)(i + 1));
-                 s.y.push_back(ya->elements[i].number);
+                 s.y.push_back(manifast_array_element(ya, i).number);
              }
          }
          g_plot.addSeries(s);
@@ -190,6 +193,34 @@ MF_API void manifast_set_delay_callback(ManifastDelayCallback cb) {
     g_delay_callback = cb;
 }
 
+static thread_local ManifastCallHandler g_call_handler = nullptr;
+static thread_local void* g_call_vm = nullptr;
+
+MF_API void manifast_set_call_handler(ManifastCallHandler handler, void* vm) {
+    g_call_handler = handler;
+    g_call_vm = vm;
+}
+
+MF_API void manifast_get_call_handler(ManifastCallHandler* handler, void** vm) {
+    *handler = g_call_handler;
+    *vm = g_call_vm;
+}
+
+// Calls a native (type 4) or bytecode (type 5) function; the result goes to
+// *out, nothing is allocated on the runtime's budget
+static void call_function(Any* callee, Any* args, int nargs, Any* out) {
+    if (callee->type == 4) {
+        ManifastNativeFn fn = (ManifastNativeFn)callee->ptr;
+        std::vector<Any> call_args(nargs + 1);
+        for (int i = 0; i < nargs; ++i) call_args[i + 1] = args[i];
+        fn(g_call_vm, &call_args[1], nargs);
+        *out = call_args[0];
+        return;
+    }
+    if (!g_call_handler) MANIFAST_THROW("Runtime Error: Fungsi bytecode hanya dapat dipanggil saat VM berjalan");
+    *out = g_call_handler(g_call_vm, callee, args, nargs);
+}
+
 MF_API void* mf_malloc(size_t size) {
     if (size > 256 * 1024 * 1024) { // Hard cap 256MB
         MANIFAST_THROW("Error: Insane allocation size requested: " + std::to_string(size) + " bytes");
@@ -208,6 +239,27 @@ MF_API void* mf_malloc(size_t size) {
     return ptr;
 }
 
+// realloc under mf_malloc's budget; only the growth is counted
+static void* mf_realloc(void* ptr, size_t old_size, size_t new_size) {
+    size_t grown = new_size > old_size ? new_size - old_size : 0;
+    if (g_allocated_memory + grown > MANIFAST_MEM_LIMIT) {
+        MANIFAST_THROW("Error: Manifast memory limit exceeded (" + std::to_string(grown) + " bytes requested, " + std::to_string(g_allocated_memory) + " allocated)");
+    }
+    void* p = realloc(ptr, new_size);
+    if (!p) {
+        MANIFAST_THROW("Error: Out of memory (realloc failed for " + std::to_string(new_size) + " bytes)");
+    }
+    g_allocated_memory += grown;
+    return p;
+}
+
+// free() for blocks from mf_malloc/mf_realloc; `size` goes back to the budget
+static void mf_free(void* ptr, size_t size) {
+    if (!ptr) return;
+    free(ptr);
+    g_allocated_memory -= size < g_allocated_memory ? size : g_allocated_memory;
+}
+
 MF_API char* mf_strdup(const char* s) {
     if (!s) return nullptr;
     // Safety check for string length to prevent junk pointer crawl
@@ -270,6 +322,9 @@ MF_API Any* manifast_create_array(uint32_t initial_size) {
     arr->size = initial_size;
     arr->capacity = initial_size > 0 ? initial_size : 4;
     arr->elements = (Any*)mf_malloc(sizeof(Any) * arr->capacity);
+    arr->kind = ARRAY_ANY;
+    arr->shared = 0;
+    arr->hash = nullptr;
     
     // Initialize elements to 0
     for(uint32_t i = 0; i < arr->size; ++i) {
@@ -282,6 +337,44 @@ MF_API Any* manifast_create_array(uint32_t initial_size) {
     return a;
 }
 
+static size_t array_elem_size(uint32_t kind) {
+    switch (kind) {
+        case ARRAY_F64: return sizeof(double);
+        case ARRAY_I32: return sizeof(int32_t);
+        default: return sizeof(Any);
+    }
+}
+
+static bool is_number_any(const Any* v) {
+    return v->type == ANY_NUMBER || (v->type >= ANY_INT8 && v->type <= ANY_CHAR);
+}
+
+// Truncates like an i32 local; NaN and out-of-range values do not fit
+static bool number_to_i32(double d, int32_t* out) {
+    if (!(d > -2147483649.0 && d < 2147483648.0)) return false;
+    *out = (int32_t)d;
+    return true;
+}
+
+MF_API Any* manifast_create_typed_array(uint32_t size, uint32_t kind) {
+    if (kind != ARRAY_F64 && kind != ARRAY_I32) return manifast_create_array(size);
+    Any* a = (Any*)mf_malloc(sizeof(Any));
+    a->type = ANY_ARRAY;
+    a->number = 0;
+
+    ManifastArray* arr = (ManifastArray*)mf_malloc(sizeof(ManifastArray));
+    arr->size = size;
+    arr->capacity = size > 0 ? size : 4;
+    arr->kind = kind;
+    arr->shared = 0;
+    arr->hash = nullptr;
+    arr->elements = (Any*)mf_malloc(array_elem_size(kind) * arr->capacity);
+    memset(arr->elements, 0, array_elem_size(kind) * size); // 0.0 and 0 are all-zero bits
+
+    a->ptr = arr;
+    return a;
+}
+
 MF_API Any* manifast_create_object() {
     Any* a = (Any*)mf_malloc(sizeof(Any));
     a->type = ANY_OBJECT;
@@ -407,56 +500,259 @@ MF_API Any* manifast_object_get(Any* obj_any, const char* key) {
     return &nilVal;
 }
 
+MF_API Any manifast_array_element(const ManifastArray* arr, uint32_t index0) {
+    switch (arr->kind) {
+        case ARRAY_F64: return {ANY_NUMBER, arr->f64[index0], nullptr};
+        case ARRAY_I32: return {ANY_NUMBER, (double)arr->i32[index0], nullptr};
+        default: return arr->elements[index0];
+    }
+}
+
+MF_API void manifast_array_unshare(ManifastArray* arr) {
+    if (!arr->shared) return;
+    // No reference counts: the other side keeps the old storage and still
+    // copies on its first write
+    size_t width = array_elem_size(arr->kind);
+    uint32_t cap = arr->size > 0 ? arr->size : 4;
+    void* own = mf_malloc(width * cap);
+    memcpy(own, arr->elements, width * arr->size);
+    arr->elements = (Any*)own;
+    arr->capacity = cap;
+    arr->shared = 0;
+}
+
+MF_API Any* manifast_array_slice(Any* arr_any, int32_t first, int32_t last) {
+    if (arr_any->type != ANY_ARRAY) return manifast_create_nil();
+    ManifastArray* src = (ManifastArray*)arr_any->ptr;
+    if (first < 1) first = 1;
+    if (last > (int32_t)src->size) last = (int32_t)src->size;
+    if (last < first) return manifast_create_typed_array(0, src->kind);
+
+    Any* a = (Any*)mf_malloc(sizeof(Any));
+    a->type = ANY_ARRAY;
+    a->number = 0;
+    ManifastArray* view = (ManifastArray*)mf_malloc(sizeof(ManifastArray));
+    view->size = (uint32_t)(last - first + 1);
+    view->capacity = view->size; // growing always reallocates, i.e. copies
+    view->kind = src->kind;
+    view->elements = (Any*)((char*)src->elements + array_elem_size(src->kind) * (first - 1));
+    view->shared = 1;
+    view->hash = nullptr; // views cover the dense part only
+    src->shared = 1;
+    a->ptr = view;
+    return a;
+}
+
+static void array_reserve(ManifastArray* arr, uint32_t new_size) {
+    manifast_array_unshare(arr); // a view's storage is not ours to realloc
+    if (new_size <= arr->capacity) return;
+    uint64_t new_cap = arr->capacity > 0 ? (uint64_t)arr->capacity * 2 : 4;
+    while (new_cap < new_size) new_cap *= 2;
+    if (new_cap > UINT32_MAX) new_cap = UINT32_MAX;
+    size_t width = array_elem_size(arr->kind);
+    arr->elements = (Any*)mf_realloc(arr->elements, width * arr->capacity, width * new_cap);
+    arr->capacity = (uint32_t)new_cap;
+}
+
+// The value as an element of `arr`: packed arrays take numbers only, and i32
+// arrays truncate them
+static Any array_element_value(const ManifastArray* arr, const Any* val_any) {
+    if (arr->kind == ARRAY_ANY) return *val_any;
+    if (!is_number_any(val_any)) {
+        MANIFAST_THROW(std::string("TypeError: Array ") + (arr->kind == ARRAY_F64 ? "f64" : "i32") +
+                       " hanya dapat berisi angka");
+    }
+    if (arr->kind == ARRAY_F64) return {ANY_NUMBER, val_any->number, nullptr};
+    int32_t i;
+    if (!number_to_i32(val_any->number, &i)) {
+        MANIFAST_THROW("TypeError: Nilai " + std::to_string(val_any->number) + " di luar jangkauan i32");
+    }
+    return {ANY_NUMBER, (double)i, nullptr};
+}
+
+// Stores into a slot that already exists
+static void array_store(ManifastArray* arr, uint32_t index0, Any* val_any) {
+    Any v = array_element_value(arr, val_any);
+    manifast_array_unshare(arr);
+    switch (arr->kind) {
+        case ARRAY_F64: arr->f64[index0] = v.number; break;
+        case ARRAY_I32: arr->i32[index0] = (int32_t)v.number; break;
+        default: arr->elements[index0] = v; break;
+    }
+}
+
+// --- Sparse part: 0-based index -> value, open addressing with linear probing.
+// Values are already element values (array_element_value). Overwriting with nil
+// keeps the key; rehashing drops such entries. Keys below arr->size only ever
+// hold nil: the dense part owns those indices.
+struct ManifastArrayHash {
+    uint32_t count;    // used slots, nil values included
+    uint32_t capacity; // power of two
+    uint32_t* keys;    // ARRAY_HASH_EMPTY when unused
+    Any* values;
+};
+
+static const uint32_t ARRAY_HASH_EMPTY = UINT32_MAX; // index0 never reaches it
+
+static uint32_t array_hash_slot(const ManifastArrayHash* h, uint32_t key) {
+    return (uint32_t)(((uint64_t)key * 0x9E3779B97F4A7C15ull) >> 32) & (h->capacity - 1);
+}
+
+static Any* array_hash_find(const ManifastArrayHash* h, uint32_t key) {
+    if (!h) return nullptr;
+    for (uint32_t i = array_hash_slot(h, key);; i = (i + 1) & (h->capacity - 1)) {
+        if (h->keys[i] == key) return &h->values[i];
+        if (h->keys[i] == ARRAY_HASH_EMPTY) return nullptr;
+    }
+}
+
+static void array_hash_insert(ManifastArrayHash* h, uint32_t key, Any val) {
+    uint32_t i = array_hash_slot(h, key);
+    while (h->keys[i] != ARRAY_HASH_EMPTY) i = (i + 1) & (h->capacity - 1);
+    h->keys[i] = key;
+    h->values[i] = val;
+    h->count++;
+}
+
+// Rebuilds the table with room for one more live entry
+static void array_hash_rehash(ManifastArray* arr) {
+    ManifastArrayHash* old = arr->hash;
+    uint32_t live = 0;
+    for (uint32_t i = 0; old && i < old->capacity; i++) {
+        if (old->keys[i] != ARRAY_HASH_EMPTY && old->values[i].type != ANY_NIL) live++;
+    }
+    uint32_t cap = 8;
+    while ((uint64_t)(live + 1) * 4 > (uint64_t)cap * 3) cap *= 2; // load <= 3/4
+
+    ManifastArrayHash* h = old ? old : (ManifastArrayHash*)mf_malloc(sizeof(ManifastArrayHash));
+    uint32_t* old_keys = old ? old->keys : nullptr;
+    Any* old_values = old ? old->values : nullptr;
+    uint32_t old_cap = old ? old->capacity : 0;
+    h->count = 0;
+    h->capacity = cap;
+    h->keys = (uint32_t*)mf_malloc(sizeof(uint32_t) * cap);
+    h->values = (Any*)mf_malloc(sizeof(Any) * cap);
+    memset(h->keys, 0xFF, sizeof(uint32_t) * cap);
+    for (uint32_t i = 0; i < old_cap; i++) {
+        if (old_keys[i] != ARRAY_HASH_EMPTY && old_values[i].type != ANY_NIL) {
+            array_hash_insert(h, old_keys[i], old_values[i]);
+        }
+    }
+    mf_free(old_keys, sizeof(uint32_t) * old_cap);
+    mf_free(old_values, sizeof(Any) * old_cap);
+    arr->hash = h;
+}
+
+static void array_hash_put(ManifastArray* arr, uint32_t key, Any val) {
+    if (Any* slot = array_hash_find(arr->hash, key)) {
+        *slot = val;
+        return;
+    }
+    if (val.type == ANY_NIL) return; // missing already reads as nil
+    if (!arr->hash || (uint64_t)(arr->hash->count + 1) * 4 > (uint64_t)arr->hash->capacity * 3) {
+        array_hash_rehash(arr);
+    }
+    array_hash_insert(arr->hash, key, val);
+}
+
+// Moves the entry for dense index `index0` (now < size) out of the hash
+static void array_hash_take(ManifastArray* arr, uint32_t index0) {
+    Any* v = array_hash_find(arr->hash, index0);
+    if (!v || v->type == ANY_NIL) return;
+    Any val = *v;
+    *v = {ANY_NIL, 0.0, nullptr};
+    array_store(arr, index0, &val);
+}
+
+// After the dense part grew by one: pull in the run of entries that follows it
+static void array_hash_absorb(ManifastArray* arr) {
+    if (!arr->hash) return;
+    for (;;) {
+        Any* v = array_hash_find(arr->hash, arr->size);
+        if (!v || v->type == ANY_NIL) return;
+        array_reserve(arr, arr->size + 1);
+        arr->size++;
+        array_hash_take(arr, arr->size - 1);
+    }
+}
+
+// Extends the dense part to new_size. New slots are nil (packed arrays: zero)
+// unless the hash part had them; the run of entries right after is pulled in too.
+static void array_grow(ManifastArray* arr, uint32_t new_size) {
+    uint32_t old_size = arr->size;
+    array_reserve(arr, new_size);
+    if (arr->kind == ARRAY_ANY) {
+        for (uint32_t i = old_size; i < new_size; i++) arr->elements[i] = (Any){3, 0.0, nullptr};
+    } else {
+        size_t width = array_elem_size(arr->kind);
+        memset((char*)arr->elements + width * old_size, 0, width * (new_size - old_size));
+    }
+    arr->size = new_size;
+    if (arr->hash) {
+        for (uint32_t i = old_size; i < new_size; i++) array_hash_take(arr, i);
+        array_hash_absorb(arr);
+    }
+}
+
 MF_API void manifast_array_set(Any* arr_any, double index_d, Any* val_any) {
+    if (arr_any->type == ANY_MAP) { // m[2] = v compiled as an array store
+        Any key = {ANY_NUMBER, index_d, nullptr};
+        manifast_map_set(arr_any, &key, val_any);
+        return;
+    }
     if (arr_any->type != 6) return;
     ManifastArray* arr = (ManifastArray*)arr_any->ptr;
-    uint32_t index = (uint32_t)index_d;
     
-    if (index < 1) {
-        fprintf(stderr, "Error: Array index must be >= 1 (got %u)\n", index);
+    if (!(index_d >= 1.0 && index_d < 4294967296.0)) {
+        fprintf(stderr, "Error: Array index must be between 1 and 4294967295 (got %g)\n", index_d);
         return;
     }
-    index--; // Convert to 0-based internal
+    uint32_t index = (uint32_t)index_d - 1; // Convert to 0-based internal
     
-    if (index >= arr->size) {
-        // Auto-expand if within reasonable bounds?
-        // For now just error or resize
-        if (index < 1000000) {
-            uint32_t new_size = index + 1;
-            if (new_size > arr->capacity) {
-                uint32_t new_cap = arr->capacity * 2;
-                while (new_cap < new_size) new_cap *= 2;
-                arr->elements = (Any*)realloc(arr->elements, sizeof(Any) * new_cap);
-                arr->capacity = new_cap;
-            }
-            // Init new elements to nil
-            for (uint32_t i = arr->size; i < new_size; i++) {
-                arr->elements[i] = (Any){3, 0.0, nullptr};
-            }
-            arr->size = new_size;
-        } else {
-             fprintf(stderr, "Error: Array index out of bounds: %u (size %u)\n", index + 1, arr->size);
-             return;
-        }
+    if (index < arr->size) {
+        array_store(arr, index, val_any);
+        return;
     }
-    
-    arr->elements[index] = *val_any;
+
+    // Grow the dense part while it stays at least about half full; anything
+    // further out goes to the hash part instead of nil-filling the gap
+    if ((uint64_t)index >= (uint64_t)arr->size * 2 + 16) {
+        array_hash_put(arr, index, array_element_value(arr, val_any));
+        return;
+    }
+
+    Any v = array_element_value(arr, val_any); // before growing, in case it throws
+    array_grow(arr, index + 1);
+    array_store(arr, index, &v);
 }
 
 MF_API Any* manifast_array_get(Any* arr_any, double index_d) {
     static Any nilVal = {3, 0.0, nullptr};
+    static thread_local Any scratch;
+    if (arr_any->type == ANY_MAP) {
+        Any key = {ANY_NUMBER, index_d, nullptr};
+        return manifast_map_get(arr_any, &key);
+    }
     if (arr_any->type != 6) return &nilVal;
     ManifastArray* arr = (ManifastArray*)arr_any->ptr;
-    uint32_t index = (uint32_t)index_d;
+    if (!(index_d >= 1.0 && index_d < 4294967296.0)) return &nilVal;
+    uint32_t index = (uint32_t)index_d - 1;
 
-    if (index < 1 || (index - 1) >= arr->size) {
-        return &nilVal;
+    if (index >= arr->size) {
+        // Hash values are plain Anys for every kind
+        Any* v = array_hash_find(arr->hash, index);
+        return v ? v : &nilVal;
     }
     
-    return &arr->elements[index - 1];
+    if (arr->kind != ARRAY_ANY) {
+        scratch = manifast_array_element(arr, index);
+        return &scratch;
+    }
+    return &arr->elements[index];
 }
 
 MF_API double manifast_array_len(Any* arr_any) {
+    if (arr_any->type == ANY_MAP) return manifast_map_len(arr_any); // len(m)
     if (arr_any->type != 6) return 0;
     ManifastArray* arr = (ManifastArray*)arr_any->ptr;
     return (double)arr->size;
@@ -466,15 +762,10 @@ MF_API void manifast_array_push(Any* arr_any, Any* val_any) {
     if (arr_any->type != 6) return;
     ManifastArray* arr = (ManifastArray*)arr_any->ptr;
     
-    if (arr->size == arr->capacity) {
-        uint32_t new_cap = arr->capacity * 2;
-        if (new_cap == 0) new_cap = 4;
-        arr->elements = (Any*)realloc(arr->elements, sizeof(Any) * new_cap);
-        arr->capacity = new_cap;
-    }
-    
-    arr->elements[arr->size] = *val_any;
-    arr->size++;
+    Any v = array_element_value(arr, val_any);
+    uint32_t index = arr->size;
+    array_grow(arr, index + 1);
+    array_store(arr, index, &v);
 }
 
 MF_API Any* manifast_array_pop(Any* arr_any) {
@@ -482,7 +773,7 @@ MF_API Any* manifast_array_pop(Any* arr_any) {
     ManifastArray* arr = (ManifastArray*)arr_any->ptr;
     if (arr->size == 0) return manifast_create_nil();
     
-    Any val = arr->elements[arr->size - 1];
+    Any val = manifast_array_element(arr, arr->size - 1);
     arr->size--;
     
     Any* res = (Any*)mf_malloc(sizeof(Any));
@@ -490,13 +781,612 @@ MF_API Any* manifast_array_pop(Any* arr_any) {
     return res;
 }
 
+// 1-based count/position argument as a uint32; false if out of range
+static bool array_count(double d, uint32_t* out) {
+    if (!(d >= 0.0 && d < 4294967296.0)) return false;
+    *out = (uint32_t)d;
+    return true;
+}
+
+MF_API void manifast_array_reserve(Any* arr_any, double capacity) {
+    if (arr_any->type != ANY_ARRAY) return;
+    uint32_t cap;
+    if (!array_count(capacity, &cap)) MANIFAST_THROW("Error: Kapasitas array tidak valid: " + std::to_string(capacity));
+    array_reserve((ManifastArray*)arr_any->ptr, cap);
+}
+
+MF_API void manifast_array_fill(Any* arr_any, Any* val_any, double first_d, double last_d) {
+    if (arr_any->type != ANY_ARRAY) return;
+    ManifastArray* arr = (ManifastArray*)arr_any->ptr;
+    uint32_t first, last;
+    if (!array_count(first_d, &first) || !array_count(last_d, &last)) {
+        MANIFAST_THROW("Error: Rentang fill tidak valid (" + std::to_string(first_d) + " ke " + std::to_string(last_d) + ")");
+    }
+    if (first < 1) first = 1;
+    if (last < first) return;
+
+    Any v = array_element_value(arr, val_any);
+    if (last > arr->size) array_grow(arr, last);
+    manifast_array_unshare(arr);
+    switch (arr->kind) {
+        case ARRAY_F64: std::fill(arr->f64 + first - 1, arr->f64 + last, v.number); break;
+        case ARRAY_I32: std::fill(arr->i32 + first - 1, arr->i32 + last, (int32_t)v.number); break;
+        default: std::fill(arr->elements + first - 1, arr->elements + last, v); break;
+    }
+}
+
+// Appends src's elements to out's dense part (out has the room)
+static void array_append(ManifastArray* out, const ManifastArray* src) {
+    if (src->kind == out->kind) {
+        size_t width = array_elem_size(out->kind);
+        memcpy((char*)out->elements + width * out->size, src->elements, width * src->size);
+        out->size += src->size;
+        return;
+    }
+    for (uint32_t i = 0; i < src->size; i++) {
+        Any e = manifast_array_element(src, i);
+        array_store(out, out->size, &e);
+        out->size++;
+    }
+}
+
+MF_API Any* manifast_array_concat(Any* arr_any, Any* others, int n) {
+    if (arr_any->type != ANY_ARRAY) return manifast_create_nil();
+    ManifastArray* arr = (ManifastArray*)arr_any->ptr;
+    uint64_t total = arr->size;
+    for (int k = 0; k < n; k++) {
+        total += others[k].type == ANY_ARRAY ? ((ManifastArray*)others[k].ptr)->size : 1;
+    }
+    if (total > UINT32_MAX) MANIFAST_THROW("Error: Hasil concat terlalu besar (" + std::to_string(total) + " elemen)");
+
+    Any* res = manifast_create_typed_array(0, arr->kind);
+    ManifastArray* out = (ManifastArray*)res->ptr;
+    array_reserve(out, (uint32_t)total);
+    array_append(out, arr);
+    for (int k = 0; k < n; k++) {
+        if (others[k].type == ANY_ARRAY) {
+            array_append(out, (ManifastArray*)others[k].ptr);
+        } else {
+            array_store(out, out->size, &others[k]);
+            out->size++;
+        }
+    }
+    return res;
+}
+
+// The VM's `==`
+static bool values_equal(const Any* a, const Any* b) {
+    if (a->type == b->type) {
+        switch (a->type) {
+            case ANY_NUMBER: case ANY_BOOLEAN: return a->number == b->number;
+            case ANY_STRING: return a->ptr && b->ptr && strcmp((char*)a->ptr, (char*)b->ptr) == 0;
+            case ANY_NIL: return true;
+            default: return false;
+        }
+    }
+    bool mixed = (a->type == ANY_NUMBER && b->type == ANY_BOOLEAN) || (a->type == ANY_BOOLEAN && b->type == ANY_NUMBER);
+    return mixed && a->number == b->number;
+}
+
+MF_API double manifast_array_index_of(Any* arr_any, Any* val_any, double from) {
+    if (arr_any->type != ANY_ARRAY) return 0;
+    ManifastArray* arr = (ManifastArray*)arr_any->ptr;
+    uint32_t start = from >= 1.0 ? (from < 4294967296.0 ? (uint32_t)from : UINT32_MAX) : 1;
+    if (arr->kind != ARRAY_ANY) {
+        // Packed elements are numbers: only numbers and booleans can match
+        if (val_any->type != ANY_NUMBER && val_any->type != ANY_BOOLEAN) return 0;
+        double x = val_any->number;
+        for (uint32_t i = start - 1; i < arr->size; i++) {
+            if ((arr->kind == ARRAY_F64 ? arr->f64[i] : (double)arr->i32[i]) == x) return i + 1;
+        }
+        return 0;
+    }
+    for (uint32_t i = start - 1; i < arr->size; i++) {
+        if (values_equal(&arr->elements[i], val_any)) return i + 1;
+    }
+    return 0;
+}
+
+MF_API void manifast_array_reverse(Any* arr_any) {
+    if (arr_any->type != ANY_ARRAY) return;
+    ManifastArray* arr = (ManifastArray*)arr_any->ptr;
+    manifast_array_unshare(arr);
+    switch (arr->kind) {
+        case ARRAY_F64: std::reverse(arr->f64, arr->f64 + arr->size); break;
+        case ARRAY_I32: std::reverse(arr->i32, arr->i32 + arr->size); break;
+        default: std::reverse(arr->elements, arr->elements + arr->size); break;
+    }
+}
+
+static bool less_string(const char* a, const char* b) { return strcmp(a ? a : "", b ? b : "") < 0; }
+
+MF_API bool manifast_array_sort(Any* arr_any) {
+    if (arr_any->type != ANY_ARRAY) return false;
+    ManifastArray* arr = (ManifastArray*)arr_any->ptr;
+    manifast_array_unshare(arr);
+    switch (arr->kind) {
+        case ARRAY_F64: manifast::sort::sortNumbers(arr->f64, arr->size); return true;
+        case ARRAY_I32: manifast::sort::sortInt32(arr->i32, arr->size); return true;
+        default: break;
+    }
+    if (arr->size == 0) return true;
+
+    // Boxed arrays: sort the bare numbers or string pointers, then rebox
+    int32_t type = arr->elements[0].type;
+    if (type != ANY_NUMBER && type != ANY_STRING) return false;
+    for (uint32_t i = 1; i < arr->size; i++) {
+        if (arr->elements[i].type != type) return false;
+    }
+    if (type == ANY_NUMBER) {
+        std::vector<double> keys(arr->size);
+        for (uint32_t i = 0; i < arr->size; i++) keys[i] = arr->elements[i].number;
+        manifast::sort::sortNumbers(keys.data(), keys.size());
+        for (uint32_t i = 0; i < arr->size; i++) arr->elements[i].number = keys[i];
+    } else {
+        std::vector<const char*> keys(arr->size);
+        for (uint32_t i = 0; i < arr->size; i++) keys[i] = (const char*)arr->elements[i].ptr;
+        manifast::sort::introsort(keys.data(), keys.data() + keys.size(), less_string);
+        for (uint32_t i = 0; i < arr->size; i++) arr->elements[i].ptr = (void*)keys[i];
+    }
+    return true;
+}
+
+MF_API Any* manifast_array_packed(Any* arr_any, uint32_t kind) {
+    if (arr_any->type != ANY_ARRAY || (kind != ARRAY_F64 && kind != ARRAY_I32)) return nullptr;
+    ManifastArray* arr = (ManifastArray*)arr_any->ptr;
+    // Already packed: a copy-on-write view is enough (views cover the dense
+    // part only, so arrays with a sparse part take the copy below)
+    if (arr->kind == kind && !arr->hash) return manifast_array_slice(arr_any, 1, (int32_t)arr->size);
+
+    ManifastArrayHash* h = arr->hash;
+    for (uint32_t i = 0; h && i < h->capacity; i++) {
+        const Any& v = h->values[i];
+        int32_t unused;
+        if (h->keys[i] == ARRAY_HASH_EMPTY || v.type == ANY_NIL) continue;
+        if (!is_number_any(&v) || (kind == ARRAY_I32 && !number_to_i32(v.number, &unused))) return nullptr;
+    }
+
+    Any* res = manifast_create_typed_array(arr->size, kind);
+    ManifastArray* out = (ManifastArray*)res->ptr;
+    for (uint32_t i = 0; i < arr->size; i++) {
+        Any v = manifast_array_element(arr, i);
+        bool ok = is_number_any(&v);
+        if (ok && kind == ARRAY_F64) out->f64[i] = v.number;
+        else if (ok) ok = number_to_i32(v.number, &out->i32[i]);
+        if (!ok) {
+            mf_free(out->elements, array_elem_size(kind) * out->capacity);
+            mf_free(out, sizeof(ManifastArray));
+            mf_free(res, sizeof(Any));
+            return nullptr;
+        }
+    }
+    for (uint32_t i = 0; h && i < h->capacity; i++) {
+        if (h->keys[i] != ARRAY_HASH_EMPTY && h->values[i].type != ANY_NIL) {
+            array_hash_put(out, h->keys[i], array_element_value(out, &h->values[i]));
+        }
+    }
+    return res;
+}
+
+MF_API void manifast_type_check_array(Any* val, uint32_t kind) {
+    manifast_type_check(val, ANY_ARRAY);
+    Any* packed = manifast_array_packed(val, kind);
+    if (!packed) {
+        MANIFAST_THROW(std::string("TypeError: Diharapkan tipe ") + (kind == ARRAY_F64 ? "f64[]" : "i32[]") +
+                       ", tapi array berisi nilai yang bukan " + (kind == ARRAY_F64 ? "angka" : "angka i32"));
+    }
+    *val = *packed;
+}
+
+// --- Hash maps ---
+static uint32_t map_mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return (uint32_t)h;
+}
+
+// Checks and normalizes a key: numeric types become plain numbers, -0 is 0.
+// Returns its hash.
+static uint32_t map_key(const Any* key, Any* out) {
+    if (is_number_any(key)) {
+        if (key->number != key->number) MANIFAST_THROW("TypeError: Kunci map tidak boleh NaN");
+        *out = {ANY_NUMBER, key->number == 0 ? 0.0 : key->number, nullptr};
+        uint64_t bits;
+        memcpy(&bits, &out->number, sizeof bits);
+        return map_mix(bits);
+    }
+    if (key->type == ANY_STRING && key->ptr) {
+        *out = *key;
+        uint64_t h = 14695981039346656037ull; // FNV-1a
+        for (const unsigned char* c = (const unsigned char*)key->ptr; *c; c++) h = (h ^ *c) * 1099511628211ull;
+        return map_mix(h);
+    }
+    MANIFAST_THROW("TypeError: Kunci map harus angka atau string");
+}
+
+static bool map_key_equal(const Any* a, const Any* b) {
+    if (a->type != b->type) return false;
+    if (a->type == ANY_NUMBER) return a->number == b->number;
+    return strcmp((const char*)a->ptr, (const char*)b->ptr) == 0;
+}
+
+static ManifastMap* map_of(Any* map_any) {
+    if (map_any->type != ANY_MAP) MANIFAST_THROW("TypeError: Diharapkan map");
+    return (ManifastMap*)map_any->ptr;
+}
+
+static ManifastMapEntry* map_find(ManifastMap* m, const Any* key, uint32_t hash) {
+    if (m->capacity == 0) return nullptr;
+    uint32_t mask = m->capacity - 1;
+    for (uint32_t i = hash & mask;; i = (i + 1) & mask) { // load <= 3/4: an empty slot ends the probe
+        ManifastMapEntry* e = &m->entries[i];
+        if (e->state == MAP_EMPTY) return nullptr;
+        if (e->state == MAP_LIVE && e->hash == hash && map_key_equal(&e->key, key)) return e;
+    }
+}
+
+// Rebuilds the table without deleted slots, with room for one more entry
+static void map_rehash(ManifastMap* m) {
+    uint32_t cap = 8;
+    while ((uint64_t)(m->count + 1) * 2 > cap) cap *= 2; // at most half full afterwards
+    ManifastMapEntry* old = m->entries;
+    uint32_t old_cap = m->capacity;
+    m->entries = (ManifastMapEntry*)mf_malloc(sizeof(ManifastMapEntry) * cap);
+    memset(m->entries, 0, sizeof(ManifastMapEntry) * cap); // MAP_EMPTY
+    m->capacity = cap;
+    m->used = m->count;
+    for (uint32_t k = 0; k < old_cap; k++) {
+        if (old[k].state != MAP_LIVE) continue;
+        uint32_t i = old[k].hash & (cap - 1);
+        while (m->entries[i].state != MAP_EMPTY) i = (i + 1) & (cap - 1);
+        m->entries[i] = old[k];
+    }
+    mf_free(old, sizeof(ManifastMapEntry) * old_cap);
+}
+
+static void map_remove(ManifastMap* m, ManifastMapEntry* e) {
+    // map.each hands callbacks the entry's own key; while one runs, a deleted
+    // key is left alive for it instead of freed
+    if (e->key.type == ANY_STRING && m->iterating == 0) mf_free(e->key.ptr, strlen((const char*)e->key.ptr) + 1);
+    e->key = {ANY_NIL, 0.0, nullptr};
+    e->value = {ANY_NIL, 0.0, nullptr};
+    e->state = MAP_DELETED;
+    m->count--;
+}
+
+MF_API Any* manifast_create_map() {
+    Any* a = (Any*)mf_malloc(sizeof(Any));
+    ManifastMap* m = (ManifastMap*)mf_malloc(sizeof(ManifastMap));
+    m->count = 0;
+    m->used = 0;
+    m->capacity = 0;
+    m->iterating = 0;
+    m->entries = nullptr;
+    *a = {ANY_MAP, 0.0, m};
+    return a;
+}
+
+MF_API Any* manifast_map_get(Any* map_any, Any* key) {
+    static Any nilVal = {3, 0.0, nullptr};
+    ManifastMap* m = map_of(map_any);
+    Any k;
+    uint32_t hash = map_key(key, &k);
+    ManifastMapEntry* e = map_find(m, &k, hash);
+    return e ? &e->value : &nilVal;
+}
+
+MF_API void manifast_map_set(Any* map_any, Any* key, Any* val) {
+    ManifastMap* m = map_of(map_any);
+    Any k;
+    uint32_t hash = map_key(key, &k);
+    ManifastMapEntry* e = map_find(m, &k, hash);
+    if (val->type == ANY_NIL) {
+        if (e) map_remove(m, e);
+        return;
+    }
+    if (e) {
+        e->value = *val;
+        return;
+    }
+
+    if ((uint64_t)(m->used + 1) * 4 > (uint64_t)m->capacity * 3) map_rehash(m);
+    uint32_t mask = m->capacity - 1;
+    uint32_t i = hash & mask;
+    while (m->entries[i].state == MAP_LIVE) i = (i + 1) & mask; // reuse a deleted slot
+    e = &m->entries[i];
+    if (e->state == MAP_EMPTY) m->used++;
+    if (k.type == ANY_STRING) k.ptr = mf_strdup((const char*)k.ptr);
+    *e = {k, *val, hash, MAP_LIVE};
+    m->count++;
+}
+
+MF_API bool manifast_map_delete(Any* map_any, Any* key) {
+    ManifastMap* m = map_of(map_any);
+    Any k;
+    uint32_t hash = map_key(key, &k);
+    ManifastMapEntry* e = map_find(m, &k, hash);
+    if (!e) return false;
+    map_remove(m, e);
+    return true;
+}
+
+MF_API double manifast_map_len(Any* map_any) {
+    return map_any->type == ANY_MAP ? (double)((ManifastMap*)map_any->ptr)->count : 0;
+}
+
+MF_API bool manifast_map_next(Any* map_any, uint32_t* cursor, Any* key, Any* val) {
+    ManifastMap* m = map_of(map_any);
+    for (; *cursor < m->capacity; (*cursor)++) {
+        ManifastMapEntry* e = &m->entries[*cursor];
+        if (e->state != MAP_LIVE) continue;
+        *key = e->key;
+        if (key->type == ANY_STRING) key->ptr = mf_strdup((const char*)key->ptr); // ours dies with the entry
+        *val = e->value;
+        (*cursor)++;
+        return true;
+    }
+    return false;
+}
+
+MF_API Any* manifast_index_get(Any* obj, Any* key) {
+    static Any nilVal = {3, 0.0, nullptr};
+    if (obj->type == ANY_MAP) return manifast_map_get(obj, key);
+    if (obj->type == ANY_OBJECT && key->type == ANY_STRING) return manifast_object_get(obj, (const char*)key->ptr);
+    if (is_number_any(key)) return manifast_array_get(obj, key->number);
+    return &nilVal;
+}
+
+MF_API void manifast_index_set(Any* obj, Any* key, Any* val) {
+    if (obj->type == ANY_MAP) manifast_map_set(obj, key, val);
+    else if (obj->type == ANY_OBJECT && key->type == ANY_STRING) manifast_object_set(obj, (const char*)key->ptr, val);
+    else if (is_number_any(key)) manifast_array_set(obj, key->number, val);
+}
+
+static void map_clear(ManifastMap* m) {
+    for (uint32_t i = 0; i < m->capacity; i++) {
+        if (m->entries[i].state == MAP_LIVE && m->entries[i].key.type == ANY_STRING && m->iterating == 0) {
+            mf_free(m->entries[i].key.ptr, strlen((const char*)m->entries[i].key.ptr) + 1);
+        }
+    }
+    if (m->capacity) memset(m->entries, 0, sizeof(ManifastMapEntry) * m->capacity);
+    m->count = 0;
+    m->used = 0;
+}
+
+// `map` module. Called as map.fn(...) the module itself comes first.
+static Any* map_args(Any* args, int nargs, int need, const char* fn) {
+    int idx = (nargs >= 1 && args[0].type == ANY_OBJECT) ? 1 : 0;
+    if (nargs - idx < need || args[idx].type != ANY_MAP) {
+        MANIFAST_THROW(std::string("TypeError: map.") + fn + "() membutuhkan map sebagai argumen pertama");
+    }
+    return args + idx;
+}
+
+static void map_new(void* vm, Any* args, int nargs) { args[-1] = *manifast_create_map(); }
+static void map_set(void* vm, Any* args, int nargs) {
+    Any* a = map_args(args, nargs, 3, "set");
+    manifast_map_set(&a[0], &a[1], &a[2]);
+    args[-1] = a[0];
+}
+static void map_get(void* vm, Any* args, int nargs) {
+    Any* a = map_args(args, nargs, 2, "get");
+    Any v = *manifast_map_get(&a[0], &a[1]);
+    bool has_default = nargs - (int)(a - args) >= 3; // map.get(m, k, default)
+    args[-1] = (v.type == ANY_NIL && has_default) ? a[2] : v;
+}
+static void map_has(void* vm, Any* args, int nargs) {
+    Any* a = map_args(args, nargs, 2, "has");
+    args[-1] = {ANY_BOOLEAN, manifast_map_get(&a[0], &a[1])->type != ANY_NIL ? 1.0 : 0.0, nullptr};
+}
+static void map_delete(void* vm, Any* args, int nargs) {
+    Any* a = map_args(args, nargs, 2, "delete");
+    args[-1] = {ANY_BOOLEAN, manifast_map_delete(&a[0], &a[1]) ? 1.0 : 0.0, nullptr};
+}
+static void map_size(void* vm, Any* args, int nargs) {
+    Any* a = map_args(args, nargs, 1, "size");
+    args[-1] = {ANY_NUMBER, manifast_map_len(&a[0]), nullptr};
+}
+static void map_clear_fn(void* vm, Any* args, int nargs) {
+    Any* a = map_args(args, nargs, 1, "clear");
+    map_clear((ManifastMap*)a[0].ptr);
+    args[-1] = a[0];
+}
+static void map_collect(Any* args, int nargs, const char* fn, bool keys) {
+    Any* a = map_args(args, nargs, 1, fn);
+    ManifastMap* m = (ManifastMap*)a[0].ptr;
+    Any* res = manifast_create_array(0);
+    manifast_array_reserve(res, m->count);
+    for (uint32_t i = 0; i < m->capacity; i++) {
+        ManifastMapEntry* e = &m->entries[i];
+        if (e->state != MAP_LIVE) continue;
+        Any v = keys ? e->key : e->value;
+        if (keys && v.type == ANY_STRING) v.ptr = mf_strdup((const char*)v.ptr); // outlives the entry
+        manifast_array_push(res, &v);
+    }
+    args[-1] = *res;
+}
+static void map_keys(void* vm, Any* args, int nargs) { map_collect(args, nargs, "keys", true); }
+static void map_values(void* vm, Any* args, int nargs) { map_collect(args, nargs, "values", false); }
+// map.each(m, fn): fn(key, value) for each entry present when the call
+// starts, in slot order. The callback may change the map: entries it adds
+// are not visited, entries it deletes are skipped, and a rehash it triggers
+// does not disturb the walk.
+static void map_each(void* vm, Any* args, int nargs) {
+    Any* a = map_args(args, nargs, 2, "each");
+    Any fn = a[1];
+    if (fn.type != 4 && fn.type != 5) MANIFAST_THROW("TypeError: map.each() membutuhkan fungsi sebagai argumen kedua");
+    ManifastMap* m = (ManifastMap*)a[0].ptr;
+    struct Iterating {
+        ManifastMap* m;
+        ~Iterating() { m->iterating--; }
+    } guard{m};
+    m->iterating++;
+    // Walk a snapshot of the keys; while iterating is set their strings stay
+    // alive even if the callback deletes them
+    std::vector<ManifastMapEntry> snapshot;
+    snapshot.reserve(m->count);
+    for (uint32_t i = 0; i < m->capacity; i++) {
+        if (m->entries[i].state == MAP_LIVE) snapshot.push_back(m->entries[i]);
+    }
+    for (ManifastMapEntry& s : snapshot) {
+        ManifastMapEntry* e = map_find(m, &s.key, s.hash);
+        if (!e) continue;
+        Any kv[2] = {e->key, e->value};
+        Any ignored;
+        call_function(&fn, kv, 2, &ignored);
+    }
+    args[-1] = {ANY_NIL, 0.0, nullptr};
+}
+
 // --- Native Math Functions ---
 #define MATH_BEGIN() \
     int idx = 0; \
     if (nargs >= 1 && args[0].type != 0) idx++; \
     if (nargs - idx < 1) { args[-1] = {3, 0.0, nullptr}; return; }
 
-static void m_sin(void* vm, Any* args, int nargs) { MATH_BEGIN(); args[-1] = {0, sin(args[idx].number), nullptr}; }
+// --- Whole-array forms (manifast::vecmath kernels) ---
+// f64[] arrays are read in place; other arrays are copied out first.
+struct NumberSpan {
+    const double* data = nullptr;
+    uint32_t size = 0;
+    std::vector<double> copy;
+};
+
+static NumberSpan number_span(const Any* arr_any, const char* fn) {
+    ManifastArray* arr = (ManifastArray*)arr_any->ptr;
+    NumberSpan span;
+    span.size = arr->size;
+    if (arr->kind == ARRAY_F64) {
+        span.data = arr->f64;
+        return span;
+    }
+    span.copy.resize(arr->size);
+    for (uint32_t i = 0; i < arr->size; i++) {
+        Any v = manifast_array_element(arr, i);
+        if (!is_number_any(&v)) MANIFAST_THROW(std::string("TypeError: math.") + fn + " membutuhkan array berisi angka");
+        span.copy[i] = v.number;
+    }
+    span.data = span.copy.data();
+    return span;
+}
+
+static int math_self(Any* args, int nargs) { return (nargs >= 1 && args[0].type == ANY_OBJECT) ? 1 : 0; }
+
+// The array that receives `size` results: `out` if given (same length), else a new f64[]
+static ManifastArray* math_output(Any* out, uint32_t size, const char* fn, Any* result) {
+    if (out && out->type == ANY_ARRAY) {
+        ManifastArray* arr = (ManifastArray*)out->ptr;
+        if (arr->size != size) {
+            MANIFAST_THROW(std::string("math.") + fn + ": array keluaran harus sepanjang " + std::to_string(size));
+        }
+        *result = *out;
+        return arr;
+    }
+    *result = *manifast_create_typed_array(size, ARRAY_F64);
+    return (ManifastArray*)result->ptr;
+}
+
+// Kernels write an f64[] output directly; other outputs go through `tmp`
+// and math_commit
+static double* math_buffer(ManifastArray* out, std::vector<double>& tmp) {
+    if (out->kind == ARRAY_F64) {
+        manifast_array_unshare(out);
+        return out->f64;
+    }
+    tmp.resize(out->size);
+    return tmp.data();
+}
+
+static void math_commit(ManifastArray* out, const std::vector<double>& tmp) {
+    if (out->kind == ARRAY_F64) return;
+    for (uint32_t i = 0; i < out->size; i++) {
+        Any v = {ANY_NUMBER, tmp[i], nullptr};
+        array_store(out, i, &v);
+    }
+}
+
+// math.f(arr [, out]): elementwise into `out` (may be arr itself) or a new f64[]
+static bool math_map(Any* args, int nargs, const char* fn, void (*kernel)(const double*, double*, size_t)) {
+    int idx = math_self(args, nargs);
+    if (nargs - idx < 1 || args[idx].type != ANY_ARRAY) return false;
+    NumberSpan x = number_span(&args[idx], fn);
+    Any result;
+    ManifastArray* out = math_output(nargs - idx >= 2 ? &args[idx + 1] : nullptr, x.size, fn, &result);
+    std::vector<double> tmp;
+    kernel(x.data, math_buffer(out, tmp), x.size);
+    math_commit(out, tmp);
+    args[-1] = result;
+    return true;
+}
+
+static void m_sum(void* vm, Any* args, int nargs) {
+    int idx = math_self(args, nargs);
+    args[-1] = {3, 0.0, nullptr};
+    if (nargs - idx < 1 || args[idx].type != ANY_ARRAY) return;
+    NumberSpan x = number_span(&args[idx], "sum");
+    args[-1] = {0, manifast::vecmath::sum(x.data, x.size), nullptr};
+}
+
+static void m_dot(void* vm, Any* args, int nargs) {
+    int idx = math_self(args, nargs);
+    args[-1] = {3, 0.0, nullptr};
+    if (nargs - idx < 2 || args[idx].type != ANY_ARRAY || args[idx + 1].type != ANY_ARRAY) return;
+    NumberSpan x = number_span(&args[idx], "dot");
+    NumberSpan y = number_span(&args[idx + 1], "dot");
+    if (x.size != y.size) MANIFAST_THROW("math.dot: kedua array harus sama panjang");
+    args[-1] = {0, manifast::vecmath::dot(x.data, y.data, x.size), nullptr};
+}
+
+// math.axpy(a, x, y): y += a * x in place, returns y
+static void m_axpy(void* vm, Any* args, int nargs) {
+    int idx = math_self(args, nargs);
+    args[-1] = {3, 0.0, nullptr};
+    if (nargs - idx < 3 || args[idx].type != ANY_NUMBER || args[idx + 1].type != ANY_ARRAY || args[idx + 2].type != ANY_ARRAY) return;
+    double a = args[idx].number;
+    NumberSpan x = number_span(&args[idx + 1], "axpy");
+    ManifastArray* y = (ManifastArray*)args[idx + 2].ptr;
+    if (y->size != x.size) MANIFAST_THROW("math.axpy: x dan y harus sama panjang");
+    std::vector<double> tmp;
+    double* dst = math_buffer(y, tmp);
+    if (y->kind != ARRAY_F64) {
+        NumberSpan current = number_span(&args[idx + 2], "axpy");
+        for (uint32_t i = 0; i < x.size; i++) dst[i] = current.data[i];
+    }
+    manifast::vecmath::axpy(a, x.data, dst, x.size);
+    math_commit(y, tmp);
+    args[-1] = args[idx + 2];
+}
+
+static void m_mean(void* vm, Any* args, int nargs) {
+    int idx = math_self(args, nargs);
+    args[-1] = {3, 0.0, nullptr};
+    if (nargs - idx < 1 || args[idx].type != ANY_ARRAY) return;
+    NumberSpan x = number_span(&args[idx], "mean");
+    if (x.size == 0) return;
+    args[-1] = {0, manifast::vecmath::sum(x.data, x.size) / x.size, nullptr};
+}
+
+// Population standard deviation (divides by n), two passes
+static void m_std(void* vm, Any* args, int nargs) {
+    int idx = math_self(args, nargs);
+    args[-1] = {3, 0.0, nullptr};
+    if (nargs - idx < 1 || args[idx].type != ANY_ARRAY) return;
+    NumberSpan x = number_span(&args[idx], "std");
+    if (x.size == 0) return;
+    double mean = manifast::vecmath::sum(x.data, x.size) / x.size;
+    args[-1] = {0, std::sqrt(manifast::vecmath::squaredDeviation(x.data, x.size, mean) / x.size), nullptr};
+}
+
+static void m_cumsum(void* vm, Any* args, int nargs) {
+    args[-1] = {3, 0.0, nullptr};
+    math_map(args, nargs, "cumsum", manifast::vecmath::cumsum);
+}
+
+static void m_sin(void* vm, Any* args, int nargs) {
+    if (math_map(args, nargs, "sin", manifast::vecmath::sin)) return;
+    MATH_BEGIN(); args[-1] = {0, sin(args[idx].number), nullptr};
+}
 static void m_cos(void* vm, Any* args, int nargs) { MATH_BEGIN(); args[-1] = {0, cos(args[idx].number), nullptr}; }
 static void m_tan(void* vm, Any* args, int nargs) { MATH_BEGIN(); args[-1] = {0, tan(args[idx].number), nullptr}; }
 static void m_asin(void* vm, Any* args, int nargs) { MATH_BEGIN(); args[-1] = {0, asin(args[idx].number), nullptr}; }
@@ -507,7 +1397,10 @@ static void m_atan2(void* vm, Any* args, int nargs) {
     if (nargs - idx >= 2 && args[idx].type == 0 && args[idx+1].type == 0) args[-1] = {0, atan2(args[idx].number, args[idx+1].number), nullptr}; 
     else args[-1] = {3, 0.0, nullptr}; 
 }
-static void m_sqrt(void* vm, Any* args, int nargs) { MATH_BEGIN(); args[-1] = {0, sqrt(args[idx].number), nullptr}; }
+static void m_sqrt(void* vm, Any* args, int nargs) {
+    if (math_map(args, nargs, "sqrt", manifast::vecmath::sqrt)) return;
+    MATH_BEGIN(); args[-1] = {0, sqrt(args[idx].number), nullptr};
+}
 static void m_abs(void* vm, Any* args, int nargs) { MATH_BEGIN(); args[-1] = {0, fabs(args[idx].number), nullptr}; }
 static void m_floor(void* vm, Any* args, int nargs) { MATH_BEGIN(); args[-1] = {0, floor(args[idx].number), nullptr}; }
 static void m_ceil(void* vm, Any* args, int nargs) { MATH_BEGIN(); args[-1] = {0, ceil(args[idx].number), nullptr}; }
@@ -517,7 +1410,10 @@ static void m_pow(void* vm, Any* args, int nargs) {
     else args[-1] = {3, 0.0, nullptr}; 
 }
 static void m_log(void* vm, Any* args, int nargs) { MATH_BEGIN(); args[-1] = {0, log(args[idx].number), nullptr}; }
-static void m_exp(void* vm, Any* args, int nargs) { MATH_BEGIN(); args[-1] = {0, exp(args[idx].number), nullptr}; }
+static void m_exp(void* vm, Any* args, int nargs) {
+    if (math_map(args, nargs, "exp", manifast::vecmath::exp)) return;
+    MATH_BEGIN(); args[-1] = {0, exp(args[idx].number), nullptr};
+}
 
 // --- Extended Math (MATLAB-common) ---
 static void m_sinh(void* vm, Any* args, int nargs) { MATH_BEGIN(); args[-1] = {0, sinh(args[idx].number), nullptr}; }
@@ -541,12 +1437,25 @@ static void m_fmod(void* vm, Any* args, int nargs) {
     if (nargs - idx >= 2 && args[idx].type == 0 && args[idx+1].type == 0) args[-1] = {0, fmod(args[idx].number, args[idx+1].number), nullptr};
     else args[-1] = {3, 0.0, nullptr};
 }
+// math.max(a, b), or math.max(arr) over an array (NaNs skipped, nil if empty)
 static void m_max(void* vm, Any* args, int nargs) {
+    int self = math_self(args, nargs);
+    if (nargs - self == 1 && args[self].type == ANY_ARRAY) {
+        NumberSpan x = number_span(&args[self], "max");
+        args[-1] = x.size ? Any{0, manifast::vecmath::max(x.data, x.size), nullptr} : Any{3, 0.0, nullptr};
+        return;
+    }
     int idx = 0; if (nargs >= 1 && args[0].type != 0) idx++;
     if (nargs - idx >= 2 && args[idx].type == 0 && args[idx+1].type == 0) args[-1] = {0, fmax(args[idx].number, args[idx+1].number), nullptr};
     else args[-1] = {3, 0.0, nullptr};
 }
 static void m_min(void* vm, Any* args, int nargs) {
+    int self = math_self(args, nargs);
+    if (nargs - self == 1 && args[self].type == ANY_ARRAY) {
+        NumberSpan x = number_span(&args[self], "min");
+        args[-1] = x.size ? Any{0, manifast::vecmath::min(x.data, x.size), nullptr} : Any{3, 0.0, nullptr};
+        return;
+    }
     int idx = 0; if (nargs >= 1 && args[0].type != 0) idx++;
     if (nargs - idx >= 2 && args[idx].type == 0 && args[idx+1].type == 0) args[-1] = {0, fmin(args[idx].number, args[idx+1].number), nullptr};
     else args[-1] = {3, 0.0, nullptr};
@@ -562,19 +1471,48 @@ static void m_linspace(void* vm, Any* args, int nargs) {
     int idx = 0; if (nargs >= 1 && args[0].type != 0) idx++;
     if (nargs - idx >= 3 && args[idx].type == 0 && args[idx+1].type == 0 && args[idx+2].type == 0) {
         double start = args[idx].number, stop = args[idx+1].number;
-        int n = (int)args[idx+2].number;
-        if (n < 1) n = 1;
-        if (n > 100000) n = 100000;
-        Any* arr = manifast_create_array((uint32_t)n);
+        // No cap of its own: mf_malloc refuses what the memory budget cannot hold
+        double count = args[idx+2].number;
+        uint32_t n = count >= 4294967295.0 ? UINT32_MAX : count >= 1.0 ? (uint32_t)count : 1;
+        Any* arr = manifast_create_typed_array(n, ARRAY_F64);
         ManifastArray* a = (ManifastArray*)arr->ptr;
         double step = (n > 1) ? (stop - start) / (n - 1) : 0.0;
-        for (int i = 0; i < n; i++) {
-            a->elements[i] = {0, start + step * i, nullptr};
+        for (uint32_t i = 0; i < n; i++) {
+            a->f64[i] = start + step * i;
         }
         args[-1] = *arr;
     } else args[-1] = {3, 0.0, nullptr};
 }
 
+// math.f64array(n) / math.i32array(n): zero-filled packed array of length n;
+// math.f64array(arr) / math.i32array(arr): packed copy of a numeric array.
+static void make_typed_array(Any* args, int nargs, uint32_t kind) {
+    int idx = 0; if (nargs >= 1 && args[0].type == ANY_OBJECT) idx++;
+    args[-1] = {3, 0.0, nullptr};
+    if (nargs - idx < 1) return;
+    Any* src = &args[idx];
+    if (src->type == ANY_NUMBER) {
+        double n = src->number;
+        uint32_t count;
+        if (!array_count(n, &count) || (double)count != n) {
+            MANIFAST_THROW(std::string("RangeError: math.") + (kind == ARRAY_F64 ? "f64array" : "i32array") +
+                           "(n) membutuhkan bilangan bulat 0..4294967295, dapat " + std::to_string(n));
+        }
+        args[-1] = *manifast_create_typed_array(count, kind);
+    } else if (src->type == ANY_ARRAY) {
+        ManifastArray* from = (ManifastArray*)src->ptr;
+        Any* out = manifast_create_typed_array(from->size, kind);
+        ManifastArray* to = (ManifastArray*)out->ptr;
+        for (uint32_t i = 0; i < from->size; i++) {
+            Any v = manifast_array_element(from, i);
+            array_store(to, i, &v);
+        }
+        args[-1] = *out;
+    }
+}
+static void m_f64array(void* vm, Any* args, int nargs) { make_typed_array(args, nargs, ARRAY_F64); }
+static void m_i32array(void* vm, Any* args, int nargs) { make_typed_array(args, nargs, ARRAY_I32); }
+
 MF_API Any* manifast_impor(const char* name) {
     std::string sname = name;
     if (sname.length() > 3 && (sname.ends_with(".dll") || sname.ends_with(".so") || sname.ends_with(".dylib"))) {
@@ -611,7 +1549,9 @@ MF_API Any* manifast_impor(const char* name) {
             {"log2", m_log2}, {"log10", m_log10},
             {"sign", m_sign}, {"hypot", m_hypot}, {"mod", m_fmod},
             {"max", m_max}, {"min", m_min}, {"clamp", m_clamp},
-            {"linspace", m_linspace}
+            {"linspace", m_linspace}, {"f64array", m_f64array}, {"i32array", m_i32array},
+            {"sum", m_sum}, {"dot", m_dot}, {"axpy", m_axpy},
+            {"mean", m_mean}, {"std", m_std}, {"cumsum", m_cumsum}
         };
         int count = sizeof(math_funcs) / sizeof(math_funcs[0]);
         for (int i = 0; i < count; i++) {
@@ -629,6 +1569,18 @@ MF_API Any* manifast_impor(const char* name) {
         manifast_object_set(obj, "inf", &inf_val);
         manifast_object_set(obj, "nan", &nan_val);
         return obj;
+    } else if (strcmp(name, "map") == 0) {
+        Any* obj = manifast_create_object();
+        struct { const char* n; ManifastNativeFn f; } map_funcs[] = {
+            {"new", map_new}, {"set", map_set}, {"get", map_get}, {"has", map_has},
+            {"delete", map_delete}, {"size", map_size}, {"clear", map_clear_fn},
+            {"keys", map_keys}, {"values", map_values}, {"each", map_each}
+        };
+        for (auto& f : map_funcs) {
+            Any val = {4, 0.0, (void*)f.f};
+            manifast_object_set(obj, f.n, &val);
+        }
+        return obj;
     } else if (strcmp(name, "os") == 0) {
         Any* obj = manifast_create_object();
         auto waktuNano = [](void* vm, Any* args, int nargs) {
@@ -783,8 +1735,8 @@ MF_API Any* manifast_impor(const char* name) {
                 ManifastArray* ya = (ManifastArray*)args[offset + 1].ptr;
                 s.x.reserve(xa->size);
                 s.y.reserve(ya->size);
-                for (uint32_t i = 0; i < xa->size; i++) s.x.push_back(xa->elements[i].number);
-                for (uint32_t i = 0; i < ya->size; i++) s.y.push_back(ya->elements[i].number);
+                for (uint32_t i = 0; i < xa->size; i++) s.x.push_back(manifast_array_element(xa, i).number);
+                for (uint32_t i = 0; i < ya->size; i++) s.y.push_back(manifast_array_element(ya, i).number);
                 return true;
             }
             if (y_only_ok && args[offset].type == ANY_ARRAY) {
@@ -793,7 +1745,7 @@ MF_API Any* manifast_impor(const char* name) {
                 s.y.reserve(ya->size);
                 for (uint32_t i = 0; i < ya->size; i++) {
                     s.x.push_back((double)(i + 1));
-                    s.y.push_back(ya->elements[i].number);
+                    s.y.push_back(manifast_array_element(ya, i).number);
                 }
                 return true;
             }
@@ -869,7 +1821,7 @@ MF_API Any* manifast_impor(const char* name) {
             std::vector<double> data;
             data.reserve((size_t)hw * (size_t)hh);
             for (uint32_t i = 0; i < vals->size && (int)data.size() < hw * hh; i++)
-                data.push_back(vals->elements[i].number);
+                data.push_back(manifast_array_element(vals, i).number);
             while ((int)data.size() < hw * hh) data.push_back(0.0);
 
             manifast::plot::ChartConfig cfg;
@@ -945,24 +1897,20 @@ MF_API void manifast_type_check(Any* val, int expected_type) {
     if (!ok) {
         const char* names[] = {
             "angka", "string", "boolean", "nil", "fungsi_native", "fungsi_bytecode",
-            "array", "objek", "kelas", "instansi", "i8", "i16", "i32", "i64", "f32", "f64", "char"
+            "array", "objek", "kelas", "instansi", "i8", "i16", "i32", "i64", "f32", "f64", "char", "map"
         };
-        std::string eName = (expected_type >= 0 && expected_type < 17) ? names[expected_type] : "unknown";
-        std::string gName = (val->type >= 0 && val->type < 17) ? names[val->type] : "unknown";
+        std::string eName = (expected_type >= 0 && expected_type < 18) ? names[expected_type] : "unknown";
+        std::string gName = (val->type >= 0 && val->type < 18) ? names[val->type] : "unknown";
         MANIFAST_THROW("TypeError: Diharapkan tipe " + eName + ", tapi mendapat tipe " + gName);
     }
 }
 
 MF_API Any* manifast_call_dynamic(Any* callee, Any* args, int nargs) {
-    if (callee->type == 4) { // Native
-        ManifastNativeFn fn = (ManifastNativeFn)callee->ptr;
-        std::vector<Any> call_args(nargs + 1);
-        for(int i = 0; i < nargs; ++i) call_args[i+1] = args[i];
-        
-        fn(nullptr, &call_args[1], nargs);
-        
+    if (callee->type == 4 || callee->type == 5) { // Native, bytecode
+        Any result;
+        call_function(callee, args, nargs, &result);
         Any* res = (Any*)mf_malloc(sizeof(Any));
-        *res = call_args[0];
+        *res = result;
         return res;
     } else if (callee->type == 8) { // Class (Constructor)
         Any* inst = manifast_create_instance(callee);
@@ -1024,7 +1972,8 @@ MF_API void manifast_print_any(Any* any) {
             {
                 ManifastArray* arr = (ManifastArray*)any->ptr;
                 for (uint32_t i = 0; i < arr->size; i++) {
-                     manifast_print_any(&arr->elements[i]);
+                     Any el = manifast_array_element(arr, i);
+                     manifast_print_any(&el);
                      if (i < arr->size - 1) printf(", ");
                 }
             }
@@ -1033,6 +1982,22 @@ MF_API void manifast_print_any(Any* any) {
         case 7: // Object
             printf("{Objek}");
             break;
+        case ANY_MAP:
+            printf("{");
+            {
+                ManifastMap* m = (ManifastMap*)any->ptr;
+                bool first = true;
+                for (uint32_t i = 0; i < m->capacity; i++) {
+                    if (m->entries[i].state != MAP_LIVE) continue;
+                    if (!first) printf(", ");
+                    first = false;
+                    manifast_print_any(&m->entries[i].key);
+                    printf(": ");
+                    manifast_print_any(&m->entries[i].value);
+                }
+            }
+            printf("}");
+            break;
         case 8: // Class
             if (any->ptr) {
                 ManifastClass* klass = (ManifastClass*)any->ptr;
@@ -0,0 +1,77 @@
+#include "manifast/Sort.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace manifast {
+namespace sort {
+
+namespace {
+
+// NaN compares greater than everything, so NaNs collect at the end
+bool lessNumber(double a, double b) { return a < b || (b != b && a == a); }
+bool lessInt32(int32_t a, int32_t b) { return a < b; }
+
+unsigned sortThreads(size_t n) {
+#ifdef __EMSCRIPTEN__
+    (void)n;
+    return 1; // built without pthreads
+#else
+    if (n < kParallelMin) return 1;
+    unsigned hw = std::thread::hardware_concurrency();
+    unsigned want = (unsigned)std::min<size_t>(n / (kParallelMin / 4), 8);
+    return std::max(1u, std::min(hw, want));
+#endif
+}
+
+// Sorts `parts` equal runs on their own threads, then merges neighbouring
+// runs pairwise, also in parallel, until one run is left.
+template <class T, class Less>
+void parallelSort(T* data, size_t n, unsigned parts, Less less) {
+    std::vector<size_t> bounds(parts + 1);
+    for (unsigned k = 0; k <= parts; k++) bounds[k] = n * k / parts;
+
+    std::vector<std::thread> workers;
+    for (unsigned k = 1; k < parts; k++) {
+        workers.emplace_back([=] { introsort(data + bounds[k], data + bounds[k + 1], less); });
+    }
+    introsort(data + bounds[0], data + bounds[1], less);
+    for (std::thread& w : workers) w.join();
+
+    std::vector<T> buffer(n);
+    T* from = data;
+    T* to = buffer.data();
+    while (bounds.size() > 2) {
+        std::vector<size_t> merged;
+        workers.clear();
+        for (size_t k = 0; k + 1 < bounds.size(); k += 2) {
+            size_t lo = bounds[k];
+            size_t mid = bounds[k + 1];
+            size_t hi = k + 2 < bounds.size() ? bounds[k + 2] : mid; // odd run out: copied as is
+            merged.push_back(lo);
+            workers.emplace_back([=] { std::merge(from + lo, from + mid, from + mid, from + hi, to + lo, less); });
+        }
+        merged.push_back(n);
+        for (std::thread& w : workers) w.join();
+        bounds.swap(merged);
+        std::swap(from, to);
+    }
+    if (from != data) std::copy(from, from + n, data);
+}
+
+} // namespace
+
+void sortNumbers(double* data, size_t n, unsigned threads) {
+    unsigned parts = threads ? threads : sortThreads(n);
+    if (parts > 1) parallelSort(data, n, parts, lessNumber);
+    else introsort(data, data + n, lessNumber);
+}
+
+void sortInt32(int32_t* data, size_t n, unsigned threads) {
+    unsigned parts = threads ? threads : sortThreads(n);
+    if (parts > 1) parallelSort(data, n, parts, lessInt32);
+    else introsort(data, data + n, lessInt32);
+}
+
+} // namespace sort
+} // namespace manifast
@@ -0,0 +1,71 @@
+#include "manifast/VM/Tiering.h"
+#include "manifast/VM/BaselineJit.h"
+#include "manifast/VM/Chunk.h"
+#include <algorithm>
+#include <mutex>
+
+namespace manifast {
+namespace vm {
+
+namespace {
+
+struct DefaultBackends {
+    std::mutex mutex;
+    std::shared_ptr<TierBackend> backends[3];
+
+    DefaultBackends() { backends[(int)Tier::T1] = createBaselineTierBackend(); }
+};
+
+DefaultBackends& defaults() {
+    static DefaultBackends* registry = new DefaultBackends(); // outlives static VMs
+    return *registry;
+}
+
+} // namespace
+
+void setDefaultTierBackend(Tier tier, std::shared_ptr<TierBackend> backend) {
+    DefaultBackends& d = defaults();
+    std::lock_guard<std::mutex> lock(d.mutex);
+    d.backends[(int)tier] = std::move(backend);
+}
+
+std::shared_ptr<TierBackend> defaultTierBackend(Tier tier) {
+    DefaultBackends& d = defaults();
+    std::lock_guard<std::mutex> lock(d.mutex);
+    return d.backends[(int)tier];
+}
+
+int instructionLength(const Chunk& chunk, int pc) {
+    Instruction i = chunk.code[pc];
+    switch (getOpCode(i)) {
+        case OpCode::LOADK:
+        case OpCode::GETGLOBAL:
+        case OpCode::SETGLOBAL:
+        case OpCode::NEWCLASS:
+        case OpCode::TYPE_CHECK:
+            return getBx(i) == (uint32_t)MAXARG_Bx ? 2 : 1;
+        case OpCode::SETLIST:
+            return getC(i) == 0 ? 2 : 1;
+        case OpCode::GETSLICE:
+            return 2; // end operand lives in the next word
+        default:
+            return 1;
+    }
+}
+
+std::vector<int> tierEntryPoints(const Chunk& chunk) {
+    std::vector<int> entries{0};
+    int n = (int)chunk.code.size();
+    for (int pc = 0; pc < n; pc += instructionLength(chunk, pc)) {
+        Instruction i = chunk.code[pc];
+        if (getOpCode(i) != OpCode::JMP || getsBx(i) >= 0) continue;
+        int target = pc + 1 + getsBx(i);
+        if (target >= 0 && target < n) entries.push_back(target);
+    }
+    std::sort(entries.begin(), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+    return entries;
+}
+
+} // namespace vm
+} // namespace manifast
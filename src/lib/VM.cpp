@@ -1,16 +1,18 @@
 #include "manifast/VM/VM.h"
 #define DEBUG_VM
 #include "manifast/Runtime.h"
+#include "manifast/Sort.h"
 #include <iostream>
 #include <cmath>
 #include <cstring>
+#include <algorithm>
+#include <iterator>
 #include <chrono>
 #include <thread>
-#include <fstream>
-#include <sstream>
 #include "manifast/Lexer.h"
 #include "manifast/Parser.h"
 #include "manifast/VM/Compiler.h"
+#include "manifast/Utils/MappedFile.h"
 
 namespace manifast {
 namespace vm {
@@ -25,6 +27,8 @@ namespace vm {
 #define GET_C(i)    getC(i)
 #define GET_Bx(i)   getBx(i)
 #define GET_sBx(i)  getsBx(i)
+// Constant index of an iABx instruction, consuming the extension word if present
+#define GET_KBx(i)  (GET_Bx(i) == MAXARG_Bx ? (int)code[pc++] : (int)GET_Bx(i))
 
 // Access registers (relative to current frame)
 #define R(x)        (stack[frames.back().baseSlot + (x)])
@@ -84,6 +88,7 @@ static void nativeTipe(VM* vm, Any* args, int nargs) {
         case 7: t = "objek"; break;
         case 8: t = "objek"; break; // Class is also an object
         case 9: t = "objek"; break; // Instance is an object
+        case 17: t = "map"; break;
     }
     Any res;
     res.type = 1;
@@ -174,6 +179,160 @@ static void nativeArrayLen(VM* vm, Any* args, int nargs) {
     args[-1] = {0, manifast_array_len(&args[0]), nullptr};
 }
 
+static void nativeError(VM* vm, const std::string& msg) {
+    vm->runtimeError(msg);
+    MANIFAST_THROW("Runtime Error: " + msg);
+}
+
+static bool isTruthy(const Any& v) {
+    if (v.type == 3) return false;
+    if (v.type == 0 || v.type == 2) return v.number != 0;
+    return true;
+}
+
+// A method taken off an array (`f = xs.reverse`) can be called on anything
+static void checkReceiver(VM* vm, const Any* args, int nargs, const char* method) {
+    if (nargs < 1 || args[0].type != 6) {
+        nativeError(vm, std::string(method) + "() hanya bisa dipanggil pada array");
+    }
+}
+
+static void nativeArrayReserve(VM* vm, Any* args, int nargs) {
+    checkReceiver(vm, args, nargs, "reserve");
+    if (nargs < 2 || args[1].type != 0) nativeError(vm, "reserve() membutuhkan kapasitas berupa angka");
+    manifast_array_reserve(&args[0], args[1].number);
+    args[-1] = args[0];
+}
+
+// xs.fill(v [, first [, last]]): first..last (default 1..len) set to v,
+// growing the array when last is past the end
+static void nativeArrayFill(VM* vm, Any* args, int nargs) {
+    checkReceiver(vm, args, nargs, "fill");
+    if (nargs < 2) nativeError(vm, "fill() membutuhkan nilai");
+    double first = 1, last = manifast_array_len(&args[0]);
+    if (nargs >= 3 && args[2].type == 0) first = args[2].number;
+    if (nargs >= 4 && args[3].type == 0) last = args[3].number;
+    manifast_array_fill(&args[0], &args[1], first, last);
+    args[-1] = args[0];
+}
+
+static void nativeArrayConcat(VM* vm, Any* args, int nargs) {
+    checkReceiver(vm, args, nargs, "concat");
+    args[-1] = *manifast_array_concat(&args[0], &args[1], nargs - 1);
+}
+
+// 1-based position of the first element == v (from `from` on), or nil
+static void nativeArrayIndexOf(VM* vm, Any* args, int nargs) {
+    checkReceiver(vm, args, nargs, "indexOf");
+    if (nargs < 2) nativeError(vm, "indexOf() membutuhkan nilai yang dicari");
+    double from = (nargs >= 3 && args[2].type == 0) ? args[2].number : 1;
+    double pos = manifast_array_index_of(&args[0], &args[1], from);
+    args[-1] = pos > 0 ? Any{0, pos, nullptr} : Any{3, 0.0, nullptr};
+}
+
+static void nativeArrayReverse(VM* vm, Any* args, int nargs) {
+    checkReceiver(vm, args, nargs, "reverse");
+    manifast_array_reverse(&args[0]);
+    args[-1] = args[0];
+}
+
+static void checkCallback(VM* vm, const Any* args, int nargs, const char* method) {
+    checkReceiver(vm, args, nargs, method);
+    if (nargs < 2 || (args[1].type != 4 && args[1].type != 5)) {
+        nativeError(vm, std::string(method) + "() membutuhkan fungsi sebagai argumen");
+    }
+}
+
+// The callbacks below see (element, index). The array may change under them:
+// they stop at whichever is shorter, its length at the start or now.
+static uint32_t visibleLen(const Any& arr, uint32_t start) {
+    uint32_t now = ((ManifastArray*)arr.ptr)->size;
+    return now < start ? now : start;
+}
+
+static void nativeArrayMap(VM* vm, Any* args, int nargs) {
+    checkCallback(vm, args, nargs, "map");
+    Any self = args[0], fn = args[1];
+    uint32_t n = ((ManifastArray*)self.ptr)->size;
+    Any out = *manifast_create_array(0);
+    manifast_array_reserve(&out, n);
+    for (uint32_t k = 0; k < visibleLen(self, n); k++) {
+        Any cb[2] = {manifast_array_element((ManifastArray*)self.ptr, k), {0, (double)(k + 1), nullptr}};
+        Any r = vm->call(fn, cb, 2);
+        manifast_array_push(&out, &r);
+    }
+    args[-1] = out;
+}
+
+static void nativeArrayFilter(VM* vm, Any* args, int nargs) {
+    checkCallback(vm, args, nargs, "filter");
+    Any self = args[0], fn = args[1];
+    uint32_t n = ((ManifastArray*)self.ptr)->size;
+    Any out = *manifast_create_typed_array(0, ((ManifastArray*)self.ptr)->kind);
+    for (uint32_t k = 0; k < visibleLen(self, n); k++) {
+        Any cb[2] = {manifast_array_element((ManifastArray*)self.ptr, k), {0, (double)(k + 1), nullptr}};
+        if (isTruthy(vm->call(fn, cb, 2))) manifast_array_push(&out, &cb[0]);
+    }
+    args[-1] = out;
+}
+
+// xs.reduce(fn [, init]): fn(acc, element, index); without init the first
+// element starts the accumulator (nil for an empty array)
+static void nativeArrayReduce(VM* vm, Any* args, int nargs) {
+    checkCallback(vm, args, nargs, "reduce");
+    Any self = args[0], fn = args[1];
+    uint32_t n = ((ManifastArray*)self.ptr)->size;
+    uint32_t k = 0;
+    Any acc = {3, 0.0, nullptr};
+    if (nargs >= 3) acc = args[2];
+    else if (n > 0) acc = manifast_array_element((ManifastArray*)self.ptr, k++);
+    for (; k < visibleLen(self, n); k++) {
+        Any cb[3] = {acc, manifast_array_element((ManifastArray*)self.ptr, k), {0, (double)(k + 1), nullptr}};
+        acc = vm->call(fn, cb, 3);
+    }
+    args[-1] = acc;
+}
+
+// xs.sort([less]): in place, ascending numbers or strings by default;
+// less(a, b) is truthy when a goes before b
+static void nativeArraySort(VM* vm, Any* args, int nargs) {
+    checkReceiver(vm, args, nargs, "sort");
+    Any self = args[0];
+    args[-1] = self;
+    if (nargs < 2 || args[1].type == 3) {
+        if (!manifast_array_sort(&self)) {
+            nativeError(vm, "sort() tanpa pembanding hanya untuk array angka atau string");
+        }
+        return;
+    }
+
+    checkCallback(vm, args, nargs, "sort");
+    Any fn = args[1];
+    ManifastArray* arr = (ManifastArray*)self.ptr;
+    std::vector<Any> v(arr->size);
+    for (uint32_t k = 0; k < arr->size; k++) v[k] = manifast_array_element(arr, k);
+    sort::introsort(v.data(), v.data() + v.size(), [vm, fn](const Any& a, const Any& b) {
+        Any cb[2] = {a, b};
+        return isTruthy(vm->call(fn, cb, 2));
+    });
+
+    // The comparator may have resized the array meanwhile
+    uint32_t n = visibleLen(self, (uint32_t)v.size());
+    for (uint32_t k = 0; k < n; k++) manifast_array_set(&self, k + 1, &v[k]);
+}
+
+struct ArrayMethod {
+    const char* name;
+    VM::NativeFn fn;
+};
+
+static const ArrayMethod arrayMethods[] = {
+    {"push", nativeArrayPush},       {"pop", nativeArrayPop},         {"len", nativeArrayLen},
+    {"reserve", nativeArrayReserve}, {"fill", nativeArrayFill},       {"concat", nativeArrayConcat},
+    {"indexOf", nativeArrayIndexOf}, {"reverse", nativeArrayReverse}, {"sort", nativeArraySort},
+    {"map", nativeArrayMap},         {"filter", nativeArrayFilter},   {"reduce", nativeArrayReduce},
+};
+
 static void nativeExit(VM* vm, Any* args, int nargs) {
     int code = 0;
     if (nargs >= 1 && args[0].type == 0) {
@@ -198,35 +357,45 @@ static void nativeImpor(VM* vm, Any* args, int nargs) {
     }
     if (res) free(res);
 
-    std::ifstream file(path);
-    if (!file.is_open()) {
+    utils::MappedFile file(path);
+    if (!file.isOpen()) {
         std::cerr << "Could not open file: " << path << "\n";
         return;
     }
-    
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    std::string source = buffer.str();
+    std::string_view source = file.view();
     
     SyntaxConfig config;
     Lexer lexer(source, config);
-    Parser parser(lexer);
-    auto stmts = parser.parse();
+    Parser parser(lexer, source);
+    std::string diagnostics;
+    parser.setErrorCallback([&](const std::string& msg) { diagnostics += msg; });
     
+    // Compile statement by statement; each AST is freed once emitted. A
+    // syntax error stops before anything recovered past it is compiled.
     Chunk* chunk = new Chunk();
     Compiler compiler;
-    if (compiler.compile(stmts, *chunk, path)) {
-        vm->managedChunks.push_back(chunk);
-        vm->interpret(chunk, source);
-        // lastResult is updated by interpret's final RETURN
-        args[-1] = vm->getLastResult();
-    } else {
+    compiler.begin(*chunk, path);
+    while (auto stmt = parser.parseNext()) {
+        if (parser.hadError()) break;
+        compiler.compileTopLevel(stmt.get());
+    }
+    if (parser.hadError()) {
+        chunk->free();
         delete chunk;
+        while (!diagnostics.empty() && isspace((unsigned char)diagnostics.back())) diagnostics.pop_back();
+        nativeError(vm, "impor('" + path + "') gagal: kesalahan sintaks" + diagnostics);
     }
+    compiler.finish();
+
+    vm->managedChunks.push_back(chunk);
+    vm->interpret(chunk, source);
+    // lastResult is updated by interpret's final RETURN
+    args[-1] = vm->getLastResult();
 }
 
 VM::VM() : lastResult{3, 0.0, nullptr} {
     resetStack();
+    for (Tier t : {Tier::T1, Tier::T2}) backends[(int)t] = defaultTierBackend(t);
     
     // Define builtins
     defineNative("print", nativePrint);
@@ -253,6 +422,75 @@ void VM::defineNative(const std::string& name, NativeFn fn) {
     globals[name] = func;
 }
 
+void VM::setTierBackend(Tier t, std::shared_ptr<TierBackend> backend) {
+    backends[(int)t] = std::move(backend);
+}
+
+// Called when a chunk's hotness reaches its next threshold: compile it for
+// every tier it has now earned, then arm the threshold of the next one. A
+// backend that declines a chunk is not asked again; the chunk keeps its
+// current code and may still reach the tier above. Background backends hand
+// the chunk to a worker; finishPromotion() installs the result.
+void VM::promote(Chunk* chunk) {
+    TierState& t = chunk->tiering;
+    t.nextPromotion = UINT32_MAX;
+    TierContext context;
+    context.globalSlot = [this](const char* name) -> Any* {
+        auto it = globals.find(name);
+        return it != globals.end() ? &it->second : nullptr;
+    };
+    for (int tier = (int)t.tier + 1; tier <= (int)currentTier; tier++) {
+        if (!backends[tier]) continue;
+        uint32_t threshold = tier == (int)Tier::T1 ? tier1Threshold : tier2Threshold;
+        if (t.hotness < threshold) {
+            t.nextPromotion = threshold;
+            return;
+        }
+        t.tier = (Tier)tier;
+        if (backends[tier]->compilesInBackground()) {
+            // The worker must not read `globals` while this thread runs on,
+            // so it gets the slots as they are now.
+            auto slots = std::make_shared<std::unordered_map<std::string, Any*>>();
+            for (auto& [name, value] : globals) (*slots)[name] = &value;
+            TierContext snapshot;
+            snapshot.globalSlot = [slots](const char* name) -> Any* {
+                auto it = slots->find(name);
+                return it != slots->end() ? it->second : nullptr;
+            };
+            auto job = std::make_shared<PendingCompile>();
+            job->tier = (Tier)tier;
+            job->backend = backends[tier];
+            job->requestedBy = this;
+            PendingCompile* p = job.get();
+            const Chunk* source = chunk;
+            p->worker = std::thread([p, source, snapshot]() {
+                p->result = p->backend->compile(*source, snapshot);
+                p->done.store(true, std::memory_order_release);
+            });
+            t.pending = std::move(job);
+            return;
+        }
+        if (NativeEntry entry = backends[tier]->compile(*chunk, context)) {
+            t.native = entry;
+            t.owner = backends[tier];
+            t.boundTo = this;
+            if (debugMode) fprintf(stderr, "[TIER] %s -> T%d (%s)\n", chunk->name.c_str(), tier, backends[tier]->name());
+        }
+    }
+}
+
+void VM::finishPromotion(Chunk* chunk) {
+    TierState& t = chunk->tiering;
+    std::shared_ptr<PendingCompile> job = std::move(t.pending);
+    if (job->result) {
+        t.native = job->result;
+        t.owner = job->backend;
+        t.boundTo = job->requestedBy;
+        if (debugMode) fprintf(stderr, "[TIER] %s -> T%d (%s, background)\n", chunk->name.c_str(), (int)job->tier, job->backend->name());
+    }
+    t.nextPromotion = t.hotness + 1; // look at the tiers above again
+}
+
 void VM::resetStack() {
     stack.clear();
     stack.resize(maxStackSize, {3, 0.0, nullptr});
@@ -263,8 +501,13 @@ void VM::resetStack() {
 void VM::interpret(Chunk* chunk, std::string_view src) {
     if (!chunk || chunk->code.empty()) return;
     
-    std::string oldSource = this->source;
-    this->source = std::string(src);
+    // The caller owns the source text; restore the outer view even if run() throws.
+    struct SourceScope {
+        std::string_view& slot;
+        std::string_view saved;
+        ~SourceScope() { slot = saved; }
+    } sourceScope{this->source, this->source};
+    this->source = src;
 
     // Use current frames size to find fresh base
     int nextBase = 0;
@@ -286,8 +529,51 @@ void VM::interpret(Chunk* chunk, std::string_view src) {
     
     frames.push_back(frame);
     run((int)frames.size() - 1);
-    
-    this->source = oldSource;
+}
+
+static Any callFromRuntime(void* vm, Any* callee, Any* args, int nargs) {
+    return ((VM*)vm)->call(*callee, args, nargs);
+}
+
+Any VM::call(const Any& fn, const Any* args, int n) {
+    if (fn.type == 4) { // Native: result goes to args[-1]
+        // Not on the VM stack: the native may call() back into the same slots
+        Any small[8];
+        std::vector<Any> large;
+        Any* slots = small;
+        if (n + 1 > 8) {
+            large.resize(n + 1);
+            slots = large.data();
+        }
+        slots[0] = {3, 0.0, nullptr};
+        std::copy(args, args + n, slots + 1);
+        ((NativeFn)fn.ptr)(this, slots + 1, n);
+        return slots[0];
+    }
+    if (fn.type != 5) {
+        RUNTIME_ERROR("Panggilan ke non-fungsi (tipe " + std::to_string(fn.type) + ")");
+    }
+
+    // Past every register of the calling frame
+    int base = frames.empty() ? 0 : frames.back().baseSlot + 256;
+    if (base + 256 >= (int)stack.size()) RUNTIME_ERROR("Tumpukan Meluap (Stack Overflow)");
+    std::copy(args, args + n, stack.begin() + base);
+
+    // If the callee throws past us, drop its frames so the caller's frame is
+    // on top again; runtimeError has usually cleared them already.
+    struct CallScope {
+        VM& vm;
+        size_t depth;
+        Any outer;
+        ~CallScope() {
+            if (vm.frames.size() > depth) vm.frames.resize(depth);
+            vm.lastResult = outer;
+        }
+    } scope{*this, frames.size(), lastResult};
+
+    frames.push_back({(Chunk*)fn.ptr, 0, base, -1});
+    run((int)frames.size() - 1);
+    return lastResult;
 }
 
 void VM::runtimeError(const std::string& message) {
@@ -389,6 +675,32 @@ void VM::run(int entryFrameDepth) {
     #define LK(x) (frame->chunk->constants[x])
     #define LRK(x) ((x) < 256 ? LR(x) : ((x)-256 >= 0 && (x)-256 < (int)frame->chunk->constants.size() ? LK((x) - 256) : Any{3, 0.0, nullptr}))
 
+    // Tiering: count calls and loop back-edges per chunk and, once a chunk has
+    // compiled code, run it from the current pc until it side-exits.
+    // Compiled code does not record profiles, so profiling runs stay in T0.
+    ExecutionProfile* const prof = profile;
+    const bool tiered = currentTier != Tier::T0 && !prof;
+    auto tierUp = [&]() {
+        TierState& t = frame->chunk->tiering;
+        if (++t.hotness >= t.nextPromotion) promote(frame->chunk);
+        if (t.pending && t.pending->done.load(std::memory_order_acquire)) finishPromotion(frame->chunk);
+        if (t.native && t.boundTo == this && !debugMode) pc = t.native(&stack_data[base], frame->chunk->constants.data(), pc);
+    };
+
+    // manifast_call_dynamic reaches bytecode through this VM while it runs
+    struct CallHandlerScope {
+        ManifastCallHandler handler;
+        void* vm;
+        ~CallHandlerScope() { manifast_set_call_handler(handler, vm); }
+    } handlerScope{};
+    manifast_get_call_handler(&handlerScope.handler, &handlerScope.vm);
+    manifast_set_call_handler(callFromRuntime, this);
+
+    // The entry frame (interpret, call) counts as a call for tiering, so
+    // callbacks invoked from natives get promoted like any other function
+    if (tiered) tierUp();
+
+    // Only interpreted instructions count towards the limit.
     int instructions = 0;
     for (;;) {
         if (instructions++ > 100000000) {
@@ -412,7 +724,7 @@ void VM::run(int entryFrameDepth) {
                 break;
             }
             case OpCode::LOADK: {
-                LR(GET_A(i)) = LK(GET_Bx(i));
+                LR(GET_A(i)) = LK(GET_KBx(i));
                 break;
             }
             case OpCode::LOADBOOL: {
@@ -526,6 +838,7 @@ void VM::run(int entryFrameDepth) {
                     case 7: t = "objek"; break;
                     case 8: t = "objek"; break;
                     case 9: t = "objek"; break;
+                    case 17: t = "map"; break;
                 }
                 Any res;
                 res.type = 1;
@@ -573,6 +886,7 @@ void VM::run(int entryFrameDepth) {
             }
             case OpCode::JMP: {
                 pc += GET_sBx(i);
+                if (GET_sBx(i) < 0 && tiered) tierUp();
                 break;
             }
             case OpCode::TEST: {
@@ -581,6 +895,7 @@ void VM::run(int entryFrameDepth) {
                 if (v.type == 3) val = false;
                 else if (v.type == 2) val = (v.number != 0);
                 else if (v.type == 0) val = (v.number != 0);
+                if (prof && frame->chunk->offsets[pc - 1] >= 0) prof->recordBranch(frame->chunk->offsets[pc - 1], val);
                 if (val != (GET_C(i) != 0)) pc++;
                 break;
             }
@@ -594,7 +909,7 @@ void VM::run(int entryFrameDepth) {
                 break;
             }
             case OpCode::GETGLOBAL: {
-                Any key = LK(GET_Bx(i)); 
+                Any key = LK(GET_KBx(i));
                 if (key.type == 1 && key.ptr) {
                     std::string name((char*)key.ptr);
                     auto it = globals.find(name);
@@ -610,7 +925,7 @@ void VM::run(int entryFrameDepth) {
                 break;
             }
             case OpCode::SETGLOBAL: {
-                Any key = LK(GET_Bx(i));
+                Any key = LK(GET_KBx(i));
                 if (key.type == 1 && key.ptr) globals[(char*)key.ptr] = LR(GET_A(i));
                 break;
             }
@@ -631,6 +946,7 @@ void VM::run(int entryFrameDepth) {
                     
                     frames.back().pc = pc;
                     Chunk* chunk = (Chunk*)callee.ptr;
+                    if (prof) prof->recordCall(chunk->name);
                     CallFrame frame;
                     frame.chunk = chunk;
                     frame.pc = 0;
@@ -638,6 +954,7 @@ void VM::run(int entryFrameDepth) {
                     frame.returnReg = a;
                     frames.push_back(frame);
                     sync();
+                    if (tiered) tierUp();
                 } else if (callee.type == 8) { // Class (Constructor)
                     frames.back().pc = pc;
                     Any inst = *manifast_create_instance(&callee);
@@ -654,6 +971,7 @@ void VM::run(int entryFrameDepth) {
                         
                         frames.back().pc = pc;
                         Chunk* chunk = (Chunk*)inisiasi->ptr;
+                        if (prof) prof->recordCall(chunk->name);
                         CallFrame frame;
                         frame.chunk = chunk;
                         frame.pc = 0;
@@ -716,29 +1034,31 @@ void VM::run(int entryFrameDepth) {
                 } else if (obj.type == 8) { // Class
                     ManifastClass* klass = (ManifastClass*)obj.ptr;
                     LR(GET_A(i)) = *manifast_object_get_raw(klass->methods, (char*)key.ptr);
+                } else if (obj.type == 17) { // Map
+                    LR(GET_A(i)) = *manifast_map_get(&obj, &key);
                 } else if (obj.type == 6) { // Array
                     if (key.type == 1) { // String (Method)
                         char* name = (char*)key.ptr;
-                        if (strcmp(name, "push") == 0) {
-                            LR(GET_A(i)) = {4, 0.0, (void*)nativeArrayPush};
-                        } else if (strcmp(name, "pop") == 0) {
-                            LR(GET_A(i)) = {4, 0.0, (void*)nativeArrayPop};
-                        } else if (strcmp(name, "len") == 0) {
-                            LR(GET_A(i)) = {4, 0.0, (void*)nativeArrayLen};
-                        } else {
+                        const ArrayMethod* m = std::begin(arrayMethods);
+                        while (m != std::end(arrayMethods) && strcmp(name, m->name) != 0) m++;
+                        if (m == std::end(arrayMethods)) {
                             RUNTIME_ERROR("Array tidak memiliki metode '" + std::string(name) + "'");
                         }
+                        LR(GET_A(i)) = {4, 0.0, (void*)m->fn};
                     } else {
-                        int idx = (int)key.number;
-                        if (idx == 0) RUNTIME_ERROR("Indeks array harus dimulai dari 1 (Manifast menggunakan 1-based indexing)");
+                        // Compare as a double: indices run up to 2^32-1, past INT_MAX.
+                        // manifast_array_get returns nil outside [1, 2^32).
+                        if (key.number > -1.0 && key.number < 1.0) RUNTIME_ERROR("Indeks array harus dimulai dari 1 (Manifast menggunakan 1-based indexing)");
                         LR(GET_A(i)) = *manifast_array_get(&obj, key.number);
                     }
                 } else if (obj.type == 1) { // String
                      char* s = (char*)obj.ptr;
-                     int idx = (int)key.number;
-                     if (idx == 0) RUNTIME_ERROR("Indeks string harus dimulai dari 1 (Manifast menggunakan 1-based indexing)");
-                     if (idx < 1) RUNTIME_ERROR("Indeks string harus >= 1");
-                     if (idx <= (int)strlen(s)) {
+                     double n = key.number;
+                     if (n > -1.0 && n < 1.0) RUNTIME_ERROR("Indeks string harus dimulai dari 1 (Manifast menggunakan 1-based indexing)");
+                     if (!(n >= 1.0)) RUNTIME_ERROR("Indeks string harus >= 1");
+                     size_t len = strlen(s);
+                     if (n < (double)len + 1.0) {
+                         size_t idx = (size_t)n;
                          char buf[2] = {s[idx-1], '\0'};
                          LR(GET_A(i)) = *manifast_create_string(buf); 
                      } else {
@@ -763,6 +1083,8 @@ void VM::run(int entryFrameDepth) {
                     manifast_object_set_raw(klass->methods, (char*)key.ptr, &val);
                 } else if (obj.type == 6) {
                     manifast_array_set(&obj, key.number, &val);
+                } else if (obj.type == 17) {
+                    manifast_map_set(&obj, &key, &val);
                 }
                 break;
             }
@@ -775,7 +1097,7 @@ void VM::run(int entryFrameDepth) {
                 break;
             }
             case OpCode::NEWCLASS: {
-                 Any& name = LK(GET_Bx(i));
+                 Any& name = LK(GET_KBx(i));
                  LR(GET_A(i)) = *manifast_create_class((char*)name.ptr);
                  break;
             }
@@ -787,21 +1109,11 @@ void VM::run(int entryFrameDepth) {
                 Instruction i2 = code[pc++];
                 Any end = LRK(i2);
                 
-                if (obj.type == 6) { // Array slicing
+                if (obj.type == 6) { // Array slicing: a view, copied only when written
                     ManifastArray* src = (ManifastArray*)obj.ptr;
                     int s = (start.type == 3) ? 1 : (int)start.number;
                     int e = (end.type == 3) ? (int)src->size : (int)end.number;
-                    
-                    if (s < 1) s = 1;
-                    if (e > (int)src->size) e = src->size;
-                    
-                    int len = (e >= s) ? (e - s + 1) : 0;
-                    Any* res = manifast_create_array(len);
-                    ManifastArray* dst = (ManifastArray*)res->ptr;
-                    for (int j = 0; j < len; j++) {
-                        dst->elements[j] = src->elements[s + j - 1];
-                    }
-                    LR(GET_A(i)) = *res;
+                    LR(GET_A(i)) = *manifast_array_slice(&obj, s, e);
                 } else {
                     LR(GET_A(i)) = {3, 0.0, nullptr};
                 }
@@ -811,22 +1123,38 @@ void VM::run(int entryFrameDepth) {
                 int a = GET_A(i);
                 int n = GET_B(i); // num of elements to set
                 int c = GET_C(i); // batch index
+                if (c == 0) c = (int)code[pc++];
                 Any& arr = LR(a);
                 for (int j = 1; j <= n; j++) {
-                    manifast_array_set(&arr, (double)((c-1)*50 + j), &LR(a + j));
+                    manifast_array_set(&arr, (double)(c-1)*LFIELDS_PER_FLUSH + j, &LR(a + j));
                 }
                 break;
             }
             case OpCode::TYPE_CHECK: {
                 int a = GET_A(i);
-                int bx = GET_Bx(i);
+                int bx = GET_KBx(i);
                 Any& val = LR(a);
                 Any& typeInfo = LK(bx);
                 int expectedType = (int)typeInfo.number;
 
                 // Type mapping: 0=angka, 1=string, 2=bool, 3=nil, 4=native, 5=fungsi, 6=array, 7=object
-                // Extended: 10=struct (check fields), 11=any (skip)
+                // Extended: 10=struct (check fields), 11=any (skip), 12=f64[] / 13=i32[] (array, bound to a packed copy)
                 if (expectedType == 11) break; // Any type, skip
+                if (expectedType == 12 || expectedType == 13) {
+                    const char* typeName = expectedType == 12 ? "f64[]" : "i32[]";
+                    if (val.type != 6) {
+                        const char* fn[] = {"angka","string","boolean","nil","native","fungsi","array","objek"};
+                        RUNTIME_ERROR("TypeError: harus bertipe " + std::string(typeName) + ", dapat " +
+                                      std::string(val.type < 8 ? fn[val.type] : "unknown"));
+                    }
+                    Any* packed = manifast_array_packed(&val, expectedType == 12 ? ARRAY_F64 : ARRAY_I32);
+                    if (!packed) {
+                        RUNTIME_ERROR("TypeError: harus bertipe " + std::string(typeName) + ", tapi array berisi nilai yang bukan " +
+                                      (expectedType == 12 ? "angka" : "angka i32"));
+                    }
+                    val = *packed;
+                    break;
+                }
 
                 const char* expectedName = "unknown";
                 bool ok = false;
@@ -0,0 +1,155 @@
+#include "manifast/VecMath.h"
+#include "manifast/VecMathKernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MANIFAST_HAS_SSE2_KERNELS
+#endif
+
+namespace manifast {
+namespace vecmath {
+
+#ifdef MANIFAST_HAS_AVX2_KERNELS
+namespace avx2 { // VecMathAvx2.cpp
+void sin(const double* x, double* out, size_t n);
+void exp(const double* x, double* out, size_t n);
+void sqrt(const double* x, double* out, size_t n);
+void axpy(double a, const double* x, double* y, size_t n);
+double sum(const double* x, size_t n);
+double dot(const double* x, const double* y, size_t n);
+double squaredDeviation(const double* x, size_t n, double center);
+double min(const double* x, size_t n);
+double max(const double* x, size_t n);
+} // namespace avx2
+#endif
+
+namespace {
+
+#ifdef MANIFAST_HAS_SSE2_KERNELS
+struct Sse2 {
+    using V = __m128d;
+    using M = __m128d;
+    static constexpr int W = 2;
+    static V load(const double* p) { return _mm_loadu_pd(p); }
+    static void store(double* p, V v) { _mm_storeu_pd(p, v); }
+    static V set1(double d) { return _mm_set1_pd(d); }
+    static V add(V a, V b) { return _mm_add_pd(a, b); }
+    static V sub(V a, V b) { return _mm_sub_pd(a, b); }
+    static V mul(V a, V b) { return _mm_mul_pd(a, b); }
+    static V div(V a, V b) { return _mm_div_pd(a, b); }
+    static V sqrt(V a) { return _mm_sqrt_pd(a); }
+    static V min(V a, V b) { return _mm_min_pd(a, b); }
+    static V max(V a, V b) { return _mm_max_pd(a, b); }
+    static V abs(V a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+    static M lt(V a, V b) { return _mm_cmplt_pd(a, b); }
+    static M gt(V a, V b) { return _mm_cmpgt_pd(a, b); }
+    static M eq(V a, V b) { return _mm_cmpeq_pd(a, b); }
+    static V select(M m, V a, V b) { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+    static bool all(M m) { return _mm_movemask_pd(m) == 0x3; }
+    static V trunc(V a) { return _mm_cvtepi32_pd(_mm_cvttpd_epi32(a)); }
+    static V bxor(V a, V b) { return _mm_xor_pd(a, b); }
+    static V signbits(V a) { return _mm_and_pd(a, _mm_set1_pd(-0.0)); }
+    static V pow2n(V n) {
+        // n + 1023 lands in the low mantissa bits of 1.5 * 2^52 + n + 1023
+        __m128i biased = _mm_castpd_si128(_mm_add_pd(n, _mm_set1_pd(6755399441055744.0 + 1023.0)));
+        return _mm_castsi128_pd(_mm_slli_epi64(biased, 52));
+    }
+};
+#endif
+
+struct Kernels {
+    Isa isa;
+    void (*sin)(const double*, double*, size_t);
+    void (*exp)(const double*, double*, size_t);
+    void (*sqrt)(const double*, double*, size_t);
+    void (*axpy)(double, const double*, double*, size_t);
+    double (*sum)(const double*, size_t);
+    double (*dot)(const double*, const double*, size_t);
+    double (*squaredDeviation)(const double*, size_t, double);
+    double (*min)(const double*, size_t);
+    double (*max)(const double*, size_t);
+};
+
+template <class S>
+Kernels kernelsFor(Isa isa) {
+    return {isa,
+            mapKernel<S, SinOp>,
+            mapKernel<S, ExpOp>,
+            sqrtKernel<S>,
+            axpyKernel<S>,
+            sumKernel<S>,
+            dotKernel<S>,
+            squaredDeviationKernel<S>,
+            minKernel<S>,
+            maxKernel<S>};
+}
+
+bool supported(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar: return true;
+#ifdef MANIFAST_HAS_SSE2_KERNELS
+        case Isa::Sse2: return true;
+#endif
+#ifdef MANIFAST_HAS_AVX2_KERNELS
+        case Isa::Avx2: return __builtin_cpu_supports("avx2");
+#endif
+        default: return false;
+    }
+}
+
+Kernels kernels(Isa isa) {
+    switch (isa) {
+#ifdef MANIFAST_HAS_AVX2_KERNELS
+        case Isa::Avx2:
+            return {Isa::Avx2, avx2::sin, avx2::exp, avx2::sqrt, avx2::axpy, avx2::sum,
+                    avx2::dot, avx2::squaredDeviation, avx2::min, avx2::max};
+#endif
+#ifdef MANIFAST_HAS_SSE2_KERNELS
+        case Isa::Sse2: return kernelsFor<Sse2>(Isa::Sse2);
+#endif
+        default: return kernelsFor<Scalar>(Isa::Scalar);
+    }
+}
+
+Kernels& active() {
+    static Kernels k = kernels(supported(Isa::Avx2) ? Isa::Avx2 : supported(Isa::Sse2) ? Isa::Sse2 : Isa::Scalar);
+    return k;
+}
+
+} // namespace
+
+Isa activeIsa() { return active().isa; }
+
+const char* isaName(Isa isa) {
+    switch (isa) {
+        case Isa::Avx2: return "avx2";
+        case Isa::Sse2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+bool selectIsa(Isa isa) {
+    if (!supported(isa)) return false;
+    active() = kernels(isa);
+    return true;
+}
+
+void sin(const double* x, double* out, size_t n) { active().sin(x, out, n); }
+void exp(const double* x, double* out, size_t n) { active().exp(x, out, n); }
+void sqrt(const double* x, double* out, size_t n) { active().sqrt(x, out, n); }
+void axpy(double a, const double* x, double* y, size_t n) { active().axpy(a, x, y, n); }
+
+void cumsum(const double* x, double* out, size_t n) {
+    // One dependency chain: each prefix is the plain left-to-right sum
+    double acc = 0.0;
+    for (size_t i = 0; i < n; i++) out[i] = acc += x[i];
+}
+
+double sum(const double* x, size_t n) { return active().sum(x, n); }
+double dot(const double* x, const double* y, size_t n) { return active().dot(x, y, n); }
+double squaredDeviation(const double* x, size_t n, double center) { return active().squaredDeviation(x, n, center); }
+double min(const double* x, size_t n) { return active().min(x, n); }
+double max(const double* x, size_t n) { return active().max(x, n); }
+
+} // namespace vecmath
+} // namespace manifast
@@ -0,0 +1,56 @@
+// Built with -mavx2 (src/lib/CMakeLists.txt); VecMath.cpp only calls in here
+// after checking the CPU.
+#include "manifast/VecMathKernels.h"
+#include <immintrin.h>
+
+namespace manifast {
+namespace vecmath {
+namespace {
+
+struct Avx2 {
+    using V = __m256d;
+    using M = __m256d;
+    static constexpr int W = 4;
+    static V load(const double* p) { return _mm256_loadu_pd(p); }
+    static void store(double* p, V v) { _mm256_storeu_pd(p, v); }
+    static V set1(double d) { return _mm256_set1_pd(d); }
+    static V add(V a, V b) { return _mm256_add_pd(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+    static V div(V a, V b) { return _mm256_div_pd(a, b); }
+    static V sqrt(V a) { return _mm256_sqrt_pd(a); }
+    static V min(V a, V b) { return _mm256_min_pd(a, b); }
+    static V max(V a, V b) { return _mm256_max_pd(a, b); }
+    static V abs(V a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+    static M lt(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    static M gt(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+    static M eq(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+    static V select(M m, V a, V b) { return _mm256_blendv_pd(b, a, m); }
+    static bool all(M m) { return _mm256_movemask_pd(m) == 0xF; }
+    static V trunc(V a) { return _mm256_cvtepi32_pd(_mm256_cvttpd_epi32(a)); }
+    static V bxor(V a, V b) { return _mm256_xor_pd(a, b); }
+    static V signbits(V a) { return _mm256_and_pd(a, _mm256_set1_pd(-0.0)); }
+    static V pow2n(V n) {
+        // n + 1023 lands in the low mantissa bits of 1.5 * 2^52 + n + 1023
+        __m256i biased = _mm256_castpd_si256(_mm256_add_pd(n, _mm256_set1_pd(6755399441055744.0 + 1023.0)));
+        return _mm256_castsi256_pd(_mm256_slli_epi64(biased, 52));
+    }
+};
+
+} // namespace
+
+namespace avx2 {
+
+void sin(const double* x, double* out, size_t n) { mapKernel<Avx2, SinOp>(x, out, n); }
+void exp(const double* x, double* out, size_t n) { mapKernel<Avx2, ExpOp>(x, out, n); }
+void sqrt(const double* x, double* out, size_t n) { sqrtKernel<Avx2>(x, out, n); }
+void axpy(double a, const double* x, double* y, size_t n) { axpyKernel<Avx2>(a, x, y, n); }
+double sum(const double* x, size_t n) { return sumKernel<Avx2>(x, n); }
+double dot(const double* x, const double* y, size_t n) { return dotKernel<Avx2>(x, y, n); }
+double squaredDeviation(const double* x, size_t n, double center) { return squaredDeviationKernel<Avx2>(x, n, center); }
+double min(const double* x, size_t n) { return minKernel<Avx2>(x, n); }
+double max(const double* x, size_t n) { return maxKernel<Avx2>(x, n); }
+
+} // namespace avx2
+} // namespace vecmath
+} // namespace manifast
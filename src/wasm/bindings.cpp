@@ -106,7 +106,8 @@ void wasm_print_any(::Any* val, int depth = 0) {
         g_wasm_output += "[";
         for (uint32_t i = 0; i < arr->size; i++) {
             if (i > 0) g_wasm_output += ", ";
-            wasm_print_any(&arr->elements[i], depth + 1);
+            Any el = manifast_array_element(arr, i);
+            wasm_print_any(&el, depth + 1);
         }
         g_wasm_output += "]";
     }
@@ -121,6 +122,20 @@ void wasm_print_any(::Any* val, int depth = 0) {
         }
         g_wasm_output += "}";
     }
+    else if (val->type == ANY_MAP && val->ptr) {
+        ManifastMap* m = (ManifastMap*)val->ptr;
+        g_wasm_output += "{";
+        bool first = true;
+        for (uint32_t i = 0; i < m->capacity; i++) {
+            if (m->entries[i].state != MAP_LIVE) continue;
+            if (!first) g_wasm_output += ", ";
+            first = false;
+            wasm_print_any(&m->entries[i].key, depth + 1);
+            g_wasm_output += ": ";
+            wasm_print_any(&m->entries[i].value, depth + 1);
+        }
+        g_wasm_output += "}";
+    }
     else if (val->type == 8 && val->ptr) {
         ManifastClass* klass = (ManifastClass*)val->ptr;
         g_wasm_output += "[Kelas ";
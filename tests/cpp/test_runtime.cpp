@@ -2,12 +2,17 @@
 #include <string>
 #include <vector>
 #include <cstdio>
+#include <algorithm>
 #include <cstdlib>
 #include <cassert>
 #include <fstream>
 #include <filesystem>
+#include <cmath>
+#include <cstring>
 #include "manifast/Runtime.h"
 #include "manifast/AST.h"
+#include "manifast/VecMath.h"
+#include "manifast/Sort.h"
 
 #ifdef _WIN32
 #include <io.h>
@@ -90,8 +95,155 @@ void test_manifast_printfmt() {
     std::cout << "test_manifast_printfmt passed!" << std::endl;
 }
 
+void test_manifast_index() {
+    Any* map = manifast_create_map();
+    Any key = {1, 0.0, (void*)"apel"};
+    Any val = {0, 5.0, nullptr};
+    manifast_index_set(map, &key, &val);
+    assert(manifast_index_get(map, &key)->number == 5 && "string key through index_set/get");
+
+    // The numeric fast path (manifast_array_get/set) reaches maps too
+    Any two = {0, 2.0, nullptr};
+    manifast_array_set(map, 2, &val);
+    assert(manifast_index_get(map, &two)->number == 5 && "array_set stores into a map");
+    assert(manifast_array_get(map, 2)->number == 5 && "array_get reads a map");
+    assert(manifast_map_len(map) == 2);
+
+    Any* arr = manifast_create_array(0);
+    manifast_index_set(arr, &two, &val);
+    assert(manifast_array_get(arr, 2)->number == 5 && "numeric key indexes an array");
+    assert(manifast_index_get(arr, &key)->type == 3 && "string key on an array is nil");
+
+    std::cout << "test_manifast_index passed!" << std::endl;
+}
+
+void test_vecmath_kernels_agree() {
+    namespace vm = manifast::vecmath;
+    std::vector<double> x;
+    for (int i = 0; i < 1003; i++) x.push_back((i - 500) * 0.37 + (i % 7) * 1e-3);
+    x[17] = NAN;
+    x[400] = 1e12; // outside the fast ranges: libm
+    x[401] = -800.0;
+
+    struct Result {
+        std::vector<double> sin, exp, sqrt, axpy;
+        double sum, dot, dev, min, max, nanMin, nanMax;
+    };
+    std::vector<double> allNan(11, NAN);
+    auto run = [&]() {
+        Result r;
+        size_t n = x.size();
+        r.sin.resize(n), r.exp.resize(n), r.sqrt.resize(n);
+        vm::sin(x.data(), r.sin.data(), n);
+        vm::exp(x.data(), r.exp.data(), n);
+        vm::sqrt(x.data(), r.sqrt.data(), n);
+        r.axpy.assign(n, 1.0);
+        vm::axpy(0.5, x.data(), r.axpy.data(), n);
+        std::vector<double> finite(x);
+        finite[17] = 0.0;
+        r.sum = vm::sum(finite.data(), n);
+        r.dot = vm::dot(finite.data(), finite.data(), n);
+        r.dev = vm::squaredDeviation(finite.data(), n, 2.0);
+        r.min = vm::min(x.data(), n);
+        r.max = vm::max(x.data(), n);
+        r.nanMin = vm::min(allNan.data(), allNan.size());
+        r.nanMax = vm::max(allNan.data(), allNan.size());
+        return r;
+    };
+    auto sameBits = [](const std::vector<double>& a, const std::vector<double>& b) {
+        return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(double)) == 0;
+    };
+
+    vm::Isa native = vm::activeIsa();
+    bool selected = vm::selectIsa(vm::Isa::Scalar);
+    assert(selected && "scalar kernels are always available");
+    Result reference = run();
+    for (vm::Isa isa : {vm::Isa::Sse2, vm::Isa::Avx2}) {
+        if (!vm::selectIsa(isa)) continue;
+        Result r = run();
+        assert(sameBits(r.sin, reference.sin) && "sin differs from scalar");
+        assert(sameBits(r.exp, reference.exp) && "exp differs from scalar");
+        assert(sameBits(r.sqrt, reference.sqrt) && "sqrt differs from scalar");
+        assert(sameBits(r.axpy, reference.axpy) && "axpy differs from scalar");
+        assert(r.sum == reference.sum && r.dot == reference.dot && r.dev == reference.dev && "reductions differ from scalar");
+        assert(r.min == reference.min && r.max == reference.max && "min/max differ from scalar");
+        assert(std::isnan(r.nanMin) && std::isnan(r.nanMax) && "all-NaN min/max is NaN");
+    }
+    vm::selectIsa(native);
+
+    for (size_t i = 0; i < x.size(); i++) {
+        if (std::isnan(x[i])) {
+            assert(std::isnan(reference.sin[i]));
+            continue;
+        }
+        double s = std::sin(x[i]), e = std::exp(x[i]);
+        assert(std::fabs(reference.sin[i] - s) <= 4e-16 + 1e-15 * std::fabs(s) && "sin accuracy");
+        assert((std::isinf(e) ? reference.exp[i] == e : std::fabs(reference.exp[i] - e) <= 1e-15 * e) && "exp accuracy");
+    }
+    assert(reference.min == -800.0 && reference.max == 1e12);
+    assert(std::isnan(reference.nanMin) && std::isnan(reference.nanMax) && "all-NaN min/max is NaN, not an infinity");
+
+    std::cout << "test_vecmath_kernels_agree passed!" << std::endl;
+}
+
+void test_sort_introsort() {
+    uint32_t seed = 12345;
+    auto next = [&]() { return seed = seed * 1664525u + 1013904223u; };
+
+    // Sizes around the insertion-sort cutoff, plus duplicates and sorted input
+    for (size_t n : {0, 1, 2, 15, 16, 17, 100, 5000}) {
+        std::vector<int> v(n), sorted(n);
+        for (size_t i = 0; i < n; i++) v[i] = (int)(next() % 50);
+        sorted = v;
+        std::sort(sorted.begin(), sorted.end());
+        sort::introsort(v.data(), v.data() + n, [](int a, int b) { return a < b; });
+        assert(v == sorted && "ascending");
+        sort::introsort(v.data(), v.data() + n, [](int a, int b) { return a > b; });
+        std::reverse(sorted.begin(), sorted.end());
+        assert(v == sorted && "descending");
+    }
+
+    // A comparator answering at random still yields a permutation
+    std::vector<int> v(10000), before;
+    for (size_t i = 0; i < v.size(); i++) v[i] = (int)i;
+    before = v;
+    sort::introsort(v.data(), v.data() + v.size(), [&](int, int) { return next() & 1; });
+    std::sort(v.begin(), v.end());
+    assert(v == before && "random comparator keeps a permutation");
+
+    std::cout << "test_sort_introsort passed!" << std::endl;
+}
+
+void test_sort_parallel_matches_serial() {
+    size_t n = sort::kParallelMin + 7; // uneven runs
+    std::vector<double> xs(n);
+    uint32_t seed = 99;
+    for (double& x : xs) x = (double)(seed = seed * 1664525u + 1013904223u) / 4096.0 - 500000.0;
+    xs[5] = NAN;
+    xs[n - 3] = NAN;
+    std::vector<double> expected = xs;
+    std::sort(expected.begin(), expected.end(), [](double a, double b) { return a < b || (b != b && a == a); });
+
+    sort::sortNumbers(xs.data(), n, 3);
+    assert(std::equal(xs.begin(), xs.end() - 2, expected.begin()) && "parallel f64 sort");
+    assert(std::isnan(xs[n - 2]) && std::isnan(xs[n - 1]) && "NaNs last");
+
+    std::vector<int32_t> is(n);
+    for (int32_t& v : is) v = (int32_t)(seed = seed * 1664525u + 1013904223u);
+    std::vector<int32_t> isExpected = is;
+    std::sort(isExpected.begin(), isExpected.end());
+    sort::sortInt32(is.data(), n, 4);
+    assert(is == isExpected && "parallel i32 sort");
+
+    std::cout << "test_sort_parallel_matches_serial passed!" << std::endl;
+}
+
 int main() {
     test_manifast_printfmt();
+    test_manifast_index();
+    test_vecmath_kernels_agree();
+    test_sort_introsort();
+    test_sort_parallel_matches_serial();
     std::cout << "All C++ Runtime tests passed!" << std::endl;
     return 0;
 }
@@ -30,6 +30,9 @@ int main() {
         arrStructs[i].size = (i < depth - 1) ? 1 : 0;
         arrStructs[i].capacity = 1;
         arrStructs[i].elements = (i < depth - 1) ? &arrays[i+1] : nullptr;
+        arrStructs[i].kind = ARRAY_ANY;
+        arrStructs[i].shared = 0;
+        arrStructs[i].hash = nullptr;
 
         arrays[i].type = 6; // ANY_ARRAY
         arrays[i].ptr = &arrStructs[i];
@@ -1,13 +1,41 @@
 #include <gtest/gtest.h>
 #include "manifast/VM/VM.h"
 #include "manifast/VM/Compiler.h"
+#include "manifast/VM/BaselineJit.h"
 #include "manifast/Lexer.h"
 #include "manifast/Parser.h"
 #include "manifast/Runtime.h"
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <thread>
 
 using namespace manifast;
 using namespace manifast::vm;
 
+TEST(LexerTest, CustomizedKeywords) {
+    SyntaxConfig config;
+    EXPECT_FALSE(config.isCustomized());
+    config.setKeyword("bila", TokenType::K_If);     // new spelling
+    config.setKeyword("selama", TokenType::K_For);  // remapped
+    config.removeKeyword("lokal");
+    EXPECT_TRUE(config.isCustomized());
+
+    std::string source = "bila selama lokal jika x";
+    Lexer lexer(source, config);
+    for (TokenType expected : {TokenType::K_If, TokenType::K_For, TokenType::Identifier,
+                               TokenType::K_If, TokenType::Identifier, TokenType::EndOfFile}) {
+        Token token = lexer.nextToken();
+        EXPECT_EQ(token.type, expected) << token.lexeme;
+    }
+
+    // Other configs keep the default keyword set
+    SyntaxConfig defaults;
+    EXPECT_EQ(defaults.lookupKeyword("lokal"), TokenType::K_Var);
+    EXPECT_EQ(defaults.lookupKeyword("selama"), TokenType::K_While);
+    EXPECT_EQ(defaults.lookupKeyword("bila"), TokenType::Identifier);
+}
+
 TEST(VMTest, SetAndGetStackSize) {
     VM vm;
     // Default stack size should be large (e.g., 1048576)
@@ -51,3 +79,428 @@ TEST(VMTest, StackOverflowError) {
 
     chunk.free();
 }
+
+TEST(VMTest, ArenaParsedProgramRuns) {
+    std::string source =
+        "lokal xs = [1, 2, 3]\n"
+        "lokal total = 0\n"
+        "untuk i = 1 ke len(xs) lakukan\n"
+        "    total = total + xs[i]\n"
+        "tutup\n"
+        "kembali total\n";
+
+    AstArena arena;
+    SyntaxConfig config;
+    Lexer lexer(source, config);
+    Parser parser(lexer);
+    auto statements = parser.parse(arena);
+
+    ASSERT_FALSE(parser.hadError());
+    EXPECT_GT(arena.bytesAllocated(), 0u);
+
+    Chunk chunk;
+    Compiler compiler;
+    ASSERT_TRUE(compiler.compile(statements, chunk));
+
+    VM vm;
+    vm.interpret(&chunk, source);
+    EXPECT_EQ(vm.getLastResult().type, 0);
+    EXPECT_DOUBLE_EQ(vm.getLastResult().number, 6.0);
+
+    statements.clear(); // nodes must die before the arena
+    chunk.free();
+}
+
+// panggil(f, ...) calls f through VM::call; dinamis(f, ...) through manifast_call_dynamic
+static void nativePanggil(VM* vm, Any* args, int nargs) {
+    args[-1] = vm->call(args[0], args + 1, nargs - 1);
+}
+
+static void nativeDinamis(VM* vm, Any* args, int nargs) {
+    args[-1] = *manifast_call_dynamic(&args[0], args + 1, nargs - 1);
+}
+
+TEST(VMTest, NativesCallBackIntoBytecode) {
+    std::string source =
+        "fungsi tambah(a, b)\n"
+        "    kembali a + b\n"
+        "tutup\n"
+        "fungsi kali_lewat(a, b)\n"
+        "    kembali dinamis(fungsi(x, y) kembali x * y tutup, a, b)\n"
+        "tutup\n"
+        "lokal total = 0\n"
+        "untuk i = 1 ke 300 lakukan\n"
+        "    total = total + panggil(tambah, i, panggil(kali_lewat, i, 2))\n"
+        "tutup\n"
+        "kembali total\n";
+
+    SyntaxConfig config;
+    Lexer lexer(source, config);
+    Parser parser(lexer);
+    auto statements = parser.parse();
+    ASSERT_FALSE(parser.hadError());
+
+    Chunk chunk;
+    Compiler compiler;
+    ASSERT_TRUE(compiler.compile(statements, chunk));
+
+    VM vm;
+    vm.defineNative("panggil", nativePanggil);
+    vm.defineNative("dinamis", nativeDinamis);
+    vm.interpret(&chunk, source);
+    EXPECT_EQ(vm.getLastResult().type, 0);
+    EXPECT_DOUBLE_EQ(vm.getLastResult().number, 3.0 * 300 * 301 / 2);
+
+    // Outside a running VM there is nobody to run bytecode
+    ManifastCallHandler handler;
+    void* owner;
+    manifast_get_call_handler(&handler, &owner);
+    EXPECT_EQ(handler, nullptr);
+
+    // A callback that fails unwinds its frames; the VM stays usable
+    std::string failing =
+        "fungsi rusak()\n"
+        "    kembali tidak_ada(1)\n"
+        "tutup\n"
+        "panggil(rusak)\n";
+    Lexer lexer2(failing, config);
+    Parser parser2(lexer2);
+    auto statements2 = parser2.parse();
+    Chunk chunk2;
+    Compiler compiler2;
+    ASSERT_TRUE(compiler2.compile(statements2, chunk2));
+    EXPECT_THROW(vm.interpret(&chunk2, failing), RuntimeError);
+    vm.interpret(&chunk, source);
+    EXPECT_DOUBLE_EQ(vm.getLastResult().number, 3.0 * 300 * 301 / 2);
+
+    chunk.free();
+    chunk2.free();
+}
+
+TEST(VMTest, DetachedArrayMethodsRejectOtherReceivers) {
+    SyntaxConfig config;
+    for (const char* method : {"map", "filter", "reduce", "sort", "reserve", "fill", "concat", "indexOf", "reverse"}) {
+        std::string source = std::string("lokal f = [1, 2].") + method + "\n"
+                             "f(5, fungsi(a, b) kembali a tutup)\n";
+        Lexer lexer(source, config);
+        Parser parser(lexer);
+        auto statements = parser.parse();
+        ASSERT_FALSE(parser.hadError());
+        Chunk chunk;
+        Compiler compiler;
+        ASSERT_TRUE(compiler.compile(statements, chunk));
+        VM vm;
+        EXPECT_THROW(vm.interpret(&chunk, source), RuntimeError) << method;
+        chunk.free();
+    }
+}
+
+TEST(VMTest, TypedArrayLengthMustBeACount) {
+    SyntaxConfig config;
+    for (const char* n : {"2.5", "-1", "0 / 0", "1 / 0", "4294967296"}) {
+        std::string source = std::string("lokal math = impor(\"math\")\nmath.f64array(") + n + ")\n";
+        Lexer lexer(source, config);
+        Parser parser(lexer);
+        auto statements = parser.parse();
+        ASSERT_FALSE(parser.hadError());
+        Chunk chunk;
+        Compiler compiler;
+        ASSERT_TRUE(compiler.compile(statements, chunk));
+        VM vm;
+        EXPECT_THROW(vm.interpret(&chunk, source), RuntimeError) << n;
+        chunk.free();
+    }
+}
+
+TEST(VMTest, ImportWithSyntaxErrorFails) {
+    // Parsing recovers past the error; none of the module may run
+    auto path = std::filesystem::temp_directory_path() / "manifast_bad_import.mnf";
+    std::ofstream(path) << "kembali 7\nlokal x = (1 +\n";
+    std::string source = "kembali impor(\"" + path.generic_string() + "\")\n";
+
+    SyntaxConfig config;
+    Lexer lexer(source, config);
+    Parser parser(lexer);
+    auto statements = parser.parse();
+    ASSERT_FALSE(parser.hadError());
+    Chunk chunk;
+    Compiler compiler;
+    ASSERT_TRUE(compiler.compile(statements, chunk));
+    VM vm;
+    EXPECT_THROW(vm.interpret(&chunk, source), RuntimeError);
+    chunk.free();
+    std::filesystem::remove(path);
+}
+
+TEST(VMTest, StreamedLargeArrayLiteral) {
+    // Wider than the register window, so SETLIST has to flush in batches.
+    std::string source = "lokal xs = [";
+    for (int i = 1; i <= 1000; i++) {
+        if (i > 1) source += ", ";
+        source += std::to_string(i);
+    }
+    source += "]\nkembali xs[1] + xs[500] + xs[1000] + len(xs)\n";
+
+    SyntaxConfig config;
+    Lexer lexer(source, config);
+    Parser parser(lexer);
+
+    Chunk chunk;
+    Compiler compiler;
+    compiler.begin(chunk);
+    int statements = 0;
+    while (auto stmt = parser.parseNext()) {
+        compiler.compileTopLevel(stmt.get());
+        statements++;
+    }
+    compiler.finish();
+
+    ASSERT_FALSE(parser.hadError());
+    EXPECT_EQ(statements, 2);
+    EXPECT_TRUE(parser.atEnd());
+
+    VM vm;
+    vm.interpret(&chunk, source);
+    EXPECT_EQ(vm.getLastResult().type, 0);
+    EXPECT_DOUBLE_EQ(vm.getLastResult().number, 1.0 + 500.0 + 1000.0 + 1000.0);
+
+    chunk.free();
+}
+
+namespace {
+// Backend whose "compiled code" hands every entry straight back to the interpreter.
+struct CountingBackend : TierBackend {
+    int compiled = 0;
+    const char* name() const override { return "counting"; }
+    NativeEntry compile(const Chunk&, const TierContext&) override {
+        compiled++;
+        return [](Any*, const Any*, int startPc) { return startPc; };
+    }
+};
+} // namespace
+
+TEST(VMTest, HotChunksArePromotedThroughTiers) {
+    std::string source =
+        "fungsi inc(x)\n"
+        "    kembali x + 1\n"
+        "tutup\n"
+        "lokal n = 0\n"
+        "untuk i = 1 ke 50 lakukan\n"
+        "    n = inc(n)\n"
+        "tutup\n"
+        "kembali n\n";
+
+    SyntaxConfig config;
+    Lexer lexer(source, config);
+    Parser parser(lexer);
+    auto statements = parser.parse();
+    ASSERT_FALSE(parser.hadError());
+
+    for (Tier maxTier : {Tier::T0, Tier::T2}) {
+        Chunk chunk;
+        Compiler compiler;
+        ASSERT_TRUE(compiler.compile(statements, chunk));
+        Chunk* inc = nullptr;
+        for (const Any& k : chunk.constants) {
+            if (k.type == 5) inc = (Chunk*)k.ptr;
+        }
+        ASSERT_NE(inc, nullptr);
+
+        auto t1 = std::make_shared<CountingBackend>();
+        auto t2 = std::make_shared<CountingBackend>();
+        VM vm;
+        vm.setTier(maxTier);
+        vm.setTierThresholds(10, 40);
+        vm.setTierBackend(Tier::T1, t1);
+        vm.setTierBackend(Tier::T2, t2);
+        vm.interpret(&chunk, source);
+
+        EXPECT_DOUBLE_EQ(vm.getLastResult().number, 50.0);
+        const TierState& fn = inc->tiering;
+        if (maxTier == Tier::T0) {
+            EXPECT_EQ(t1->compiled + t2->compiled, 0);
+            EXPECT_EQ(fn.tier, Tier::T0);
+        } else {
+            EXPECT_EQ(fn.tier, Tier::T2);
+            EXPECT_EQ(fn.owner, t2);
+            EXPECT_GE(fn.hotness, 40u);
+            EXPECT_EQ(t1->compiled, 2); // inc() and the script's loop
+            EXPECT_EQ(t2->compiled, 2);
+        }
+        chunk.free();
+    }
+}
+
+namespace {
+// Background backend that holds its compile until the test releases it.
+struct GatedBackend : TierBackend {
+    std::atomic<bool> release{false};
+    std::thread::id compiledOn;
+    const char* name() const override { return "gated"; }
+    bool compilesInBackground() const override { return true; }
+    NativeEntry compile(const Chunk&, const TierContext&) override {
+        while (!release.load()) std::this_thread::yield();
+        compiledOn = std::this_thread::get_id();
+        return [](Any*, const Any*, int startPc) { return startPc; };
+    }
+};
+} // namespace
+
+TEST(VMTest, BackgroundTierUpDoesNotStallTheInterpreter) {
+    std::string source =
+        "fungsi inc(x)\n"
+        "    kembali x + 1\n"
+        "tutup\n"
+        "lokal n = 0\n"
+        "untuk i = 1 ke 50 lakukan\n"
+        "    n = inc(n)\n"
+        "tutup\n"
+        "kembali n\n";
+
+    SyntaxConfig config;
+    Lexer lexer(source, config);
+    Parser parser(lexer);
+    auto statements = parser.parse();
+    ASSERT_FALSE(parser.hadError());
+
+    Chunk chunk;
+    Compiler compiler;
+    ASSERT_TRUE(compiler.compile(statements, chunk));
+    Chunk* inc = nullptr;
+    for (const Any& k : chunk.constants) {
+        if (k.type == 5) inc = (Chunk*)k.ptr;
+    }
+    ASSERT_NE(inc, nullptr);
+
+    auto gated = std::make_shared<GatedBackend>();
+    VM vm;
+    vm.setTier(Tier::T2);
+    vm.setTierThresholds(10, 10);
+    vm.setTierBackend(Tier::T1, nullptr);
+    vm.setTierBackend(Tier::T2, gated);
+
+    // The compile is still blocked: the script finishes in the interpreter.
+    vm.interpret(&chunk, source);
+    EXPECT_DOUBLE_EQ(vm.getLastResult().number, 50.0);
+    ASSERT_NE(inc->tiering.pending, nullptr);
+    EXPECT_EQ(inc->tiering.native, nullptr);
+
+    gated->release = true;
+    while (!inc->tiering.pending->done.load()) std::this_thread::yield();
+    EXPECT_NE(gated->compiledOn, std::this_thread::get_id());
+
+    // The next call picks up the finished code.
+    vm.interpret(&chunk, source);
+    EXPECT_DOUBLE_EQ(vm.getLastResult().number, 50.0);
+    EXPECT_EQ(inc->tiering.pending, nullptr);
+    EXPECT_NE(inc->tiering.native, nullptr);
+    EXPECT_EQ(inc->tiering.owner, gated);
+    chunk.free();
+}
+
+TEST(VMTest, BaselineJitRunsHotCodeAndFallsBackOnGuards) {
+    auto baseline = createBaselineTierBackend();
+    if (!baseline) GTEST_SKIP() << "no baseline JIT for this host";
+
+    std::string source =
+        "fungsi tambah(x, y)\n"
+        "    kembali x + y\n"
+        "tutup\n"
+        "fungsi jumlah(n)\n"
+        "    lokal s = 0\n"
+        "    untuk i = 1 ke n lakukan\n"
+        "        s = tambah(s, i)\n"
+        "    tutup\n"
+        "    kembali s\n"
+        "tutup\n"
+        "lokal total = jumlah(1000)\n"
+        "kembali tambah(\"total=\", total)\n"; // string operands fail the number guard
+
+    SyntaxConfig config;
+    Lexer lexer(source, config);
+    Parser parser(lexer);
+    auto statements = parser.parse();
+    ASSERT_FALSE(parser.hadError());
+
+    Chunk chunk;
+    Compiler compiler;
+    ASSERT_TRUE(compiler.compile(statements, chunk));
+
+    VM vm;
+    vm.setTier(Tier::T1);
+    vm.setTierThresholds(1, UINT32_MAX);
+    vm.setTierBackend(Tier::T1, baseline);
+    vm.setTierBackend(Tier::T2, nullptr);
+    vm.interpret(&chunk, source);
+
+    Any result = vm.getLastResult();
+    ASSERT_EQ(result.type, 1);
+    EXPECT_STREQ((const char*)result.ptr, "total=500500");
+
+    int compiled = 0;
+    for (const Any& k : chunk.constants) {
+        if (k.type != 5) continue;
+        const TierState& t = ((Chunk*)k.ptr)->tiering;
+        EXPECT_EQ(t.tier, Tier::T1);
+        EXPECT_NE(t.native, nullptr);
+        compiled++;
+    }
+    EXPECT_EQ(compiled, 2);
+    chunk.free();
+}
+
+TEST(VMTest, ProfilingRecordsCallsAndBranches) {
+    std::string source =
+        "fungsi besar(n)\n"
+        "    kembali n > 7\n"
+        "tutup\n"
+        "fungsi jarang()\n"
+        "    kembali 0\n"
+        "tutup\n"
+        "lokal c = 0\n"
+        "untuk i = 1 ke 10 lakukan\n"
+        "    jika besar(i) maka\n"
+        "        c = c + 1\n"
+        "    tutup\n"
+        "tutup\n"
+        "kembali c\n";
+
+    SyntaxConfig config;
+    Lexer lexer(source, config);
+    Parser parser(lexer);
+    auto statements = parser.parse();
+    ASSERT_FALSE(parser.hadError());
+
+    Chunk chunk;
+    Compiler compiler;
+    ASSERT_TRUE(compiler.compile(statements, chunk));
+
+    ExecutionProfile profile;
+    profile.source = ExecutionProfile::fingerprint(source);
+    VM vm;
+    vm.setTierThresholds(1, 1); // profiling keeps everything interpreted anyway
+    vm.setProfile(&profile);
+    vm.interpret(&chunk, source);
+    EXPECT_DOUBLE_EQ(vm.getLastResult().number, 3.0);
+
+    EXPECT_EQ(profile.calls["besar"], 10u);
+    EXPECT_EQ(profile.calls.count("jarang"), 0u);
+    ASSERT_EQ(profile.branches.size(), 1u);
+    EXPECT_EQ(profile.branches.begin()->second.taken, 3u);
+    EXPECT_EQ(profile.branches.begin()->second.notTaken, 7u);
+    for (const Any& k : chunk.constants) {
+        if (k.type == 5) {
+            EXPECT_EQ(((Chunk*)k.ptr)->tiering.native, nullptr);
+        }
+    }
+
+    ExecutionProfile reloaded;
+    ASSERT_TRUE(reloaded.parse(profile.serialize()));
+    EXPECT_TRUE(reloaded.matches(source));
+    EXPECT_FALSE(reloaded.matches(source + "\n"));
+    reloaded.merge(profile);
+    EXPECT_EQ(reloaded.calls["besar"], 20u);
+    EXPECT_EQ(reloaded.branches.begin()->second.taken, 6u);
+    EXPECT_FALSE(reloaded.parse("not a profile"));
+    chunk.free();
+}